@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include "Mic_Class.hpp"
+#include "mic_decimator.hpp"
 
 #include "../M5Unified.hpp"
 
@@ -23,6 +24,7 @@
 #if __has_include(<sdkconfig.h>)
 #include <sdkconfig.h>
 #include <esp_log.h>
+#include <esp_heap_caps.h>
 #include <math.h>
 
 #if !defined (CONFIG_IDF_TARGET) || defined (CONFIG_IDF_TARGET_ESP32)  
@@ -518,16 +520,26 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
 
     int32_t gain = self->_cfg.magnification;
     const float f_gain = (float)gain / (oversampling << 1);
-    size_t src_idx = ~0u;
     size_t src_len = 0;
     int32_t sum_value[4] = { 0,0 };
-    int32_t prev_value[2] = { 0, 0 };
     const bool in_stereo = self->_cfg.stereo;
-    int32_t os_remain = oversampling;
     const size_t dma_buf_len = self->_cfg.dma_buf_len;
     int16_t* src_buf = (int16_t*)alloca(dma_buf_len * sizeof(int16_t));
     memset(src_buf, 0, dma_buf_len * sizeof(int16_t));
 
+    /// one DMA buffer is decimated at once into dec_buf, the loop below only converts the outputs.
+#if defined (CONFIG_IDF_TARGET_ESP32)
+    static constexpr bool swap_channels = true;
+#else
+    static constexpr bool swap_channels = false;
+#endif
+    mic_decimator_t decimator;
+    decimator.setup(oversampling, f_gain, self->_cfg.noise_filter_level, self->_cfg.use_adc, swap_channels);
+    decimator.offset = self->_offset;
+    int32_t* dec_buf = (int32_t*)alloca(decimator.maxOutput(dma_buf_len >> 1) * 2 * sizeof(int32_t));
+    size_t dec_idx = 0;
+    size_t dec_len = 0;
+
     _i2s_read(self->_cfg.i2s_port, src_buf, dma_buf_len, &src_len, portTICK_PERIOD_MS);
     _i2s_read(self->_cfg.i2s_port, src_buf, dma_buf_len, &src_len, portTICK_PERIOD_MS);
 
@@ -542,17 +554,25 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
       {
         rec_flip = !rec_flip;
         self->_rec_flip = rec_flip;
-        xSemaphoreGive(self->_task_semaphore);
         std::swap(current_rec, next_rec);
         dst_remain = current_rec->length;
+        if (dst_remain)
+        { // a record() call only waits while a request is queued behind the running one,
+          // streaming alone never gives the semaphore.
+          xSemaphoreGive(self->_task_semaphore);
+        }
+        if (dst_remain == 0 && self->_stream_buf)
+        { // no record() request pending, keep filling the stream ring.
+          current_rec = self->_stream_next();
+          dst_remain = current_rec->length;
+        }
         if (dst_remain == 0)
         {
           self->_is_recording = false;
           ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
-          src_idx = ~0u;
-          src_len = 0;
-          sum_value[0] = 0;
-          sum_value[1] = 0;
+          dec_idx = 0;
+          dec_len = 0;
+          decimator.reset();
           continue;
         }
       }
@@ -560,61 +580,18 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
 
       for (;;)
       {
-        if (src_idx >= src_len)
+        if (dec_idx >= dec_len)
         {
           _i2s_read(self->_cfg.i2s_port, src_buf, dma_buf_len, &src_len, 100 / portTICK_PERIOD_MS);
-          src_len >>= 1;
-          src_idx = 0;
-        }
-
-        do
-        {
-          sum_value[0] += src_buf[src_idx  ];
-          sum_value[1] += src_buf[src_idx+1];
-          src_idx += 2;
-        } while (--os_remain && (src_idx < src_len));
-
-        if (os_remain) { continue; }
-        os_remain = oversampling;
-
-#if defined (CONFIG_IDF_TARGET_ESP32)
-        auto sv0 = sum_value[1];
-        auto sv1 = sum_value[0];
-#else
-        auto sv0 = sum_value[0];
-        auto sv1 = sum_value[1];
-#endif
-        if (self->_cfg.use_adc) {
-          sv0 -= 2048 * oversampling;
-          sv1 -= 2048 * oversampling;
+          dec_len = decimator.process(src_buf, src_len >> 1, dec_buf);
+          dec_idx = 0;
+          self->_offset = decimator.offset;
+          if (dec_len == 0) { continue; }
         }
 
-        auto value_tmp = (sv0 + sv1) << 3;
-        int32_t offset = self->_offset;
-        // Automatic zero level adjustment
-        offset -= (value_tmp + offset + 16) >> 5;
-        self->_offset = offset;
-        offset = (offset + 8) >> 4;
-        sum_value[0] = sv0 + offset;
-        sum_value[1] = sv1 + offset;
-
-        int32_t noise_filter = self->_cfg.noise_filter_level;
-        if (noise_filter)
-        {
-          for (int i = 0; i < 2; ++i)
-          {
-            int32_t v = (sum_value[i] * (256 - noise_filter) + prev_value[i] * noise_filter + 128) >> 8;
-            prev_value[i] = v;
-            sum_value[i] = v * f_gain;
-          }
-        }
-        else
-        {
-          for (int i = 0; i < 2; ++i)
-          {
-            sum_value[i] *= f_gain;
-          }
-        }
+        sum_value[0] = dec_buf[dec_idx * 2    ];
+        sum_value[1] = dec_buf[dec_idx * 2 + 1];
+        ++dec_idx;
 
         int output_num = current_rec->is_stereo ? 2 : 1;
 
@@ -655,8 +632,6 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
             current_rec->data = dst;
           }
         }
-        sum_value[0] = 0;
-        sum_value[1] = 0;
         dst_remain -= output_num;
         if ((int32_t)dst_remain <= 0)
         {
@@ -664,6 +639,10 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
           break;
         }
       }
+      if (current_rec == &self->_stream_rec)
+      {
+        self->_stream_commit();
+      }
     }
     self->_is_recording = false;
     _i2s_stop(self->_cfg.i2s_port);
@@ -694,7 +673,8 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
     res = (ESP_OK == _setup_i2s()) && res;
     if (res)
     {
-      size_t stack_size = 2048 + (_cfg.dma_buf_len * sizeof(uint16_t));
+      // src_buf plus the decimated int32_t pairs of one DMA buffer.
+      size_t stack_size = 2048 + (_cfg.dma_buf_len * sizeof(uint16_t) * 2) + 16;
       _task_running = true;
 #if portNUM_PROCESSORS > 1
       if (_cfg.task_pinned_core < portNUM_PROCESSORS)
@@ -745,6 +725,100 @@ printf("i2s_channel_init_std_mode 2:%d\n", err);
     }
     return true;
   }
+
+  Mic_Class::recording_info_t* Mic_Class::_stream_next(void)
+  {
+    auto head = _stream_head.load(std::memory_order_relaxed);
+    _stream_rec.data = &_stream_buf[(head % _stream_block_count) * _stream_block_len];
+    _stream_rec.length = _stream_block_len;
+    _stream_rec.is_16bit = true;
+    _stream_rec.is_stereo = false;
+    return &_stream_rec;
+  }
+
+  void Mic_Class::_stream_commit(void)
+  {
+    auto head = _stream_head.load(std::memory_order_relaxed);
+    uint32_t seq = _stream_produced++;
+    // The block at head is always owned by the mic task. If publishing this one would hand
+    // the whole ring to the consumer, drop it and fill the same block again.
+    if (head + 1 - _stream_tail.load(std::memory_order_acquire) >= _stream_block_count)
+    {
+      _stream_dropped = _stream_dropped + 1;
+      return;
+    }
+    _stream_seq[head % _stream_block_count] = seq;
+    _stream_head.store(head + 1, std::memory_order_release);
+    if (_stream_notify) { xTaskNotifyGive(_stream_notify); }
+  }
+
+  bool Mic_Class::beginStream(size_t block_len, size_t block_count, TaskHandle_t notify_task)
+  {
+    if (block_len == 0) { return false; }
+    if (block_count < 2) { block_count = 2; }
+    endStream();
+
+    auto buf = (int16_t*)heap_caps_malloc(block_len * block_count * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    auto seq = (uint32_t*)heap_caps_malloc(block_count * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (buf == nullptr || seq == nullptr)
+    {
+      heap_caps_free(buf);
+      heap_caps_free(seq);
+      return false;
+    }
+    memset(buf, 0, block_len * block_count * sizeof(int16_t));
+
+    _stream_block_len = block_len;
+    _stream_block_count = block_count;
+    _stream_produced = 0;
+    _stream_dropped = 0;
+    _stream_head.store(0, std::memory_order_relaxed);
+    _stream_tail.store(0, std::memory_order_relaxed);
+    _stream_notify = notify_task;
+    _stream_seq = seq;
+    _stream_buf = buf;
+
+    if (!begin())
+    {
+      endStream();
+      return false;
+    }
+    if (_task_handle)
+    { // wake the mic task in case it is waiting for a record() request.
+      xTaskNotifyGive(_task_handle);
+    }
+    return true;
+  }
+
+  void Mic_Class::endStream(void)
+  {
+    if (_stream_buf == nullptr) { return; }
+    // the mic task writes into the ring without locking, stop it before releasing the memory.
+    end();
+    auto buf = _stream_buf;
+    auto seq = _stream_seq;
+    _stream_buf = nullptr;
+    _stream_seq = nullptr;
+    _stream_notify = nullptr;
+    heap_caps_free(buf);
+    heap_caps_free(seq);
+  }
+
+  const int16_t* Mic_Class::getStreamBlock(uint32_t* seq) const
+  {
+    auto tail = _stream_tail.load(std::memory_order_relaxed);
+    if (_stream_buf == nullptr || tail == _stream_head.load(std::memory_order_acquire)) { return nullptr; }
+    size_t index = tail % _stream_block_count;
+    if (seq) { *seq = _stream_seq[index]; }
+    return &_stream_buf[index * _stream_block_len];
+  }
+
+  void Mic_Class::releaseStreamBlock(void)
+  {
+    auto tail = _stream_tail.load(std::memory_order_relaxed);
+    if (tail == _stream_head.load(std::memory_order_acquire)) { return; }
+    _stream_tail.store(tail + 1, std::memory_order_release);
+  }
 #endif
 }
 #endif
@@ -23,6 +23,7 @@
 #endif
 
 #include <stdint.h>
+#include <atomic>
 
 #ifndef I2S_PIN_NO_CHANGE
 #define I2S_PIN_NO_CHANGE (-1)
@@ -156,6 +157,38 @@ namespace m5
       return _rec_raw(rec_data, array_len,  true, _cfg.sample_rate, false);
     }
 
+#if !defined (SDL_h_)
+    /// start continuous recording into an internal ring of blocks.
+    /// The mic task writes 16bit monaural samples straight into the ring, completed blocks are read in place
+    /// with getStreamBlock() / releaseStreamBlock(). Single producer (mic task) / single consumer, lock-free.
+    /// While streaming, record() requests still take priority over the stream.
+    /// @param block_len Number of samples per block.
+    /// @param block_count Number of blocks in the ring (min 2). One block is always owned by the mic task.
+    /// @param notify_task Task to wake with xTaskNotifyGive() each time a block is completed, or nullptr.
+    bool beginStream(size_t block_len, size_t block_count, TaskHandle_t notify_task = nullptr);
+
+    /// stop the stream and the mic task, release the ring.
+    void endStream(void);
+
+    /// @return true if a stream has been started with beginStream().
+    bool isStreaming(void) const { return _stream_buf != nullptr; }
+
+    /// get the oldest completed block without copying it.
+    /// @param seq if not null, receives the number of the block since beginStream(), counting dropped blocks.
+    ///            The first sample of the block is sample number seq * block_len.
+    /// @return pointer to block_len samples, or nullptr if no block is ready.
+    const int16_t* getStreamBlock(uint32_t* seq = nullptr) const;
+
+    /// hand the block returned by getStreamBlock() back to the mic task.
+    void releaseStreamBlock(void);
+
+    /// @return number of completed blocks waiting to be read.
+    size_t getStreamAvailable(void) const { return _stream_head.load(std::memory_order_acquire) - _stream_tail.load(std::memory_order_relaxed); }
+
+    /// @return number of blocks discarded because the consumer did not keep up.
+    uint32_t getStreamDropped(void) const { return _stream_dropped; }
+#endif
+
   protected:
 
     void setCallback(void* args, bool(*func)(void*, bool)) { _cb_set_enabled = func; _cb_set_enabled_args = args; }
@@ -172,6 +205,22 @@ namespace m5
     recording_info_t _rec_info[2];
     volatile bool _rec_flip = false;
 
+#if !defined (SDL_h_)
+    recording_info_t* _stream_next(void);
+    void _stream_commit(void);
+
+    recording_info_t _stream_rec;
+    int16_t* _stream_buf = nullptr;
+    uint32_t* _stream_seq = nullptr;
+    size_t _stream_block_len = 0;
+    size_t _stream_block_count = 0;
+    uint32_t _stream_produced = 0;
+    volatile uint32_t _stream_dropped = 0;
+    std::atomic<uint32_t> _stream_head = { 0 };  // completed blocks, written by the mic task
+    std::atomic<uint32_t> _stream_tail = { 0 };  // released blocks, written by the consumer
+    TaskHandle_t _stream_notify = nullptr;
+#endif
+
     static void mic_task(void* args);
 
     uint32_t _calc_rec_rate(void) const;
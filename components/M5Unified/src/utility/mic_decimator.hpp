@@ -0,0 +1,160 @@
+// Copyright (c) M5Stack. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef __M5_mic_decimator_H__
+#define __M5_mic_decimator_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace m5
+{
+  /// Block decimation stage of Mic_Class.
+  /// Sums `oversampling` stereo pairs per output, tracks the DC offset, applies the noise filter and the gain.
+  /// A whole DMA buffer is processed per call, the branches on the configuration are resolved once per call
+  /// instead of once per sample. Platform independent so it can be checked against the per-sample reference
+  /// on a host (see host/mic_decimator_bench.cpp).
+  struct mic_decimator_t
+  {
+    int32_t oversampling = 1;
+    float gain = 1.0f;
+    int32_t noise_filter = 0;
+    bool use_adc = false;
+    bool swap_channels = false;  // ESP32 delivers the right channel first
+
+    int32_t offset = 0;  // DC offset tracker state
+    int32_t prev_value[2] = { 0, 0 };
+
+    void setup(int32_t oversampling_, float gain_, int32_t noise_filter_, bool use_adc_, bool swap_channels_)
+    {
+      oversampling = oversampling_;
+      gain = gain_;
+      noise_filter = noise_filter_;
+      use_adc = use_adc_;
+      swap_channels = swap_channels_;
+      os_remain = oversampling_;
+      reset();
+    }
+
+    /// drop a partially accumulated output (the DC offset and noise filter states are kept).
+    void reset(void)
+    {
+      sum_value[0] = 0;
+      sum_value[1] = 0;
+    }
+
+    /// @return max number of outputs process() can write for `src_len` input samples.
+    size_t maxOutput(size_t src_len) const { return src_len / (2 * oversampling) + 1; }
+
+    /// decimate one block of interleaved stereo samples.
+    /// An output that is not complete at the end of the block is carried over to the next call.
+    /// @param src interleaved 16bit samples.
+    /// @param src_len number of int16_t in src.
+    /// @param dst receives left/right int32_t pairs, maxOutput(src_len) pairs at most.
+    /// @return number of pairs written into dst.
+    size_t process(const int16_t* src, size_t src_len, int32_t* dst)
+    {
+      if (noise_filter)
+      {
+        return use_adc ? _process<true, true>(src, src_len, dst) : _process<true, false>(src, src_len, dst);
+      }
+      return use_adc ? _process<false, true>(src, src_len, dst) : _process<false, false>(src, src_len, dst);
+    }
+
+  private:
+    int32_t sum_value[2] = { 0, 0 };
+    int32_t os_remain = 1;
+
+    template <bool NoiseFilter, bool UseAdc>
+    inline void _output(int32_t s0, int32_t s1, int32_t* dst)
+    {
+      auto sv0 = swap_channels ? s1 : s0;
+      auto sv1 = swap_channels ? s0 : s1;
+      if (UseAdc)
+      {
+        sv0 -= 2048 * oversampling;
+        sv1 -= 2048 * oversampling;
+      }
+
+      auto value_tmp = (sv0 + sv1) << 3;
+      // Automatic zero level adjustment
+      int32_t ofs = offset;
+      ofs -= (value_tmp + ofs + 16) >> 5;
+      offset = ofs;
+      ofs = (ofs + 8) >> 4;
+      int32_t v[2] = { sv0 + ofs, sv1 + ofs };
+
+      for (int i = 0; i < 2; ++i)
+      {
+        if (NoiseFilter)
+        {
+          int32_t f = (v[i] * (256 - noise_filter) + prev_value[i] * noise_filter + 128) >> 8;
+          prev_value[i] = f;
+          v[i] = f;
+        }
+        dst[i] = v[i] * gain;
+      }
+    }
+
+    template <bool NoiseFilter, bool UseAdc>
+    size_t _process(const int16_t* src, size_t src_len, int32_t* dst)
+    {
+      size_t idx = 0;
+      size_t out = 0;
+      src_len &= ~(size_t)1;
+      if (src_len == 0) { return 0; }
+
+      // finish the output left over from the previous block
+      if (os_remain != oversampling)
+      {
+        do
+        {
+          sum_value[0] += src[idx];
+          sum_value[1] += src[idx + 1];
+          idx += 2;
+        } while (--os_remain && idx < src_len);
+        if (os_remain) { return 0; }
+        os_remain = oversampling;
+        _output<NoiseFilter, UseAdc>(sum_value[0], sum_value[1], &dst[0]);
+        ++out;
+      }
+
+      // whole outputs, no carry and no bounds checks inside
+      const size_t group = 2 * oversampling;
+      if (oversampling == 2)
+      {
+        for (; idx + 4 <= src_len; idx += 4, ++out)
+        {
+          _output<NoiseFilter, UseAdc>(src[idx] + src[idx + 2], src[idx + 1] + src[idx + 3], &dst[out * 2]);
+        }
+      }
+      else
+      {
+        for (; idx + group <= src_len; ++out)
+        {
+          int32_t s0 = 0, s1 = 0;
+          for (int32_t k = 0; k < oversampling; ++k, idx += 2)
+          {
+            s0 += src[idx];
+            s1 += src[idx + 1];
+          }
+          _output<NoiseFilter, UseAdc>(s0, s1, &dst[out * 2]);
+        }
+      }
+
+      // start the next output with what is left
+      sum_value[0] = 0;
+      sum_value[1] = 0;
+      while (idx < src_len)
+      {
+        sum_value[0] += src[idx];
+        sum_value[1] += src[idx + 1];
+        idx += 2;
+        --os_remain;
+      }
+      return out;
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * @file cycle_counter.h
+ * @author d4rkmen
+ * @brief CPU cycle counter for the host benchmarks
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_COUNTER_UNIT "cycles"
+#else
+#define CYCLE_COUNTER_UNIT "ns"
+#endif
+
+/// @brief TSC cycles on x86, nanoseconds of steady_clock everywhere else
+static inline uint64_t cycle_count()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
@@ -0,0 +1,514 @@
+/**
+ * @file filter_bench.cpp
+ * @author d4rkmen
+ * @brief The fixed-capacity smoothing filters against the heap based ones they replaced, medians against sorting
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "app/utils/MedianFilter.hpp"
+#include "app/utils/MovingAverage.hpp"
+#include "app/utils/OneEuroFilter.h"
+#include "pitch/pitch_pipeline.h"
+#include "cycle_counter.h"
+
+#define FILTER_BENCH_ROUNDS 20
+// Worst difference to the old chain that still passes, float against double
+#define FILTER_BENCH_MAX_CENTS 0.05
+// Further than this from the played note counts as a wrong reading
+#define FILTER_BENCH_OFF_NOTE_CENTS 50
+// Settled: every reading of the pluck from then on is within this
+#define FILTER_BENCH_STABLE_CENTS 1.0
+// Jitter is measured over the attack and over the sustain
+#define FILTER_BENCH_ATTACK_WINDOW_S 0.1
+#define FILTER_BENCH_SUSTAIN_S 0.4
+// The plucks: how sharp they start, how quickly that goes, how quickly they die away
+#define FILTER_BENCH_ATTACK_CENTS 12.0f
+#define FILTER_BENCH_ATTACK_S 0.05f
+#define FILTER_BENCH_DECAY_S 0.7f
+
+// Every heap allocation of the process, the filters should add none.
+// Not inlined, GCC would pair the malloc() with operator delete and warn.
+static size_t s_allocations = 0;
+
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    s_allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+typedef struct
+{
+    float frequency;  // As the detector reports it, jitter and octave errors included
+    float truth;      // The pitch played, sharp at the attack
+    float confidence; // Of the detector, lower at the attack and as the note dies away
+    float envelope;   // Signal range in raw counts
+    float age;        // Seconds since the pluck
+    uint32_t samples; // Since the detection before
+    bool pluck;       // First detection of a pluck
+    bool reset;       // The pipeline was reset before this one, the string was quiet
+} Detection;
+
+/// @brief The 1EU -> moving average -> smoother -> 1EU chain of PitchPipeline before the fixed filters
+class ReferenceChain
+{
+public:
+    ReferenceChain()
+        : _one_eu_filter(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF, EU_FILTER_BETA, EU_FILTER_DERIVATIVE_CUTOFF),
+          _one_eu_filter2(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF_2, EU_FILTER_BETA_2, EU_FILTER_DERIVATIVE_CUTOFF_2),
+          _moving_average(MOVING_AVERAGE_SIZE), _smoother(EXP_SMOOTHING), _time(0)
+    {
+    }
+
+    float filter(float f, float dt)
+    {
+        _time += dt;
+        _one_eu_filter.setFrequency(f);
+        f = (float)_one_eu_filter.filter((double)f, _time);
+        f = _moving_average.addValue(f);
+        f = _smoother.smooth(f);
+        _one_eu_filter2.setFrequency(f);
+        return (float)_one_eu_filter2.filter((double)f, _time);
+    }
+
+    void reset()
+    {
+        _smoother.reset();
+        _moving_average.reset();
+    }
+
+private:
+    OneEuroFilter _one_eu_filter;
+    OneEuroFilter _one_eu_filter2;
+    MovingAverage _moving_average;
+    ExponentialSmoother _smoother;
+    TimeStamp _time;
+};
+
+// The same stages on the fixed filters, PitchFilterChain without the outlier rejection
+typedef FilterChain<FixedOneEuroFilter, FixedMovingAverage<MOVING_AVERAGE_SIZE>, ExponentialSmoother, FixedOneEuroFilter>
+    SmoothingChain;
+
+static void new_pluck(ReferenceChain& chain) { chain.reset(); }
+
+static void new_pluck(SmoothingChain& chain)
+{
+    chain.stage<1>().reset();
+    chain.stage<2>().reset();
+}
+
+static void new_pluck(PitchFilterChain& chain)
+{
+    chain.stage<PITCH_FILTER_OUTLIERS>().reset();
+    chain.stage<PITCH_FILTER_AVERAGE>().reset();
+    chain.stage<PITCH_FILTER_SMOOTHER>().reset();
+}
+
+static void new_pluck(AdaptiveFilterChain& chain) { chain.reset(); }
+
+/// @brief What the detector knows besides the frequency, only the adaptive chain listens
+template <typename Chain> static void detection(Chain& chain, const Detection& d) {}
+
+static void detection(AdaptiveFilterChain& chain, const Detection& d)
+{
+    chain.stage<PITCH_FILTER_ADAPTIVE>().set_detection(d.confidence, d.envelope);
+}
+
+/// @brief Plucks of the guitar strings as q::pitch_detector hands them out:
+/// sharp at the attack, jitter that grows as the confidence drops, the odd
+/// octave error. Most plucks start from silence, the rest ring into each other.
+static std::vector<Detection> make_detections(size_t count)
+{
+    static const float Strings[] = {82.41f, 110.00f, 146.83f, 196.00f, 246.94f, 329.63f};
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> hop(64, 320);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::vector<Detection> detections(count);
+    float note = 0, amplitude = 0, length = 0, age = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        Detection& d = detections[i];
+        d.samples = hop(rng);
+        age += (float)d.samples / TUNER_SAMPLE_RATE;
+        d.pluck = i == 0 || age >= length;
+        d.reset = d.pluck && (i == 0 || chance(rng) < 0.7f);
+        if (d.pluck)
+        {
+            // Up to half a semitone out of tune
+            note = Strings[rng() % 6] * exp2f((chance(rng) - 0.5f) / 12);
+            amplitude = 8000 + 24000 * chance(rng);
+            length = 0.8f + 1.2f * chance(rng);
+            age = 0;
+        }
+        float level = expf(-age / FILTER_BENCH_DECAY_S);
+        d.age = age;
+        d.truth = note * exp2f(FILTER_BENCH_ATTACK_CENTS * expf(-age / FILTER_BENCH_ATTACK_S) / 1200);
+        d.envelope = amplitude * level;
+        d.confidence = 0.98f - 0.35f * (1 - level) - 0.2f * expf(-age / 0.02f);
+        // From under a cent for a clean sustain to a few cents near the floor
+        float jitter = 0.5f + 8.0f * (1 - d.confidence);
+        d.frequency = d.truth * exp2f(jitter * normal(rng) / 1200);
+        if (chance(rng) < 0.03f)
+            d.frequency *= chance(rng) < 0.5f ? 2.0f : 0.5f;
+    }
+    return detections;
+}
+
+typedef struct
+{
+    double cycles; // Per detection, the best of a few rounds
+    size_t allocations;
+    size_t off_note;    // Outputs more than FILTER_BENCH_OFF_NOTE_CENTS from the pitch played
+    double settle_ms;   // Median over the plucks, from the pluck until the output stays within STABLE cents
+    size_t settled;     // Plucks that settled at all
+    size_t plucks;
+    double attack_rms;  // Cents off the pitch played, the first FILTER_BENCH_ATTACK_WINDOW_S of each pluck
+    double sustain_rms; // and after FILTER_BENCH_SUSTAIN_S
+} ChainResult;
+
+static double median_of(std::vector<double> v)
+{
+    if (v.empty())
+        return NAN;
+    std::sort(v.begin(), v.end());
+    return v.size() % 2 ? v[v.size() / 2] : (v[v.size() / 2 - 1] + v[v.size() / 2]) / 2;
+}
+
+/// @brief Latency and jitter of a chain's output against the pitch played
+static void score(const std::vector<Detection>& detections, const std::vector<float>& output, ChainResult& r)
+{
+    std::vector<double> settle;
+    double attack_sum = 0, sustain_sum = 0;
+    size_t attack_count = 0, sustain_count = 0;
+    double settled_at = 0;
+    bool settled = false;
+    for (size_t i = 0; i < detections.size(); i++)
+    {
+        const Detection& d = detections[i];
+        if (d.pluck)
+        {
+            r.plucks++;
+            settled = false;
+        }
+        double cents = 1200.0 * log2((double)output[i] / d.truth);
+        if (fabs(cents) > FILTER_BENCH_OFF_NOTE_CENTS)
+            r.off_note++;
+        else if (d.age < FILTER_BENCH_ATTACK_WINDOW_S)
+        {
+            attack_sum += cents * cents;
+            attack_count++;
+        }
+        else if (d.age >= FILTER_BENCH_SUSTAIN_S)
+        {
+            sustain_sum += cents * cents;
+            sustain_count++;
+        }
+        if (fabs(cents) > FILTER_BENCH_STABLE_CENTS)
+            settled = false;
+        else if (!settled)
+        {
+            settled = true;
+            settled_at = d.age;
+        }
+        // The pluck is over, settled if it stayed within since
+        if ((i + 1 == detections.size() || detections[i + 1].pluck) && settled)
+            settle.push_back(settled_at * 1000.0);
+    }
+    r.settle_ms = median_of(settle);
+    r.settled = settle.size();
+    r.attack_rms = attack_count ? sqrt(attack_sum / attack_count) : NAN;
+    r.sustain_rms = sustain_count ? sqrt(sustain_sum / sustain_count) : NAN;
+}
+
+/// @brief Runs the detections through a freshly made chain.
+/// @param output Filtered frequencies, one per detection.
+template <typename Chain, typename Make>
+static ChainResult run_chain(const std::vector<Detection>& detections, Make make, std::vector<float>& output)
+{
+    ChainResult r = {1e30, 0, 0, NAN, 0, 0, NAN, NAN};
+    output.resize(detections.size());
+    size_t allocations = s_allocations;
+    Chain* chain = make();
+    for (size_t i = 0; i < detections.size(); i++)
+    {
+        const Detection& d = detections[i];
+        if (d.reset)
+            new_pluck(*chain);
+        detection(*chain, d);
+        output[i] = chain->filter(d.frequency, (float)d.samples / TUNER_SAMPLE_RATE);
+    }
+    // Not counting the one for the chain itself
+    r.allocations = s_allocations - allocations - 1;
+    score(detections, output, r);
+
+    // A fresh pass over the same detections each round
+    float sink = 0;
+    for (int round = 0; round < FILTER_BENCH_ROUNDS; round++)
+    {
+        uint64_t start = cycle_count();
+        for (const Detection& d : detections)
+        {
+            if (d.reset)
+                new_pluck(*chain);
+            detection(*chain, d);
+            sink += chain->filter(d.frequency, (float)d.samples / TUNER_SAMPLE_RATE);
+        }
+        r.cycles = fmin(r.cycles, (double)(cycle_count() - start) / detections.size());
+    }
+    delete chain;
+    // Keeps the loops from being optimized away
+    if (sink == 12345.0f)
+        printf(" ");
+    return r;
+}
+
+/// @brief Cost of a moving median per value
+template <size_t N> static void bench_median(const std::vector<float>& values)
+{
+    float sink = 0;
+    size_t allocations = s_allocations;
+    FixedMedianFilter<N> median;
+    double cycles = 1e30;
+    for (int round = 0; round < FILTER_BENCH_ROUNDS; round++)
+    {
+        uint64_t start = cycle_count();
+        for (float v : values)
+            sink += median.filter(v);
+        cycles = fmin(cycles, (double)(cycle_count() - start) / values.size());
+    }
+    printf("median %-3zu %10.1f %8zu\n", N, cycles, s_allocations - allocations);
+    if (sink == 12345.0f)
+        printf(" ");
+}
+
+/// @brief FixedMedianFilter and MedianFilter against sorting a copy of the window.
+/// @return The number of values where they differ.
+static size_t check_medians(const std::vector<float>& values)
+{
+    size_t mismatches = 0;
+    for (size_t window = 1; window <= MAX_MEDIAN_WINDOW_SIZE; window++)
+    {
+        FixedMedianFilter<MAX_MEDIAN_WINDOW_SIZE> median;
+        median.set_window(window);
+        // MedianFilter only takes odd windows of 3 and up
+        bool legacy = window >= MIN_MEDIAN_WINDOW_SIZE && (window & 1);
+        MedianFilter moving(window, true);
+        MedianFilter batch(window, false);
+        std::deque<float> recent;
+        size_t batched = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            // Start over now and then, like the pipeline does between plucks
+            if (i % 997 == 0)
+            {
+                median.reset();
+                moving.reset();
+                recent.clear();
+            }
+            float value = values[i];
+            recent.push_back(value);
+            if (recent.size() > window)
+                recent.pop_front();
+            std::vector<float> sorted(recent.begin(), recent.end());
+            std::sort(sorted.begin(), sorted.end());
+            size_t n = sorted.size();
+
+            float expected = n & 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * 0.5f;
+            bool ok = median.filter(value) == expected;
+            for (size_t k = 0; k < n && ok; k++)
+                ok = median.at(k) == sorted[k];
+            if (legacy)
+            {
+                // Moving mode answers with the upper middle while the window fills
+                ok &= moving.addValue(value) == sorted[n / 2];
+                // Batch mode answers once per window, from the values since the last answer
+                float answer = batch.addValue(value);
+                if (++batched == window)
+                {
+                    batched = 0;
+                    std::vector<float> last(values.begin() + (i + 1 - window), values.begin() + i + 1);
+                    std::sort(last.begin(), last.end());
+                    ok &= answer == last[window / 2];
+                }
+                else
+                    ok &= answer == -1;
+            }
+            if (!ok)
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+/// @brief FixedMedianFilter fed NaN and +/-inf between finite values, against sorting
+/// the finite ones alone.
+/// @return The number of values where they differ.
+static size_t check_non_finite(const std::vector<float>& values)
+{
+    const float specials[] = {INFINITY, -INFINITY, NAN};
+    size_t mismatches = 0;
+    FixedMedianFilter<MEDIAN_FILTER_SIZE> median;
+    std::deque<float> recent;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        // Every third value is one that must not get into the window
+        bool special = i % 3 == 1;
+        float value = special ? specials[(i / 3) % 3] : values[i];
+        if (!special)
+        {
+            recent.push_back(value);
+            if (recent.size() > MEDIAN_FILTER_SIZE)
+                recent.pop_front();
+        }
+        std::vector<float> sorted(recent.begin(), recent.end());
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+
+        float expected = n == 0 ? 0.0f : n & 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * 0.5f;
+        bool ok = median.filter(value) == expected && median.count() == n;
+        for (size_t k = 0; k < n && ok; k++)
+            ok = median.at(k) == sorted[k];
+        if (!ok)
+            mismatches++;
+    }
+    return mismatches;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n, --count N  detections (default 100000)\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = 100000;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if ((!strcmp(arg, "-n") || !strcmp(arg, "--count")) && i + 1 < argc)
+            count = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (count == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    std::vector<Detection> detections = make_detections(count);
+
+    // The heap based chain, the same stages on the fixed filters, and PitchFilterChain
+    std::vector<float> expected, smoothed, filtered;
+    ChainResult reference = run_chain<ReferenceChain>(detections, [] { return new ReferenceChain(); }, expected);
+    ChainResult smoothing = run_chain<SmoothingChain>(
+        detections,
+        []
+        {
+            return new SmoothingChain(
+                FixedOneEuroFilter(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF, EU_FILTER_BETA, EU_FILTER_DERIVATIVE_CUTOFF),
+                FixedMovingAverage<MOVING_AVERAGE_SIZE>(),
+                ExponentialSmoother(EXP_SMOOTHING),
+                FixedOneEuroFilter(
+                    EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF_2, EU_FILTER_BETA_2, EU_FILTER_DERIVATIVE_CUTOFF_2));
+        },
+        smoothed);
+    ChainResult pitch = run_chain<PitchFilterChain>(
+        detections,
+        []
+        {
+            return new PitchFilterChain(
+                FixedOutlierFilter<MEDIAN_FILTER_SIZE>(MEDIAN_FILTER_MAX_CENTS),
+                FixedOneEuroFilter(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF, EU_FILTER_BETA, EU_FILTER_DERIVATIVE_CUTOFF),
+                FixedMovingAverage<MOVING_AVERAGE_SIZE>(),
+                ExponentialSmoother(EXP_SMOOTHING),
+                FixedOneEuroFilter(
+                    EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF_2, EU_FILTER_BETA_2, EU_FILTER_DERIVATIVE_CUTOFF_2));
+        },
+        filtered);
+    std::vector<float> adapted;
+    ChainResult adaptive = run_chain<AdaptiveFilterChain>(
+        detections,
+        [] { return new AdaptiveFilterChain(FixedOutlierFilter<MEDIAN_FILTER_SIZE>(MEDIAN_FILTER_MAX_CENTS), AdaptiveSmoother()); },
+        adapted);
+    double max_cents = 0;
+    for (size_t i = 0; i < count; i++)
+        max_cents = fmax(max_cents, fabs(1200.0 * log2((double)smoothed[i] / expected[i])));
+
+    size_t octave_errors = std::count_if(detections.begin(),
+                                         detections.end(),
+                                         [](const Detection& d)
+                                         { return d.frequency > d.truth * 1.5f || d.frequency < d.truth * 0.75f; });
+    printf("%zu detections in %zu plucks, %zu of them octave errors\n", count, reference.plucks, octave_errors);
+    printf("%-10s %10s %7s %9s %16s %11s %11s\n",
+           "",
+           CYCLE_COUNTER_UNIT "/det",
+           "allocs",
+           "off note",
+           "settled     ms",
+           "attack rms",
+           "sustain rms");
+    const std::pair<const char*, const ChainResult*> rows[] = {
+        {"reference", &reference}, {"fixed", &smoothing}, {"outliers", &pitch}, {"adaptive", &adaptive}};
+    for (const auto& row : rows)
+    {
+        const ChainResult& r = *row.second;
+        printf("%-10s %10.1f %7zu %9zu %5zu/%-5zu %5.0f %11.2f %11.2f\n",
+               row.first,
+               r.cycles,
+               r.allocations,
+               r.off_note,
+               r.settled,
+               r.plucks,
+               r.settle_ms,
+               r.attack_rms,
+               r.sustain_rms);
+    }
+    printf("fixed max difference to the reference %.5f cents\n\n", max_cents);
+
+    std::vector<float> values(count);
+    std::mt19937 rng(5678);
+    for (float& v : values)
+        v = 80.0f + (float)(rng() % 4000) * 0.1f;
+    printf("%-10s %10s %8s\n", "", CYCLE_COUNTER_UNIT "/val", "allocs");
+    bench_median<5>(values);
+    bench_median<9>(values);
+    bench_median<21>(values);
+
+    // Few distinct values, so the window is full of ties
+    std::vector<float> ties(std::min(count, (size_t)20000));
+    for (float& v : ties)
+        v = (float)(rng() % 8);
+    size_t mismatches = check_medians(ties) + check_medians(std::vector<float>(values.begin(), values.begin() + ties.size()));
+    printf("\nmedian mismatches against sorting %zu\n", mismatches);
+    size_t non_finite = check_non_finite(std::vector<float>(values.begin(), values.begin() + ties.size()));
+    printf("median mismatches with NaN and inf in the input %zu\n", non_finite);
+
+    return max_cents > FILTER_BENCH_MAX_CENTS || smoothing.allocations || pitch.allocations || adaptive.allocations ||
+                   mismatches || non_finite
+               ? 1
+               : 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file hal_host.cpp
+ * @author d4rkmen
+ * @brief Headless HAL for the host: in-memory display, scripted keyboard, mic fed from a source
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "hal_host.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "host_platform.h"
+
+static const char* TAG = "HAL";
+
+using namespace HAL;
+
+PanelMemory::PanelMemory(uint16_t width, uint16_t height)
+{
+    auto cfg = config();
+    cfg.memory_width = cfg.panel_width = width;
+    cfg.memory_height = cfg.panel_height = height;
+    config(cfg);
+    setBus(&_bus_null);
+    setColorDepth(lgfx::rgb565_2Byte);
+}
+
+bool PanelMemory::init(bool use_reset)
+{
+    auto cfg = config();
+    _pixels.assign((size_t)cfg.panel_width * cfg.panel_height * 2, 0);
+    _lines.resize(cfg.panel_height);
+    for (size_t y = 0; y < _lines.size(); y++)
+        _lines[y] = &_pixels[y * cfg.panel_width * 2];
+    _lines_buffer = _lines.data();
+    return Panel_FrameBufferBase::init(use_reset);
+}
+
+HalHost::HalHost() : _panel(HAL_HOST_DISPLAY_WIDTH, HAL_HOST_DISPLAY_HEIGHT)
+{
+    for (auto& bits : _matrix)
+        bits = 0;
+}
+
+HalHost::~HalHost()
+{
+    host_gpio_set_input(nullptr, nullptr);
+#ifdef HAVE_MIC
+    delete _mic;
+#endif
+    delete _keyboard;
+    delete _flush;
+    delete _display;
+}
+
+void HalHost::init()
+{
+    ESP_LOGI(TAG, "init host display");
+    _display = new LGFX_Device;
+    _display->setPanel(&_panel);
+    _display->init();
+    _flush = new DisplayFlush(_display);
+    if (!_flush->begin())
+    {
+        ESP_LOGE(TAG, "Failed to start the display flush");
+    }
+
+    host_gpio_set_input(_read_matrix, this);
+    _keyboard = new KEYBOARD::Keyboard;
+    _keyboard->init();
+
+#ifdef HAVE_MIC
+    _mic = new m5::Mic_Class;
+    _mic->begin();
+#endif
+}
+
+bool HalHost::_key_position(int key_num, uint8_t& output, uint8_t& input) const
+{
+    // The inverse of Keyboard::updateKeyList()
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        for (uint8_t j = 0; j < 7; j++)
+        {
+            int x = (i > 3) ? KEYBOARD::X_map_chart[j].x_1 : KEYBOARD::X_map_chart[j].x_2;
+            int y = 3 - ((i > 3) ? (i - 4) : i);
+            if (y * 14 + x + 1 == key_num)
+            {
+                output = i;
+                input = j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void HalHost::press_key(int key_num)
+{
+    uint8_t output, input;
+    if (_key_position(key_num, output, input))
+        _matrix[output] |= (uint8_t)(1 << input);
+}
+
+void HalHost::release_key(int key_num)
+{
+    uint8_t output, input;
+    if (_key_position(key_num, output, input))
+        _matrix[output] &= (uint8_t)~(1 << input);
+}
+
+void HalHost::release_keys()
+{
+    for (auto& bits : _matrix)
+        bits = 0;
+}
+
+int HalHost::_read_matrix(int pin, const uint8_t* levels, void* user)
+{
+    HalHost* self = static_cast<HalHost*>(user);
+    const std::vector<int>& outputs = KEYBOARD::output_list;
+    const std::vector<int>& inputs = KEYBOARD::input_list;
+    uint8_t output = levels[outputs[0]] | (levels[outputs[1]] << 1) | (levels[outputs[2]] << 2);
+    for (size_t j = 0; j < inputs.size(); j++)
+    {
+        // Pressed keys pull their input low
+        if (inputs[j] == pin)
+            return (self->_matrix[output] >> j) & 1 ? 0 : 1;
+    }
+    return levels[pin];
+}
+
+void HalHost::set_mic_source(m5::Mic_Class::Source source)
+{
+#ifdef HAVE_MIC
+    _mic->end();
+    _mic->set_source(source);
+    _mic->begin();
+#endif
+}
+
+bool HalHost::screenshot(LGFX_Sprite* dst)
+{
+    _flush->wait();
+    int32_t w = _display->width();
+    int32_t h = _display->height();
+    if (dst->width() != w || dst->height() != h || dst->getColorDepth() != lgfx::rgb565_2Byte)
+    {
+        dst->deleteSprite();
+        dst->setColorDepth(lgfx::rgb565_2Byte);
+        if (dst->createSprite(w, h) == nullptr)
+            return false;
+    }
+    _display->readRect(0, 0, w, h, static_cast<lgfx::swap565_t*>(dst->getBuffer()));
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file hal_host.h
+ * @author d4rkmen
+ * @brief Headless HAL for the host: in-memory display, scripted keyboard, mic fed from a source
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include "hal.h"
+#include "lgfx/v1/Bus.hpp"
+#include "lgfx/v1/panel/Panel_FrameBufferBase.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// The Cardputer's ST7789 in landscape
+#define HAL_HOST_DISPLAY_WIDTH 240
+#define HAL_HOST_DISPLAY_HEIGHT 135
+
+namespace HAL
+{
+    /**
+     * @brief An RGB565 panel that only lives in memory
+     */
+    class PanelMemory : public lgfx::Panel_FrameBufferBase
+    {
+    public:
+        PanelMemory(uint16_t width, uint16_t height);
+
+        bool init(bool use_reset) override;
+
+    private:
+        lgfx::Bus_NULL _bus_null;
+        std::vector<uint8_t> _pixels;
+        std::vector<uint8_t*> _lines;
+    };
+
+    /**
+     * @brief The Cardputer HAL without the Cardputer
+     *
+     * The display is a PanelMemory behind the same DisplayFlush the device
+     * uses, so frames go through the double buffer and the flush task like
+     * they do on the hardware. Keys are pressed by setting the levels the
+     * Keyboard scans its matrix for. The mic produces blocks in real time
+     * from whatever source is set, silence without one.
+     */
+    class HalHost : public Hal
+    {
+    public:
+        HalHost();
+        ~HalHost();
+
+        std::string type() override { return "host"; }
+        void init() override;
+
+        // KEY_NUM_* of keyboard.h, seen by the next updateKeyList()
+        void press_key(int key_num);
+        void release_key(int key_num);
+        void release_keys();
+
+        void set_mic_source(m5::Mic_Class::Source source);
+
+        /**
+         * @brief Copy what is on the panel into a 16-bit sprite of the display's size
+         *
+         * Waits for the flush in progress first.
+         */
+        bool screenshot(LGFX_Sprite* dst);
+
+    private:
+        static int _read_matrix(int pin, const uint8_t* levels, void* user);
+        bool _key_position(int key_num, uint8_t& output, uint8_t& input) const;
+
+        PanelMemory _panel;
+        std::atomic<uint8_t> _matrix[8]; // Pressed input bits for each output value of the scan
+    };
+} // namespace HAL
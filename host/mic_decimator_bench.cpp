@@ -0,0 +1,190 @@
+/**
+ * @file mic_decimator_bench.cpp
+ * @author d4rkmen
+ * @brief Checks the Mic_Class block decimator against the per-sample loop it replaced and times both
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "cycle_counter.h"
+#include "mic_decimator.hpp"
+
+struct DecimatorConfig
+{
+    int32_t oversampling;
+    int32_t magnification;
+    int32_t noise_filter;
+    bool use_adc;
+    bool swap_channels;
+};
+
+/// @brief The per-sample loop of Mic_Class::mic_task before the block decimator, one output at a time.
+class ReferenceDecimator
+{
+public:
+    explicit ReferenceDecimator(const DecimatorConfig& cfg)
+        : _cfg(cfg), _f_gain((float)cfg.magnification / (cfg.oversampling << 1)), _os_remain(cfg.oversampling)
+    {
+    }
+
+    size_t process(const int16_t* src, size_t src_len, int32_t* dst)
+    {
+        size_t out = 0;
+        size_t src_idx = 0;
+        src_len &= ~(size_t)1;
+        while (src_idx < src_len)
+        {
+            do
+            {
+                _sum_value[0] += src[src_idx];
+                _sum_value[1] += src[src_idx + 1];
+                src_idx += 2;
+            } while (--_os_remain && (src_idx < src_len));
+
+            if (_os_remain)
+                continue;
+            _os_remain = _cfg.oversampling;
+
+            auto sv0 = _cfg.swap_channels ? _sum_value[1] : _sum_value[0];
+            auto sv1 = _cfg.swap_channels ? _sum_value[0] : _sum_value[1];
+            if (_cfg.use_adc)
+            {
+                sv0 -= 2048 * _cfg.oversampling;
+                sv1 -= 2048 * _cfg.oversampling;
+            }
+
+            auto value_tmp = (sv0 + sv1) << 3;
+            int32_t offset = _offset;
+            offset -= (value_tmp + offset + 16) >> 5;
+            _offset = offset;
+            offset = (offset + 8) >> 4;
+            _sum_value[0] = sv0 + offset;
+            _sum_value[1] = sv1 + offset;
+
+            int32_t noise_filter = _cfg.noise_filter;
+            if (noise_filter)
+            {
+                for (int i = 0; i < 2; ++i)
+                {
+                    int32_t v = (_sum_value[i] * (256 - noise_filter) + _prev_value[i] * noise_filter + 128) >> 8;
+                    _prev_value[i] = v;
+                    _sum_value[i] = v * _f_gain;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < 2; ++i)
+                    _sum_value[i] *= _f_gain;
+            }
+            dst[out * 2] = _sum_value[0];
+            dst[out * 2 + 1] = _sum_value[1];
+            out++;
+            _sum_value[0] = 0;
+            _sum_value[1] = 0;
+        }
+        return out;
+    }
+
+private:
+    DecimatorConfig _cfg;
+    float _f_gain;
+    int32_t _os_remain;
+    int32_t _offset = 0;
+    int32_t _sum_value[2] = {0, 0};
+    int32_t _prev_value[2] = {0, 0};
+};
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -b, --blocks N  DMA buffers per configuration (default 2000)\n"
+            "  -l, --len N     DMA buffer length in int16 samples (default 256)\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    size_t blocks = 2000;
+    size_t dma_len = 256;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if ((!strcmp(arg, "-b") || !strcmp(arg, "--blocks")) && i + 1 < argc)
+            blocks = strtoul(argv[++i], nullptr, 10);
+        else if ((!strcmp(arg, "-l") || !strcmp(arg, "--len")) && i + 1 < argc)
+            dma_len = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (blocks == 0 || dma_len < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    std::vector<int16_t> input(blocks * dma_len);
+    for (auto& s : input)
+        s = (int16_t)(rng() & 0xFFFF);
+
+    printf("%4s %4s %5s %4s %4s %10s %14s %14s\n", "os", "mag", "noise", "adc", "swap", "mismatch",
+           "ref " CYCLE_COUNTER_UNIT "/out", "block " CYCLE_COUNTER_UNIT "/out");
+
+    int failures = 0;
+    for (int32_t os : {1, 2, 3, 4, 8})
+        for (int32_t noise : {0, 64, 255})
+            for (int adc = 0; adc < 2; adc++)
+                for (int swap = 0; swap < 2; swap++)
+                {
+                    DecimatorConfig cfg = {os, 4, noise, adc != 0, swap != 0};
+                    ReferenceDecimator ref(cfg);
+                    m5::mic_decimator_t dec;
+                    dec.setup(os, (float)cfg.magnification / (os << 1), noise, cfg.use_adc, cfg.swap_channels);
+
+                    std::vector<int32_t> ref_out(dma_len + 4), dec_out(dma_len + 4);
+                    size_t mismatches = 0, outputs = 0;
+                    uint64_t ref_cycles = 0, dec_cycles = 0;
+                    for (size_t b = 0; b < blocks; b++)
+                    {
+                        // Vary the block length so outputs straddle block boundaries
+                        size_t len = dma_len - 2 * (rng() % 3);
+                        const int16_t* src = &input[b * dma_len];
+
+                        uint64_t start = cycle_count();
+                        size_t n_ref = ref.process(src, len, ref_out.data());
+                        ref_cycles += cycle_count() - start;
+
+                        start = cycle_count();
+                        size_t n_dec = dec.process(src, len, dec_out.data());
+                        dec_cycles += cycle_count() - start;
+
+                        outputs += n_ref;
+                        if (n_ref != n_dec)
+                        {
+                            mismatches++;
+                            continue;
+                        }
+                        if (memcmp(ref_out.data(), dec_out.data(), n_ref * 2 * sizeof(int32_t)))
+                            mismatches++;
+                    }
+                    failures += mismatches != 0;
+                    printf("%4d %4d %5d %4d %4d %10zu %14.1f %14.1f\n", os, cfg.magnification, noise, adc, swap,
+                           mismatches, outputs ? (double)ref_cycles / outputs : 0.0,
+                           outputs ? (double)dec_cycles / outputs : 0.0);
+                }
+
+    printf("\n%s\n", failures ? "FAILED: block decimator differs from the reference" : "bit-exact");
+    return failures ? 1 : 0;
+}
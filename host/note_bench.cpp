@@ -0,0 +1,107 @@
+/**
+ * @file note_bench.cpp
+ * @author d4rkmen
+ * @brief The compile time note table against the double log2/pow note lookup it replaced
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "pitch/note_table.h"
+#include "pitch/pitch_pipeline.h"
+#include "cycle_counter.h"
+
+// Sweep of the whole tuner range, log spaced
+#define NOTE_BENCH_LOW_HZ 20.0
+#define NOTE_BENCH_HIGH_HZ 5000.0
+#define NOTE_BENCH_POINTS 100000
+#define NOTE_BENCH_ROUNDS 20
+
+/// @brief get_frequency_info() as it was, the reference
+static void reference_info(float input_freq, FrequencyInfo* freqInfo)
+{
+    double midi_note_float = 12.0 * log2(static_cast<double>(input_freq) / A4_FREQ) + 69.0;
+    int midi_note = static_cast<int>(round(midi_note_float));
+    double closest_note_freq = A4_FREQ * pow(2.0, (static_cast<double>(midi_note) - 69.0) / 12.0);
+    double cents_deviation = 1200.0 * log2(static_cast<double>(input_freq) / closest_note_freq);
+    freqInfo->frequency = input_freq;
+    freqInfo->targetFrequency = static_cast<float>(closest_note_freq);
+    freqInfo->targetNote = static_cast<TunerNoteName>((midi_note % 12 + 12) % 12);
+    freqInfo->targetOctave = midi_note / 12 - 1;
+    freqInfo->cents = static_cast<float>(cents_deviation);
+}
+
+/// @brief Cycles per call over the sweep, the best of a few rounds
+template <typename Lookup> static double cycles_per_call(const std::vector<float>& sweep, Lookup lookup)
+{
+    double best = 1e30;
+    float sink = 0;
+    for (int round = 0; round < NOTE_BENCH_ROUNDS; round++)
+    {
+        uint64_t start = cycle_count();
+        for (float hz : sweep)
+        {
+            FrequencyInfo info;
+            lookup(hz, &info);
+            sink += info.cents;
+        }
+        double per_call = (double)(cycle_count() - start) / sweep.size();
+        if (per_call < best)
+            best = per_call;
+    }
+    // Keeps the loops from being optimized away
+    if (sink == 12345.0f)
+        printf(" ");
+    return best;
+}
+
+int main()
+{
+    std::vector<float> sweep(NOTE_BENCH_POINTS);
+    for (size_t i = 0; i < sweep.size(); i++)
+        sweep[i] = (float)(NOTE_BENCH_LOW_HZ * pow(NOTE_BENCH_HIGH_HZ / NOTE_BENCH_LOW_HZ, (double)i / (sweep.size() - 1)));
+
+    // Table entries against the exact equal temperament frequencies
+    double table_error = 0;
+    for (int midi = 0; midi < NOTE_TABLE_SIZE; midi++)
+    {
+        double exact = A4_FREQ * pow(2.0, (midi - NOTE_MIDI_A4) / 12.0);
+        table_error = fmax(table_error, fabs(1200.0 * log2(TunerNotes::frequency(midi) / exact)));
+    }
+
+    // Same note and the same cents as the reference for every frequency
+    int note_mismatches = 0;
+    double cents_error = 0, target_error = 0;
+    for (float hz : sweep)
+    {
+        FrequencyInfo expected, actual;
+        reference_info(hz, &expected);
+        get_frequency_info(hz, &actual);
+        if (expected.targetNote != actual.targetNote || expected.targetOctave != actual.targetOctave)
+        {
+            // Exactly half way between two notes either one is right
+            if (fabs(fabs(expected.cents) - 50) > 0.01)
+                note_mismatches++;
+            continue;
+        }
+        cents_error = fmax(cents_error, fabs(expected.cents - actual.cents));
+        target_error = fmax(target_error, fabs(1200.0 * log2(actual.targetFrequency / expected.targetFrequency)));
+    }
+
+    double reference = cycles_per_call(sweep, reference_info);
+    double table = cycles_per_call(sweep, [](float hz, FrequencyInfo* info) { get_frequency_info(hz, info); });
+
+    printf("%d frequencies, %.0f .. %.0f Hz\n", NOTE_BENCH_POINTS, NOTE_BENCH_LOW_HZ, NOTE_BENCH_HIGH_HZ);
+    printf("table entries    max %.5f cents off equal temperament\n", table_error);
+    printf("note mismatches  %d\n", note_mismatches);
+    printf("cents            max %.5f off the reference\n", cents_error);
+    printf("target frequency max %.5f cents off the reference\n", target_error);
+    printf("log2/pow double  %7.1f %s/call\n", reference, CYCLE_COUNTER_UNIT);
+    printf("note table       %7.1f %s/call\n", table, CYCLE_COUNTER_UNIT);
+    return note_mismatches || cents_error > 0.01 ? 1 : 0;
+}
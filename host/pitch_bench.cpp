@@ -0,0 +1,370 @@
+/**
+ * @file pitch_bench.cpp
+ * @author d4rkmen
+ * @brief Accuracy and latency benchmark for the tuner pitch pipeline
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "pitch/dsp_profile.h"
+#include "pitch/pitch_pipeline.h"
+#include "pitch/pitch_profile.h"
+#include "cycle_counter.h"
+#include "signal_gen.h"
+#include "wav_reader.h"
+
+// A reading more than this far from the expected pitch is a wrong note
+#define WRONG_NOTE_CENTS 50.0
+// time-to-stable: every published reading from then on is within this
+#define STABLE_CENTS 1.0
+
+struct BenchResult
+{
+    std::string name;
+    float frequency = 0;
+    double lock_s = NAN;       // onset -> first published reading of the right note
+    double stable_s = NAN;     // onset -> readings stay within STABLE_CENTS until the end
+    size_t published = 0;
+    size_t octave_errors = 0;
+    size_t wrong_notes = 0;    // off by more than WRONG_NOTE_CENTS but not by whole octaves
+    double mean_abs_cents = 0; // over the right-note readings
+    uint64_t frame_cycles = 0; // sum over the blocks with signal
+    size_t frames = 0;
+    size_t frame_size = 0;
+};
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s, --step N        semitones between synthetic notes (default 1)\n"
+            "  -k, --kinds LIST    comma separated: ks,inharmonic,noisy,sweep,repluck (default all)\n"
+            "  -d, --recorded DIR  also run every .wav/.raw/.pcm in DIR, named after their note (\"E2_pick.wav\")\n"
+            "  -m, --mode NAME     use the device profile of a tuning mode: auto,guitar,ukulele,violin\n"
+            "                      (sets rate, block, window and note range)\n"
+            "  -t, --target        tune to each signal's note with the narrowband target detector\n"
+            "  -f, --frame N       samples per block fed to the pipeline (default %d)\n"
+            "  -r, --rate N        sample rate for synthetic and raw input (default %d)\n"
+            "  -x, --fixed         the fixed smoothing chain instead of the adaptive one\n"
+            "  -p, --repluck C     cents off the note of the first pluck of a repluck signal (default -25)\n"
+            "  -c, --csv           print one CSV line per signal\n",
+            name,
+            TUNER_HOP_SIZE,
+            TUNER_SAMPLE_RATE);
+}
+
+static BenchResult run_signal(const TestSignal& signal, size_t frame_size, PitchPipelineConfig config, bool target)
+{
+    BenchResult r;
+    r.name = signal.name;
+    r.frequency = signal.frequency;
+    r.frame_size = frame_size;
+
+    config.sample_rate = signal.sample_rate;
+    if (target)
+        config.target_frequency = signal.frequency;
+    PitchPipeline pipeline(config);
+
+    double abs_cents = 0;
+    size_t right_notes = 0;
+    for (size_t pos = 0; pos + frame_size <= signal.samples.size(); pos += frame_size)
+    {
+        uint64_t start = cycle_count();
+        DSP_PROFILE_BEGIN(pipeline_start);
+        PitchFrameResult result = pipeline.process(&signal.samples[pos], frame_size);
+        DSP_PROFILE_END(DSP_STAGE_PIPELINE, pipeline_start);
+        DSP_PROFILE_END_HOP();
+        uint64_t cycles = cycle_count() - start;
+        if (pos + frame_size > signal.onset)
+        {
+            r.frame_cycles += cycles;
+            r.frames++;
+        }
+        // Readings of the pluck before the measured one don't count
+        if (!result.publish || result.reading.sample_index < signal.onset)
+            continue;
+
+        // The reading becomes visible once the whole frame has been processed
+        double t = (double)((int64_t)(pos + frame_size) - (int64_t)signal.onset) / signal.sample_rate;
+        float expected = signal.expected_frequency(result.reading.sample_index);
+        double cents = 1200.0 * std::log2(result.reading.info.frequency / expected);
+        double octaves = std::round(cents / 1200.0);
+        r.published++;
+
+        if (std::fabs(cents) <= WRONG_NOTE_CENTS)
+        {
+            right_notes++;
+            abs_cents += std::fabs(cents);
+            if (std::isnan(r.lock_s))
+                r.lock_s = t;
+        }
+        else if (octaves != 0 && std::fabs(cents - octaves * 1200.0) <= WRONG_NOTE_CENTS)
+            r.octave_errors++;
+        else
+            r.wrong_notes++;
+
+        if (std::fabs(cents) > STABLE_CENTS)
+            r.stable_s = NAN;
+        else if (std::isnan(r.stable_s))
+            r.stable_s = t;
+    }
+    r.mean_abs_cents = right_notes ? abs_cents / right_notes : NAN;
+    return r;
+}
+
+static bool load_recorded(const std::filesystem::path& path, uint32_t raw_rate, TestSignal& signal, std::string& error)
+{
+    std::string stem = path.stem().string();
+    signal.frequency = parse_note_label(stem);
+    if (signal.frequency <= 0)
+    {
+        error = path.string() + ": file name doesn't start with a note name, skipped";
+        return false;
+    }
+    AudioClip clip;
+    if (!load_audio(path.string(), raw_rate, clip, error))
+        return false;
+    signal.name = "rec_" + stem;
+    signal.sample_rate = clip.sample_rate;
+    signal.samples = std::move(clip.samples);
+
+    // Onset is where the signal first reaches the level that starts a note
+    signal.onset = 0;
+    while (signal.onset < signal.samples.size() && std::abs(signal.samples[signal.onset]) < TUNER_ONSET_LEVEL)
+        signal.onset++;
+    return true;
+}
+
+// CPU cost is always reported per TUNER_FRAME_SIZE samples, whatever the block size
+static double cycles_per_frame(uint64_t cycles, size_t samples)
+{
+    return samples ? (double)cycles * TUNER_FRAME_SIZE / samples : 0.0;
+}
+
+static void print_csv_header()
+{
+    printf("signal,freq_hz,lock_ms,stable_ms,published,octave_errors,wrong_notes,mean_abs_cents," CYCLE_COUNTER_UNIT
+           "_per_frame\n");
+}
+
+static void print_csv(const BenchResult& r)
+{
+    printf("%s,%.3f,%.1f,%.1f,%zu,%zu,%zu,%.3f,%.0f\n",
+           r.name.c_str(),
+           r.frequency,
+           r.lock_s * 1000.0,
+           r.stable_s * 1000.0,
+           r.published,
+           r.octave_errors,
+           r.wrong_notes,
+           r.mean_abs_cents,
+           cycles_per_frame(r.frame_cycles, r.frames * r.frame_size));
+}
+
+static double median(std::vector<double> v)
+{
+    if (v.empty())
+        return NAN;
+    std::sort(v.begin(), v.end());
+    return v.size() % 2 ? v[v.size() / 2] : (v[v.size() / 2 - 1] + v[v.size() / 2]) / 2;
+}
+
+static void print_summary(const char* group, const std::vector<BenchResult>& results)
+{
+    std::vector<double> lock, stable;
+    size_t published = 0, octave_errors = 0, wrong_notes = 0, samples = 0;
+    uint64_t cycles = 0;
+    for (const auto& r : results)
+    {
+        if (!std::isnan(r.lock_s))
+            lock.push_back(r.lock_s * 1000.0);
+        if (!std::isnan(r.stable_s))
+            stable.push_back(r.stable_s * 1000.0);
+        published += r.published;
+        octave_errors += r.octave_errors;
+        wrong_notes += r.wrong_notes;
+        samples += r.frames * r.frame_size;
+        cycles += r.frame_cycles;
+    }
+    printf("%-12s %7zu %6zu/%-6zu %9.1f %6zu/%-6zu %9.1f %8.2f%% %8.2f%% %14.0f\n",
+           group,
+           results.size(),
+           lock.size(),
+           results.size(),
+           median(lock),
+           stable.size(),
+           results.size(),
+           median(stable),
+           published ? 100.0 * octave_errors / published : 0.0,
+           published ? 100.0 * wrong_notes / published : 0.0,
+           cycles_per_frame(cycles, samples));
+}
+
+int main(int argc, char** argv)
+{
+    int step = 1;
+    size_t frame_size = TUNER_HOP_SIZE;
+    bool csv = false;
+    bool target = false;
+    bool fixed_smoothing = false;
+    std::string recorded_dir;
+    std::vector<SignalKind> kinds;
+    SignalParams params;
+    PitchPipelineConfig config;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if ((!strcmp(arg, "-s") || !strcmp(arg, "--step")) && has_value)
+            step = std::max(1, atoi(argv[++i]));
+        else if ((!strcmp(arg, "-f") || !strcmp(arg, "--frame")) && has_value)
+            frame_size = strtoul(argv[++i], nullptr, 10);
+        else if ((!strcmp(arg, "-r") || !strcmp(arg, "--rate")) && has_value)
+            params.sample_rate = strtoul(argv[++i], nullptr, 10);
+        else if ((!strcmp(arg, "-d") || !strcmp(arg, "--recorded")) && has_value)
+            recorded_dir = argv[++i];
+        else if ((!strcmp(arg, "-k") || !strcmp(arg, "--kinds")) && has_value)
+        {
+            std::string list = argv[++i];
+            for (int k = 0; k < SIGNAL_COUNT; k++)
+                if (("," + list + ",").find(std::string(",") + signal_kind_name((SignalKind)k) + ",") != std::string::npos)
+                    kinds.push_back((SignalKind)k);
+        }
+        else if ((!strcmp(arg, "-m") || !strcmp(arg, "--mode")) && has_value)
+        {
+            const char* name = argv[++i];
+            int mode = 0;
+            while (mode < MODE_COUNT && strcmp(pitch_profile_for_mode((TunerMode)mode).name, name))
+                mode++;
+            if (mode == MODE_COUNT)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            const PitchProfile& profile = pitch_profile_for_mode((TunerMode)mode);
+            config = pitch_pipeline_config(profile);
+            frame_size = profile.hop_size;
+            params.sample_rate = profile.sample_rate;
+        }
+        else if (!strcmp(arg, "-t") || !strcmp(arg, "--target"))
+            target = true;
+        else if ((!strcmp(arg, "-p") || !strcmp(arg, "--repluck")) && has_value)
+            params.repluck_cents = (float)atof(argv[++i]);
+        else if (!strcmp(arg, "-x") || !strcmp(arg, "--fixed"))
+            fixed_smoothing = true;
+        else if (!strcmp(arg, "-c") || !strcmp(arg, "--csv"))
+            csv = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (frame_size == 0 || params.sample_rate == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    // After --mode, which starts from a fresh config
+    config.adaptive_smoothing = !fixed_smoothing;
+    if (kinds.empty())
+        for (int k = 0; k < SIGNAL_COUNT; k++)
+            kinds.push_back((SignalKind)k);
+
+    // Cover the whole detector range, from low_fs to high_fs
+    int low_midi = (int)std::ceil(12.0 * std::log2(cycfi::q::as_double(config.low_fs) / A4_FREQ) + 69.0 - 0.01);
+    int high_midi = (int)std::floor(12.0 * std::log2(cycfi::q::as_double(config.high_fs) / A4_FREQ) + 69.0 + 0.01);
+
+    if (csv)
+        print_csv_header();
+
+    std::vector<std::pair<std::string, std::vector<BenchResult>>> groups;
+    for (SignalKind kind : kinds)
+    {
+        std::vector<BenchResult> results;
+        for (int midi = low_midi; midi <= high_midi; midi += step)
+        {
+            float f = (float)(A4_FREQ * std::pow(2.0, (midi - 69) / 12.0));
+            params.seed = midi;
+            results.push_back(run_signal(make_signal(kind, f, params), frame_size, config, target));
+            if (csv)
+                print_csv(results.back());
+        }
+        groups.emplace_back(signal_kind_name(kind), std::move(results));
+    }
+
+    if (!recorded_dir.empty())
+    {
+        std::vector<std::filesystem::path> paths;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(recorded_dir, ec))
+        {
+            std::string ext = entry.path().extension().string();
+            if (ext == ".wav" || ext == ".WAV" || ext == ".raw" || ext == ".pcm")
+                paths.push_back(entry.path());
+        }
+        if (ec)
+            fprintf(stderr, "%s: %s\n", recorded_dir.c_str(), ec.message().c_str());
+        std::sort(paths.begin(), paths.end());
+
+        std::vector<BenchResult> results;
+        for (const auto& path : paths)
+        {
+            TestSignal signal;
+            std::string error;
+            if (!load_recorded(path, params.sample_rate, signal, error))
+            {
+                fprintf(stderr, "%s\n", error.c_str());
+                continue;
+            }
+            results.push_back(run_signal(signal, frame_size, config, target));
+            if (csv)
+                print_csv(results.back());
+        }
+        groups.emplace_back("recorded", std::move(results));
+    }
+
+    if (csv)
+        return 0;
+
+    printf("%s detector, %s smoothing, %u Hz, block %zu samples, window %zu, cpu per %d samples, %s .. %s every %d "
+           "semitone(s)\n\n",
+           target ? "target" : "full range",
+           fixed_smoothing ? "fixed" : "adaptive",
+           params.sample_rate,
+           frame_size,
+           config.window_size,
+           TUNER_FRAME_SIZE,
+           note_label((float)cycfi::q::as_double(config.low_fs)).c_str(),
+           note_label((float)cycfi::q::as_double(config.high_fs)).c_str(),
+           step);
+    printf("%-12s %7s %13s %9s %13s %9s %9s %9s %14s\n",
+           "signals",
+           "count",
+           "locked",
+           "lock ms",
+           "stable",
+           "stable ms",
+           "octave",
+           "wrong",
+           CYCLE_COUNTER_UNIT "/frame");
+    for (const auto& group : groups)
+        print_summary(group.first.c_str(), group.second);
+#if defined(HAVE_DSP_PROFILE)
+    printf("\nper block, silent ones included:\n");
+    dspProfile.dump([](const char* line, void* user) { printf("%s\n", line); }, nullptr);
+#endif
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file pitch_replay.cpp
+ * @author d4rkmen
+ * @brief Replays WAV / raw PCM files through the tuner pitch pipeline
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pitch/pitch_pipeline.h"
+#include "wav_reader.h"
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] file...\n"
+            "  -f, --frame N   samples per block fed to the pipeline (default %d, like the device)\n"
+            "  -r, --rate N    sample rate of .raw/.pcm input (default %d)\n"
+            "  -t, --target HZ only look around this note, like the string modes\n"
+            "  -q, --quiet     print the summary only\n"
+            "\n"
+            "Prints one CSV line per frame:\n"
+            "  file,frame,time_s,status,range,onset,detections,published,raw_hz,freq_hz,note,octave,cents,confidence,detect_sample,detect_s\n",
+            name,
+            TUNER_HOP_SIZE,
+            TUNER_SAMPLE_RATE);
+}
+
+static const char* status_name(PitchFrameStatus status)
+{
+    switch (status)
+    {
+    case PITCH_FRAME_SILENT:
+        return "silent";
+    case PITCH_FRAME_NO_PITCH:
+        return "no_pitch";
+    case PITCH_FRAME_PITCH:
+        return "pitch";
+    default:
+        return "unknown";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t frame_size = TUNER_HOP_SIZE;
+    uint32_t raw_rate = TUNER_SAMPLE_RATE;
+    float target = 0;
+    bool quiet = false;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if ((!strcmp(arg, "-f") || !strcmp(arg, "--frame")) && i + 1 < argc)
+            frame_size = strtoul(argv[++i], nullptr, 10);
+        else if ((!strcmp(arg, "-r") || !strcmp(arg, "--rate")) && i + 1 < argc)
+            raw_rate = strtoul(argv[++i], nullptr, 10);
+        else if ((!strcmp(arg, "-t") || !strcmp(arg, "--target")) && i + 1 < argc)
+            target = strtof(argv[++i], nullptr);
+        else if (!strcmp(arg, "-q") || !strcmp(arg, "--quiet"))
+            quiet = true;
+        else if (arg[0] == '-')
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+            files.push_back(arg);
+    }
+    if (files.empty() || frame_size == 0 || raw_rate == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!quiet)
+        printf("file,frame,time_s,status,range,onset,detections,published,raw_hz,freq_hz,note,octave,cents,confidence,detect_sample,detect_s\n");
+
+    int failures = 0;
+    for (const std::string& path : files)
+    {
+        AudioClip clip;
+        std::string error;
+        if (!load_audio(path, raw_rate, clip, error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            failures++;
+            continue;
+        }
+
+        PitchPipelineConfig config;
+        config.sample_rate = clip.sample_rate;
+        config.target_frequency = target;
+        PitchPipeline pipeline(config);
+        if (pipeline.target() != target)
+            fprintf(stderr, "%s: %.2f Hz can't be targeted at %u Hz, searching the full range\n", path.c_str(), target,
+                    clip.sample_rate);
+
+        size_t frames = 0, detections = 0, published = 0;
+        double busy_s = 0;
+        for (size_t pos = 0; pos + frame_size <= clip.samples.size(); pos += frame_size, frames++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            PitchFrameResult result = pipeline.process(&clip.samples[pos], frame_size);
+            busy_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            detections += result.detections;
+            published += result.publish;
+            if (quiet)
+                continue;
+
+            const PitchReading& r = result.reading;
+            bool has_reading = result.detections > 0;
+            printf("%s,%zu,%.4f,%s,%d,%d,%zu,%d,",
+                   path.c_str(),
+                   frames,
+                   (double)pos / clip.sample_rate,
+                   status_name(result.status),
+                   (int)result.range,
+                   result.onset ? 1 : 0,
+                   result.detections,
+                   result.publish ? 1 : 0);
+            if (has_reading)
+                printf("%.3f,%.3f,%s,%d,%.2f,%.3f,%llu,%.4f\n",
+                       r.raw_frequency,
+                       r.info.frequency,
+                       name_for_note(r.info.targetNote),
+                       r.info.targetOctave,
+                       r.info.cents,
+                       r.info.confidence,
+                       (unsigned long long)r.sample_index,
+                       (double)r.sample_index / clip.sample_rate);
+            else
+                printf(",,,,,,,\n");
+        }
+
+        double audio_s = (double)clip.samples.size() / clip.sample_rate;
+        fprintf(stderr,
+                "%s: %u Hz, %.2f s audio, %zu frames, %zu detections, %zu published, %.3f ms cpu, %.0fx real-time\n",
+                path.c_str(),
+                clip.sample_rate,
+                audio_s,
+                frames,
+                detections,
+                published,
+                busy_s * 1000.0,
+                busy_s > 0 ? audio_s / busy_s : 0.0);
+    }
+
+    return failures ? 1 : 0;
+}
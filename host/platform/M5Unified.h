@@ -0,0 +1,103 @@
+/**
+ * @file M5Unified.h
+ * @author d4rkmen
+ * @brief Host stand-in for the parts of M5Unified the tuner uses, a mic fed from a sample source
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+
+namespace m5
+{
+    typedef enum
+    {
+        I2S_NUM_0 = 0,
+        I2S_NUM_1
+    } i2s_port_t;
+
+    struct mic_config_t
+    {
+        int pin_data_in = -1;
+        int pin_bck = -1;
+        int pin_mck = -1;
+        int pin_ws = -1;
+        uint32_t sample_rate = 16000;
+        bool left_channel = false;
+        bool stereo = false;
+        uint8_t over_sampling = 2;
+        uint8_t magnification = 16;
+        uint8_t noise_filter_level = 0;
+        bool use_adc = false;
+        size_t dma_buf_len = 128;
+        size_t dma_buf_count = 8;
+        uint8_t task_priority = 2;
+        uint8_t task_pinned_core = -1;
+        i2s_port_t i2s_port = I2S_NUM_0;
+    };
+
+    /**
+     * @brief The streaming part of Mic_Class, blocks are produced in real time from a source
+     *
+     * A thread asks the source for one block at config().sample_rate every
+     * block_len / sample_rate seconds and puts it into the ring, or counts it
+     * as dropped when the ring is full, like the mic task does.
+     */
+    class Mic_Class
+    {
+    public:
+        /// @brief Fill `count` samples at `sample_rate`, silence without one
+        typedef std::function<void(int16_t* samples, size_t count, uint32_t sample_rate)> Source;
+
+        ~Mic_Class() { end(); }
+
+        void set_source(Source source) { _source = source; }
+
+        mic_config_t config() const { return _cfg; }
+        void config(const mic_config_t& cfg) { _cfg = cfg; }
+
+        bool begin();
+        void end();
+        bool isRunning() const { return _running; }
+        bool isEnabled() const { return true; }
+
+        bool beginStream(size_t block_len, size_t block_count, TaskHandle_t notify_task = nullptr);
+        void endStream();
+        bool isStreaming() const { return !_stream_buf.empty(); }
+        const int16_t* getStreamBlock(uint32_t* seq = nullptr) const;
+        void releaseStreamBlock();
+        uint32_t getStreamDropped() const { return _stream_dropped; }
+
+    private:
+        void _produce();
+
+        mic_config_t _cfg;
+        Source _source;
+        std::thread _thread;
+        std::atomic<bool> _running{false};
+
+        std::vector<int16_t> _stream_buf;
+        std::vector<uint32_t> _stream_seq;
+        size_t _stream_block_len = 0;
+        size_t _stream_block_count = 0;
+        uint32_t _stream_produced = 0;
+        std::atomic<uint32_t> _stream_dropped{0};
+        std::atomic<size_t> _stream_head{0};
+        std::atomic<size_t> _stream_tail{0};
+        TaskHandle_t _stream_notify = nullptr;
+    };
+
+    // Not emulated, the host HAL has no speaker
+    class Speaker_Class;
+} // namespace m5
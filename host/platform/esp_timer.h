@@ -0,0 +1,16 @@
+/**
+ * @file esp_timer.h
+ * @author d4rkmen
+ * @brief Host stand-in for esp_timer_get_time(), see host_platform.h for the clock controls
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstdint>
+
+// Microseconds since the program started, or the frozen time
+int64_t esp_timer_get_time();
@@ -0,0 +1,34 @@
+/**
+ * @file FreeRTOS.h
+ * @author d4rkmen
+ * @brief Host stand-in for the FreeRTOS types, the kernel runs on std::thread
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+typedef struct HostTask* TaskHandle_t;
+typedef struct HostQueue* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t; // A queue of zero sized items, as in FreeRTOS
+typedef struct HostEventGroup* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
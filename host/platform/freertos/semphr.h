@@ -0,0 +1,18 @@
+/**
+ * @file semphr.h
+ * @author d4rkmen
+ * @brief Host stand-in for the FreeRTOS semaphores, queues of zero sized items
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "queue.h"
+
+#define xSemaphoreCreateBinary() xQueueCreate(1, 0)
+#define vSemaphoreDelete(semaphore) vQueueDelete(semaphore)
+#define xSemaphoreTake(semaphore, ticks_to_wait) xQueueReceive((semaphore), nullptr, (ticks_to_wait))
+#define xSemaphoreGive(semaphore) xQueueSend((semaphore), nullptr, 0)
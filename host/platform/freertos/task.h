@@ -0,0 +1,42 @@
+/**
+ * @file task.h
+ * @author d4rkmen
+ * @brief Host stand-in for the FreeRTOS task API
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "FreeRTOS.h"
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef void (*TaskFunction_t)(void*);
+
+// Priority, stack size and core are ignored, every task is a thread
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function,
+                                   const char* name,
+                                   uint32_t stack_depth,
+                                   void* parameter,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* created_task,
+                                   BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stack_depth,
+                       void* parameter,
+                       UBaseType_t priority,
+                       TaskHandle_t* created_task);
+// Another task is stopped the next time it blocks
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+// Threads run on the OS's stack, the whole requested depth is reported unused
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
@@ -0,0 +1,392 @@
+/**
+ * @file host_platform.cpp
+ * @author d4rkmen
+ * @brief FreeRTOS, esp_timer, esp_log and GPIO stand-ins for running the firmware code on a PC
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_platform.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Clock
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+static std::atomic<bool> s_frozen(false);
+static std::atomic<int64_t> s_frozen_us(0);
+static std::atomic<int64_t> s_offset_us(0); // Added to the steady clock after host_clock_run()
+
+static int64_t steady_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+int64_t esp_timer_get_time() { return s_frozen ? s_frozen_us.load() : steady_us() + s_offset_us; }
+
+void host_clock_freeze(int64_t us)
+{
+    s_frozen_us = us;
+    s_frozen = true;
+}
+
+void host_clock_advance(int64_t us)
+{
+    if (s_frozen)
+        s_frozen_us += us;
+}
+
+void host_clock_run()
+{
+    if (!s_frozen)
+        return;
+    s_offset_us = s_frozen_us - steady_us();
+    s_frozen = false;
+}
+
+bool host_clock_frozen() { return s_frozen; }
+
+// Log
+
+static std::atomic<int> s_log_level(ESP_LOG_INFO);
+static std::mutex s_log_lock;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) { s_log_level = level; }
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+    if (level > s_log_level)
+        return;
+    static const char Letters[] = "NEWIDV";
+    std::lock_guard<std::mutex> guard(s_log_lock);
+    fprintf(stderr, "%c (%lld) %s: ", Letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+// GPIO
+
+static uint8_t s_levels[HOST_GPIO_COUNT];
+static std::atomic<HostGpioInput> s_gpio_input(nullptr);
+static void* s_gpio_user = nullptr;
+
+void host_gpio_set_input(HostGpioInput input, void* user)
+{
+    s_gpio_user = user;
+    s_gpio_input = input;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t pin)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT)
+        return ESP_ERR_INVALID_ARG;
+    s_levels[pin] = 0;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode)
+{
+    return pin < 0 || pin >= HOST_GPIO_COUNT ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t pin, gpio_pull_mode_t pull)
+{
+    return pin < 0 || pin >= HOST_GPIO_COUNT ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT)
+        return ESP_ERR_INVALID_ARG;
+    s_levels[pin] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT)
+        return 0;
+    HostGpioInput input = s_gpio_input;
+    return input ? input(pin, s_levels, s_gpio_user) : 1;
+}
+
+// Kernel
+//
+// One lock and one condition variable for all tasks, queues and event
+// groups. Every change wakes every waiter and each checks its own
+// condition, slow but simple, and a handful of tasks is all there is.
+
+struct HostTask
+{
+    std::string name;
+    uint32_t stack_depth = 0;
+    uint32_t notify = 0;
+    bool deleted = false;
+};
+
+struct HostQueue
+{
+    size_t length;
+    size_t item_size;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+struct HostEventGroup
+{
+    EventBits_t bits = 0;
+};
+
+// Unwinds the thread of a deleted task
+struct HostTaskDeleted
+{
+};
+
+static std::mutex s_kernel;
+static std::condition_variable s_changed;
+static thread_local HostTask* t_current = nullptr;
+
+static HostTask* current_task()
+{
+    // Threads not started by xTaskCreate, like main(), get a task on first use
+    if (!t_current)
+        t_current = new HostTask{"main"};
+    return t_current;
+}
+
+/// @brief Wait with the kernel lock held until `ready` or the timeout.
+/// A frozen clock is moved on by the timeout instead.
+template <typename Ready> static bool wait_until(std::unique_lock<std::mutex>& lock, TickType_t ticks, Ready ready)
+{
+    HostTask* self = current_task();
+    auto check = [&]
+    {
+        if (self->deleted)
+            throw HostTaskDeleted();
+        return ready();
+    };
+    if (check())
+        return true;
+    if (ticks == 0)
+        return false;
+    if (ticks == portMAX_DELAY)
+    {
+        s_changed.wait(lock, check);
+        return true;
+    }
+    if (s_frozen)
+    {
+        host_clock_advance((int64_t)ticks * 1000 / configTICK_RATE_HZ * 1000);
+        return check();
+    }
+    return s_changed.wait_for(lock, std::chrono::milliseconds((int64_t)ticks * 1000 / configTICK_RATE_HZ), check);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function,
+                                   const char* name,
+                                   uint32_t stack_depth,
+                                   void* parameter,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* created_task,
+                                   BaseType_t core_id)
+{
+    // Never freed, a handle may be notified after its task is gone
+    HostTask* task = new HostTask{name ? name : "", stack_depth};
+    if (created_task)
+        *created_task = task;
+    std::thread(
+        [task, function, parameter]
+        {
+            t_current = task;
+            try
+            {
+                function(parameter);
+            }
+            catch (const HostTaskDeleted&)
+            {
+            }
+        })
+        .detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stack_depth,
+                       void* parameter,
+                       UBaseType_t priority,
+                       TaskHandle_t* created_task)
+{
+    return xTaskCreatePinnedToCore(function, name, stack_depth, parameter, priority, created_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == t_current)
+        throw HostTaskDeleted();
+    std::lock_guard<std::mutex> guard(s_kernel);
+    task->deleted = true;
+    s_changed.notify_all();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(s_kernel);
+    wait_until(lock, ticks, [] { return false; });
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(esp_timer_get_time() * configTICK_RATE_HZ / 1000000); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return current_task(); }
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return (task ? task : current_task())->stack_depth; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    std::lock_guard<std::mutex> guard(s_kernel);
+    task->notify++;
+    s_changed.notify_all();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    HostTask* self = current_task();
+    std::unique_lock<std::mutex> lock(s_kernel);
+    wait_until(lock, ticks_to_wait, [self] { return self->notify > 0; });
+    uint32_t value = self->notify;
+    if (value)
+        self->notify = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    if (length == 0)
+        return nullptr;
+    return new HostQueue{length, item_size, {}};
+}
+
+void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+static std::vector<uint8_t> queue_item(QueueHandle_t queue, const void* item)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    return item ? std::vector<uint8_t>(bytes, bytes + queue->item_size) : std::vector<uint8_t>(queue->item_size);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+    std::unique_lock<std::mutex> lock(s_kernel);
+    if (!wait_until(lock, ticks_to_wait, [queue] { return queue->items.size() < queue->length; }))
+        return pdFAIL;
+    queue->items.push_back(queue_item(queue, item));
+    s_changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item)
+{
+    std::lock_guard<std::mutex> guard(s_kernel);
+    if (queue->items.size() == queue->length)
+        queue->items.back() = queue_item(queue, item);
+    else
+        queue->items.push_back(queue_item(queue, item));
+    s_changed.notify_all();
+    return pdPASS;
+}
+
+static BaseType_t queue_get(QueueHandle_t queue, void* item, TickType_t ticks_to_wait, bool remove)
+{
+    std::unique_lock<std::mutex> lock(s_kernel);
+    if (!wait_until(lock, ticks_to_wait, [queue] { return !queue->items.empty(); }))
+        return pdFAIL;
+    if (item && queue->item_size)
+        memcpy(item, queue->items.front().data(), queue->item_size);
+    if (remove)
+    {
+        queue->items.pop_front();
+        s_changed.notify_all();
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    return queue_get(queue, item, ticks_to_wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    return queue_get(queue, item, ticks_to_wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> guard(s_kernel);
+    return (UBaseType_t)queue->items.size();
+}
+
+EventGroupHandle_t xEventGroupCreate() { return new HostEventGroup; }
+
+void vEventGroupDelete(EventGroupHandle_t group) { delete group; }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    std::lock_guard<std::mutex> guard(s_kernel);
+    group->bits |= bits;
+    s_changed.notify_all();
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    std::lock_guard<std::mutex> guard(s_kernel);
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    std::lock_guard<std::mutex> guard(s_kernel);
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,
+                                EventBits_t bits,
+                                BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all,
+                                TickType_t ticks_to_wait)
+{
+    std::unique_lock<std::mutex> lock(s_kernel);
+    auto ready = [&] { return wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0; };
+    bool done = wait_until(lock, ticks_to_wait, ready);
+    EventBits_t value = group->bits;
+    if (done && clear_on_exit)
+        group->bits &= ~bits;
+    return value;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file host_platform.h
+ * @author d4rkmen
+ * @brief Controls of the host stand-ins that the ESP-IDF has no counterpart for
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Stop the clock at `us`, esp_timer_get_time() and the tick count hold still
+ *
+ * While frozen, vTaskDelay() and the timeouts of the blocking calls advance
+ * the clock instead of sleeping, so one task renders the same frames on
+ * every run and machine. Meant for a single task, others aren't woken by it.
+ */
+void host_clock_freeze(int64_t us);
+void host_clock_advance(int64_t us);
+// Back to the steady clock, continuing from the frozen time
+void host_clock_run();
+bool host_clock_frozen();
+
+/**
+ * @brief What gpio_get_level() returns for `pin`, given the levels set on the outputs
+ *
+ * Without one, inputs read high, like with the pull-ups of the key matrix.
+ */
+typedef int (*HostGpioInput)(int pin, const uint8_t* levels, void* user);
+void host_gpio_set_input(HostGpioInput input, void* user);
@@ -0,0 +1,118 @@
+/**
+ * @file m5unified_host.cpp
+ * @author d4rkmen
+ * @brief Host stand-in for the M5Unified mic stream
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "M5Unified.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "freertos/task.h"
+
+namespace m5
+{
+    bool Mic_Class::begin()
+    {
+        if (_running)
+            return true;
+        _running = true;
+        _thread = std::thread(&Mic_Class::_produce, this);
+        return true;
+    }
+
+    void Mic_Class::end()
+    {
+        _running = false;
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    bool Mic_Class::beginStream(size_t block_len, size_t block_count, TaskHandle_t notify_task)
+    {
+        if (block_len == 0)
+            return false;
+        block_count = std::max<size_t>(block_count, 2);
+        endStream();
+        // The producer may be running without a stream, it polls the ring
+        end();
+        _stream_buf.assign(block_len * block_count, 0);
+        _stream_seq.assign(block_count, 0);
+        _stream_block_len = block_len;
+        _stream_block_count = block_count;
+        _stream_produced = 0;
+        _stream_dropped = 0;
+        _stream_head = 0;
+        _stream_tail = 0;
+        _stream_notify = notify_task;
+        return begin();
+    }
+
+    void Mic_Class::endStream()
+    {
+        if (_stream_buf.empty())
+            return;
+        end();
+        _stream_buf.clear();
+        _stream_seq.clear();
+        _stream_notify = nullptr;
+    }
+
+    const int16_t* Mic_Class::getStreamBlock(uint32_t* seq) const
+    {
+        size_t tail = _stream_tail.load(std::memory_order_relaxed);
+        if (_stream_buf.empty() || tail == _stream_head.load(std::memory_order_acquire))
+            return nullptr;
+        size_t index = tail % _stream_block_count;
+        if (seq)
+            *seq = _stream_seq[index];
+        return &_stream_buf[index * _stream_block_len];
+    }
+
+    void Mic_Class::releaseStreamBlock()
+    {
+        size_t tail = _stream_tail.load(std::memory_order_relaxed);
+        if (tail == _stream_head.load(std::memory_order_acquire))
+            return;
+        _stream_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    void Mic_Class::_produce()
+    {
+        std::vector<int16_t> block;
+        auto next = std::chrono::steady_clock::now();
+        while (_running)
+        {
+            if (_stream_buf.empty())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            block.assign(_stream_block_len, 0);
+            if (_source)
+                _source(block.data(), block.size(), _cfg.sample_rate);
+            next += std::chrono::microseconds((int64_t)_stream_block_len * 1000000 / _cfg.sample_rate);
+            std::this_thread::sleep_until(next);
+
+            size_t head = _stream_head.load(std::memory_order_relaxed);
+            if (head - _stream_tail.load(std::memory_order_acquire) >= _stream_block_count)
+            {
+                // The reader is behind, this block is lost
+                _stream_dropped++;
+                _stream_produced++;
+                continue;
+            }
+            size_t index = head % _stream_block_count;
+            std::copy(block.begin(), block.end(), _stream_buf.begin() + index * _stream_block_len);
+            _stream_seq[index] = _stream_produced++;
+            _stream_head.store(head + 1, std::memory_order_release);
+            if (_stream_notify)
+                xTaskNotifyGive(_stream_notify);
+        }
+    }
+} // namespace m5
@@ -0,0 +1,192 @@
+/**
+ * @file signal_gen.cpp
+ * @author d4rkmen
+ * @brief Synthetic plucked-string test signals for the host benchmarks
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "signal_gen.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <random>
+
+#include "defines.h"
+
+static const char* note_labels[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+const char* signal_kind_name(SignalKind kind)
+{
+    switch (kind)
+    {
+    case SIGNAL_KARPLUS_STRONG:
+        return "ks";
+    case SIGNAL_INHARMONIC:
+        return "inharmonic";
+    case SIGNAL_NOISY:
+        return "noisy";
+    case SIGNAL_SWEEP:
+        return "sweep";
+    case SIGNAL_REPLUCK:
+        return "repluck";
+    default:
+        return "unknown";
+    }
+}
+
+float TestSignal::expected_frequency(uint64_t index) const
+{
+    if (sweep_cents == 0 || samples.size() <= onset)
+        return frequency;
+    double pos = (double)(std::max<uint64_t>(index, onset) - onset) / (samples.size() - onset);
+    return frequency * std::pow(2.0, sweep_cents * std::min(pos, 1.0) / 1200.0);
+}
+
+// Karplus-Strong with a first order allpass for the fractional part of the
+// loop delay, so the string is in tune to a small fraction of a cent.
+static void karplus_strong(std::vector<float>& out, float frequency, float sample_rate, std::mt19937& rng)
+{
+    // The two point average in the loop adds half a sample of delay
+    double period = sample_rate / frequency - 0.5;
+    size_t n = (size_t)std::floor(period - 0.1);
+    double frac = period - n;
+    float c = (float)((1.0 - frac) / (1.0 + frac));
+
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> line(n);
+    for (auto& v : line)
+        v = dist(rng);
+
+    // Decay so that low strings ring for ~2 s and high ones a bit shorter
+    float loss = 0.996f + 0.0035f * std::min(1.0f, 82.0f / frequency);
+    float prev = 0, ap_x = 0, ap_y = 0;
+    size_t pos = 0;
+    for (auto& s : out)
+    {
+        float x = line[pos];
+        float avg = 0.5f * (x + prev) * loss;
+        prev = x;
+        // allpass: y[n] = c * x[n] + x[n-1] - c * y[n-1]
+        float y = c * avg + ap_x - c * ap_y;
+        ap_x = avg;
+        ap_y = y;
+        line[pos] = y;
+        s = x;
+        pos = (pos + 1) % n;
+    }
+}
+
+static void partials(std::vector<float>& out, float frequency, float sample_rate, float inharmonicity, float sweep_cents)
+{
+    int count = std::max(1, std::min(12, (int)(sample_rate / 2 / frequency) - 1));
+    std::vector<double> phase(count, 0.0);
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        double t = (double)i / sample_rate;
+        double glide = std::pow(2.0, sweep_cents * i / out.size() / 1200.0);
+        double env = std::exp(-t * 1.5);
+        double v = 0;
+        for (int k = 1; k <= count; k++)
+        {
+            double fk = frequency * glide * k * std::sqrt(1.0 + inharmonicity * k * k);
+            if (fk >= sample_rate / 2)
+                break;
+            phase[k - 1] += 2 * M_PI * fk / sample_rate;
+            v += std::sin(phase[k - 1]) * std::exp(-t * 0.5 * k) / k;
+        }
+        out[i] = (float)(v * env);
+    }
+}
+
+TestSignal make_signal(SignalKind kind, float frequency, const SignalParams& params)
+{
+    TestSignal signal;
+    signal.sample_rate = params.sample_rate;
+    signal.onset = (size_t)(params.lead_in_s * params.sample_rate);
+    signal.frequency = frequency;
+    signal.name = std::string(signal_kind_name(kind)) + "_" + note_label(frequency);
+
+    std::mt19937 rng(params.seed);
+    std::vector<float> note((size_t)(params.duration_s * params.sample_rate));
+    // Everything before the measured note, after the lead-in
+    std::vector<float> before;
+    switch (kind)
+    {
+    case SIGNAL_INHARMONIC:
+        partials(note, frequency, params.sample_rate, params.inharmonicity, 0);
+        // The fundamental itself is stretched too
+        signal.frequency = frequency * std::sqrt(1.0f + params.inharmonicity);
+        break;
+    case SIGNAL_SWEEP:
+        signal.sweep_cents = params.sweep_cents;
+        signal.frequency = frequency * std::pow(2.0f, -params.sweep_cents / 2 / 1200.0f);
+        partials(note, signal.frequency, params.sample_rate, 0, params.sweep_cents);
+        break;
+    case SIGNAL_REPLUCK:
+        before.resize((size_t)(params.repluck_s * params.sample_rate));
+        karplus_strong(before, frequency * std::pow(2.0f, params.repluck_cents / 1200.0f), params.sample_rate, rng);
+        karplus_strong(note, frequency, params.sample_rate, rng);
+        break;
+    case SIGNAL_NOISY:
+    case SIGNAL_KARPLUS_STRONG:
+    default:
+        karplus_strong(note, frequency, params.sample_rate, rng);
+        break;
+    }
+
+    float peak = 1e-9f;
+    for (float v : note)
+        peak = std::max(peak, std::fabs(v));
+    float gain = params.amplitude / peak;
+
+    std::normal_distribution<float> noise(0.0f, params.amplitude * std::pow(10.0f, -params.snr_db / 20.0f));
+    size_t start = signal.onset;
+    signal.onset += before.size();
+    note.insert(note.begin(), before.begin(), before.end());
+    signal.samples.assign(start + note.size(), 0);
+    for (size_t i = 0; i < note.size(); i++)
+    {
+        float v = note[i] * gain;
+        if (kind == SIGNAL_NOISY)
+            v += noise(rng);
+        signal.samples[start + i] = (int16_t)std::max(-32767.0f, std::min(32767.0f, std::round(v)));
+    }
+    return signal;
+}
+
+std::string note_label(float frequency)
+{
+    int midi = (int)std::lround(12.0 * std::log2(frequency / A4_FREQ) + 69.0);
+    return std::string(note_labels[(midi % 12 + 12) % 12]) + std::to_string(midi / 12 - 1);
+}
+
+float parse_note_label(const std::string& text)
+{
+    static const int semitones[] = {9, 11, 0, 2, 4, 5, 7}; // A..G
+    if (text.empty())
+        return 0;
+    char letter = (char)std::toupper((unsigned char)text[0]);
+    if (letter < 'A' || letter > 'G')
+        return 0;
+    int note = semitones[letter - 'A'];
+    size_t pos = 1;
+    if (pos < text.size() && (text[pos] == '#' || text[pos] == 's'))
+    {
+        note++;
+        pos++;
+    }
+    else if (pos < text.size() && text[pos] == 'b')
+    {
+        note--;
+        pos++;
+    }
+    if (pos >= text.size() || !std::isdigit((unsigned char)text[pos]))
+        return 0;
+    int octave = text[pos] - '0';
+    int midi = (octave + 1) * 12 + note;
+    return (float)(A4_FREQ * std::pow(2.0, (midi - 69) / 12.0));
+}
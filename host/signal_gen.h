@@ -0,0 +1,63 @@
+/**
+ * @file signal_gen.h
+ * @author d4rkmen
+ * @brief Synthetic plucked-string test signals for the host benchmarks
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef enum
+{
+    SIGNAL_KARPLUS_STRONG = 0, // Plucked string, harmonic
+    SIGNAL_INHARMONIC,         // Stiff string, partials stretched by the inharmonicity coefficient
+    SIGNAL_NOISY,              // Karplus-Strong plus white noise
+    SIGNAL_SWEEP,              // Harmonic tone gliding across +/- sweep_cents
+    SIGNAL_REPLUCK,            // Karplus-Strong repluck_cents off, plucked again in tune while it still rings
+    SIGNAL_COUNT
+} SignalKind;
+
+struct TestSignal
+{
+    std::string name;
+    std::vector<int16_t> samples;
+    uint32_t sample_rate = 0;
+    size_t onset = 0;         // First sample of the note, silence or the pluck before it ahead of it
+    float frequency = 0;      // Frequency of the fundamental at the onset
+    float sweep_cents = 0;    // Total glide over the note, 0 for a steady note
+
+    /// @brief The frequency the tuner should report at sample `index`
+    float expected_frequency(uint64_t index) const;
+};
+
+struct SignalParams
+{
+    uint32_t sample_rate = 16000;
+    float lead_in_s = 0.1f;       // Silence before the pluck
+    float duration_s = 2.0f;      // Length of the note
+    float amplitude = 12000;      // Peak amplitude in raw counts
+    float inharmonicity = 1e-4f;  // B coefficient for SIGNAL_INHARMONIC
+    float snr_db = 20;            // For SIGNAL_NOISY
+    float sweep_cents = 50;       // For SIGNAL_SWEEP, glides from -sweep/2 to +sweep/2
+    float repluck_s = 1.0f;       // For SIGNAL_REPLUCK, length of the detuned pluck
+    float repluck_cents = -25;    // and how far off it is
+    uint32_t seed = 1;
+};
+
+const char* signal_kind_name(SignalKind kind);
+
+TestSignal make_signal(SignalKind kind, float frequency, const SignalParams& params);
+
+/// @brief Name like "E2" or "C#4" for the equal tempered note closest to `frequency`
+std::string note_label(float frequency);
+
+/// @brief Parse a note name ("E2", "A#3", "Bb1") at the start of `text`.
+/// @return frequency in Hz, or 0 if `text` doesn't start with a note name
+float parse_note_label(const std::string& text);
@@ -0,0 +1,128 @@
+/**
+ * @file strobe_bench.cpp
+ * @author d4rkmen
+ * @brief Resolution of the strobe demodulator on detuned plucked strings
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "pitch/pitch_profile.h"
+#include "pitch/strobe_demodulator.h"
+#include "cycle_counter.h"
+#include "signal_gen.h"
+
+static const float Targets[] = {82.41f, 110.00f, 146.83f, 196.00f, 246.94f, 329.63f, 440.00f, 659.26f};
+static const float Detunes[] = {0.0f, 0.1f, -0.3f, 1.0f, -2.5f, 10.0f, -25.0f};
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -m, --mode NAME  capture profile: auto, guitar, ukulele or violin (default guitar)\n"
+            "  -k, --kind NAME  ks, inharmonic or noisy (default ks)\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    TunerMode mode = MODE_GUITAR;
+    SignalKind kind = SIGNAL_KARPLUS_STRONG;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if ((!strcmp(arg, "-m") || !strcmp(arg, "--mode")) && has_value)
+        {
+            const char* name = argv[++i];
+            int m = 0;
+            while (m < MODE_STRUM && strcmp(pitch_profile_for_mode((TunerMode)m).name, name))
+                m++;
+            if (m == MODE_STRUM)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            mode = (TunerMode)m;
+        }
+        else if ((!strcmp(arg, "-k") || !strcmp(arg, "--kind")) && has_value)
+        {
+            const char* name = argv[++i];
+            int k = 0;
+            while (k < SIGNAL_COUNT && strcmp(signal_kind_name((SignalKind)k), name))
+                k++;
+            if (k == SIGNAL_COUNT || k == SIGNAL_SWEEP)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            kind = (SignalKind)k;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const PitchProfile& profile = pitch_profile_for_mode(mode);
+    SignalParams params;
+    params.sample_rate = profile.sample_rate;
+    params.amplitude = 8000;
+    params.duration_s = 3.0f;
+
+    printf("%s, %u Hz, hop %zu, error of the reading 0.33 s after the pluck\n\n",
+           signal_kind_name(kind),
+           profile.sample_rate,
+           profile.hop_size);
+    printf("%-6s", "note");
+    for (float d : Detunes)
+        printf(" %+8.1fc", d);
+    printf("\n");
+
+    uint64_t cycles = 0;
+    size_t blocks = 0;
+    for (float target : Targets)
+    {
+        if (target < cycfi::q::as_double(profile.low_fs) || target > cycfi::q::as_double(profile.high_fs))
+            continue;
+        printf("%-6s", note_label(target).c_str());
+        for (float detune : Detunes)
+        {
+            TestSignal signal = make_signal(kind, target * std::pow(2.0f, detune / 1200.0f), params);
+            StrobeDemodulator strobe(profile.sample_rate);
+            strobe.set_reference(target);
+
+            // Read a third of a second into the note, the high strings are still ringing
+            size_t read_at = signal.onset + profile.sample_rate / 3;
+            float measured = NAN;
+            for (size_t pos = signal.onset; pos + profile.hop_size <= signal.samples.size(); pos += profile.hop_size)
+            {
+                StrobeInfo info;
+                uint64_t start = cycle_count();
+                bool valid = strobe.process(&signal.samples[pos], profile.hop_size, info);
+                cycles += cycle_count() - start;
+                blocks++;
+                if (valid && pos >= read_at)
+                {
+                    measured = 1200.0f * std::log2((target + info.drift) / target);
+                    break;
+                }
+            }
+            printf(" %+9.3f", measured - detune);
+        }
+        printf("\n");
+    }
+    printf("\ncents error (measured - true), %.0f %s per block\n",
+           blocks ? (double)cycles / blocks : 0.0,
+           CYCLE_COUNTER_UNIT);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file strum_bench.cpp
+ * @author d4rkmen
+ * @brief Accuracy and cost of the strum-check multi-pitch estimator on synthetic strums
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "pitch/pitch_profile.h"
+#include "pitch/strum_analyzer.h"
+#include "cycle_counter.h"
+#include "signal_gen.h"
+
+// Same as main.cpp, the host tools don't link the GUI
+static const float StandardTuning[STRUM_STRINGS] = {82.41f, 110.00f, 146.83f, 196.00f, 246.94f, 329.63f};
+
+// Time between two strings of a downstroke
+#define STRUM_STROKE_S 0.015f
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n, --strums N   number of random strums (default 50)\n"
+            "  -d, --detune C   strings are detuned by up to +/-C cents (default 30)\n"
+            "  -k, --kind NAME  ks, inharmonic or noisy (default ks)\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    int strums = 50;
+    float detune = 30;
+    SignalKind kind = SIGNAL_KARPLUS_STRONG;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if ((!strcmp(arg, "-n") || !strcmp(arg, "--strums")) && has_value)
+            strums = std::max(1, atoi(argv[++i]));
+        else if ((!strcmp(arg, "-d") || !strcmp(arg, "--detune")) && has_value)
+            detune = (float)atof(argv[++i]);
+        else if ((!strcmp(arg, "-k") || !strcmp(arg, "--kind")) && has_value)
+        {
+            const char* name = argv[++i];
+            int k = 0;
+            while (k < SIGNAL_COUNT && strcmp(signal_kind_name((SignalKind)k), name))
+                k++;
+            if (k == SIGNAL_COUNT || k == SIGNAL_SWEEP)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            kind = (SignalKind)k;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const PitchProfile& profile = pitch_profile_for_mode(MODE_STRUM);
+    const size_t analysis_hops = (size_t)std::ceil((double)profile.sample_rate / STRUM_ANALYSIS_RATE / profile.hop_size);
+
+    SignalParams params;
+    params.sample_rate = profile.sample_rate;
+    params.amplitude = 4000;
+    params.duration_s = 1.5f;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> offset(-detune, detune);
+
+    std::vector<double> abs_cents[STRUM_STRINGS];
+    std::vector<double> shared_cents[STRUM_STRINGS];
+    size_t missed[STRUM_STRINGS] = {};
+    uint64_t cycles = 0;
+    size_t analyses = 0;
+
+    for (int n = 0; n < strums; n++)
+    {
+        float truth[STRUM_STRINGS];
+        std::vector<int32_t> mix;
+        size_t last_onset = 0;
+        for (int s = 0; s < STRUM_STRINGS; s++)
+        {
+            truth[s] = StandardTuning[s] * std::pow(2.0f, offset(rng) / 1200.0f);
+            params.seed = n * STRUM_STRINGS + s + 1;
+            TestSignal note = make_signal(kind, truth[s], params);
+            size_t shift = (size_t)(s * STRUM_STROKE_S * profile.sample_rate);
+            last_onset = note.onset + shift;
+            if (mix.size() < note.samples.size() + shift)
+                mix.resize(note.samples.size() + shift, 0);
+            for (size_t i = 0; i < note.samples.size(); i++)
+                mix[i + shift] += note.samples[i];
+        }
+        std::vector<int16_t> samples(mix.size());
+        for (size_t i = 0; i < mix.size(); i++)
+            samples[i] = (int16_t)std::max(-32768, std::min(32767, mix[i]));
+
+        StrumAnalyzer analyzer(profile.sample_rate, StandardTuning, STRUM_STRINGS);
+        size_t hops = 0;
+        for (size_t pos = 0; pos + profile.hop_size <= samples.size(); pos += profile.hop_size)
+        {
+            analyzer.push(&samples[pos], profile.hop_size);
+            if (++hops < analysis_hops || !analyzer.ready())
+                continue;
+            hops = 0;
+
+            StrumInfo info;
+            uint64_t start = cycle_count();
+            analyzer.analyze(info);
+            cycles += cycle_count() - start;
+            analyses++;
+
+            // Score the windows that hold every string
+            if (pos + profile.hop_size < last_onset + STRUM_FFT_SIZE)
+                continue;
+            for (int s = 0; s < STRUM_STRINGS; s++)
+            {
+                if (info.frequency[s] <= 0)
+                    missed[s]++;
+                else
+                    (info.shared[s] ? shared_cents : abs_cents)[s].push_back(
+                        std::fabs(1200.0 * std::log2(info.frequency[s] / truth[s])));
+            }
+        }
+    }
+
+    printf("%s strums, detune +/-%.0f cents, %u Hz, FFT %d, one analysis every %zu hops of %zu\n\n",
+           signal_kind_name(kind),
+           detune,
+           profile.sample_rate,
+           STRUM_FFT_SIZE,
+           analysis_hops,
+           profile.hop_size);
+    // Shared readings are shown as such instead of a number, they are
+    // scored apart from the rest
+    printf("%-8s %10s %10s %10s %8s %10s %8s\n", "string", "mean |c|", "p90 |c|", "max |c|", "shared", "max |c|", "missed");
+    for (int s = 0; s < STRUM_STRINGS; s++)
+    {
+        std::vector<double>& v = abs_cents[s];
+        std::vector<double>& shared = shared_cents[s];
+        std::sort(v.begin(), v.end());
+        std::sort(shared.begin(), shared.end());
+        double mean = 0;
+        for (double c : v)
+            mean += c;
+        mean = v.empty() ? NAN : mean / v.size();
+        printf("%-8s %10.2f %10.2f %10.2f %7.0f%% %10.2f %8zu\n",
+               note_label(StandardTuning[s]).c_str(),
+               mean,
+               v.empty() ? NAN : v[v.size() * 9 / 10],
+               v.empty() ? NAN : v.back(),
+               v.size() + shared.size() ? 100.0 * shared.size() / (v.size() + shared.size()) : 0.0,
+               shared.empty() ? NAN : shared.back(),
+               missed[s]);
+    }
+    printf("\n%.0f %s per analysis\n", analyses ? (double)cycles / analyses : 0.0, CYCLE_COUNTER_UNIT);
+    return 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file tuner_host.cpp
+ * @author d4rkmen
+ * @brief The tuner's tasks on the headless HAL, a recording for the mic and a key script
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "hal_host.h"
+#include "keyboard/keyboard.h"
+#include "pitch_detector_task.h"
+#include "tuner_gui_task.h"
+#include "wav_reader.h"
+
+// Key presses are held this long unless the script says otherwise
+#define TUNER_HOST_KEY_MS 100
+
+extern void pitch_detector_task(void* pvParameter);
+TaskHandle_t detectorTaskHandle;
+TaskHandle_t guiTaskHandle;
+QueueHandle_t frequencyQueue;
+QueueHandle_t targetQueue;
+QueueHandle_t strumQueue;
+QueueHandle_t strobeQueue;
+QueueHandle_t spectrumQueue;
+PitchHistory pitchHistory;
+
+typedef struct
+{
+    uint32_t time_ms;
+    int key;         // KEY_NUM_*, 0 for a screenshot
+    bool press;      // Otherwise a release
+    std::string png; // For screenshots
+} Event;
+
+typedef struct
+{
+    const char* name;
+    int key;
+} KeyName;
+
+static const KeyName Keys[] = {{"left", KEY_NUM_LEFT},
+                               {"right", KEY_NUM_RIGHT},
+                               {"up", KEY_NUM_UP},
+                               {"down", KEY_NUM_DOWN},
+                               {"s", KEY_NUM_S},
+                               {"f", KEY_NUM_F},
+                               {"h", KEY_NUM_H},
+                               {"p", KEY_NUM_P}};
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] [file]\n"
+            "  -k, --key MS:NAME[:HOLD]  press left, right, up, down, s, f, h or p at MS for HOLD ms (default %d)\n"
+            "  -s, --shot MS:FILE.png    save the display at MS\n"
+            "  -d, --duration MS         stop after MS (default the recording plus one second)\n"
+            "  -r, --rate N              sample rate of .raw/.pcm input (default %d)\n"
+            "  -l, --loop                play the recording over and over\n"
+            "  -v, --verbose             debug logs\n"
+            "\n"
+            "Plays the file into the mic in real time, silence without one.\n",
+            name,
+            TUNER_HOST_KEY_MS,
+            TUNER_SAMPLE_RATE);
+}
+
+static bool parse_key(const char* text, std::vector<Event>& events)
+{
+    char name[16];
+    unsigned long time_ms = 0, hold_ms = TUNER_HOST_KEY_MS;
+    if (sscanf(text, "%lu:%15[a-z]:%lu", &time_ms, name, &hold_ms) < 2)
+        return false;
+    for (const KeyName& key : Keys)
+    {
+        if (!strcmp(key.name, name))
+        {
+            events.push_back({(uint32_t)time_ms, key.key, true, ""});
+            events.push_back({(uint32_t)(time_ms + hold_ms), key.key, false, ""});
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_shot(const char* text, std::vector<Event>& events)
+{
+    const char* colon = strchr(text, ':');
+    if (colon == nullptr || colon[1] == 0)
+        return false;
+    events.push_back({(uint32_t)strtoul(text, nullptr, 10), 0, false, colon + 1});
+    return true;
+}
+
+static bool save_screen(HAL::HalHost& hal, const std::string& path)
+{
+    LGFX_Sprite screen;
+    if (!hal.screenshot(&screen))
+        return false;
+    size_t len = 0;
+    void* png = screen.createPng(&len, 0, 0, screen.width(), screen.height());
+    if (png == nullptr)
+        return false;
+    std::ofstream file(path, std::ios::binary);
+    file.write(static_cast<const char*>(png), len);
+    free(png);
+    return (bool)file;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<Event> events;
+    uint32_t raw_rate = TUNER_SAMPLE_RATE;
+    long duration_ms = -1;
+    bool loop = false;
+    bool verbose = false;
+    std::string path;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        bool ok = true;
+        if ((!strcmp(arg, "-k") || !strcmp(arg, "--key")) && has_value)
+            ok = parse_key(argv[++i], events);
+        else if ((!strcmp(arg, "-s") || !strcmp(arg, "--shot")) && has_value)
+            ok = parse_shot(argv[++i], events);
+        else if ((!strcmp(arg, "-d") || !strcmp(arg, "--duration")) && has_value)
+            duration_ms = strtol(argv[++i], nullptr, 10);
+        else if ((!strcmp(arg, "-r") || !strcmp(arg, "--rate")) && has_value)
+            raw_rate = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(arg, "-l") || !strcmp(arg, "--loop"))
+            loop = true;
+        else if (!strcmp(arg, "-v") || !strcmp(arg, "--verbose"))
+            verbose = true;
+        else if (arg[0] == '-' || !path.empty())
+            ok = false;
+        else
+            path = arg;
+        if (!ok)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    esp_log_level_set("*", verbose ? ESP_LOG_DEBUG : ESP_LOG_INFO);
+
+    AudioClip clip;
+    if (!path.empty())
+    {
+        std::string error;
+        if (!load_audio(path, raw_rate, clip, error))
+        {
+            fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+            return 1;
+        }
+    }
+    if (duration_ms < 0)
+        duration_ms = clip.sample_rate ? (long)(clip.samples.size() * 1000 / clip.sample_rate) + 1000 : 5000;
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.time_ms < b.time_ms; });
+
+    HAL::HalHost hal;
+    hal.init();
+    // The recording at whatever rate the capture profile asks for, linear interpolation is plenty here
+    double position = 0;
+    hal.set_mic_source(
+        [&clip, &position, loop](int16_t* samples, size_t count, uint32_t sample_rate)
+        {
+            if (clip.samples.empty())
+                return;
+            double step = (double)clip.sample_rate / sample_rate;
+            const size_t length = clip.samples.size();
+            for (size_t i = 0; i < count; i++, position += step)
+            {
+                if (loop && position >= length)
+                    position -= length;
+                size_t index = (size_t)position;
+                if (index + 1 >= length)
+                    break;
+                float frac = (float)(position - index);
+                samples[i] = (int16_t)(clip.samples[index] + frac * (clip.samples[index + 1] - clip.samples[index]));
+            }
+        });
+
+    // The same queues and tasks as app_main
+    frequencyQueue = xQueueCreate(FREQUENCY_QUEUE_LENGTH, sizeof(FrequencyInfo));
+    targetQueue = xQueueCreate(TARGET_QUEUE_LENGTH, sizeof(TunerTarget));
+    strumQueue = xQueueCreate(STRUM_QUEUE_LENGTH, sizeof(StrumInfo));
+    strobeQueue = xQueueCreate(STROBE_QUEUE_LENGTH, sizeof(StrobeInfo));
+    spectrumQueue = xQueueCreate(SPECTRUM_QUEUE_LENGTH, sizeof(SpectrumLine));
+    xTaskCreatePinnedToCore(pitch_detector_task, "pitch_detector", PITCH_DETECTOR_STACK_SIZE, &hal, 10, &detectorTaskHandle, 1);
+    xTaskCreatePinnedToCore(tuner_gui_task, "tuner_gui", 4096, &hal, 5, &guiTaskHandle, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    int failed = 0;
+    for (const Event& event : events)
+    {
+        if (event.time_ms > duration_ms)
+            break;
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(event.time_ms));
+        if (event.key && event.press)
+            hal.press_key(event.key);
+        else if (event.key)
+            hal.release_key(event.key);
+        else if (save_screen(hal, event.png))
+            printf("%u ms: %s\n", event.time_ms, event.png.c_str());
+        else
+        {
+            fprintf(stderr, "Failed to save %s\n", event.png.c_str());
+            failed++;
+        }
+    }
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(duration_ms));
+
+    // The tasks never return, they go down with the process
+    fflush(stdout);
+    _Exit(failed ? 1 : 0);
+}
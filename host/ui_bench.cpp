@@ -0,0 +1,549 @@
+/**
+ * @file ui_bench.cpp
+ * @author d4rkmen
+ * @brief TunerUI render times and golden image checks on the headless HAL
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "app/ui.h"
+#include "cycle_counter.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "hal_host.h"
+#include "host_platform.h"
+#include "pitch/spectrum_window.h"
+
+// Same pacing as the GUI task while something animates
+#define UI_BENCH_FRAME_MS 14
+// The clock starts here, not at 0 where "long ago" would underflow
+#define UI_BENCH_CLOCK_START_US 10000000
+
+using HAL::HalHost;
+
+typedef struct
+{
+    const char* name;
+    std::function<void(TunerUI& ui)> play; // Brings the UI into the state to compare
+} Scene;
+
+typedef struct
+{
+    const char* name;
+    int frames;
+    std::function<void(TunerUI& ui, int frame)> step; // Called before every frame
+} Workload;
+
+typedef struct
+{
+    std::vector<uint64_t> render;
+    std::vector<uint64_t> flush;
+    uint64_t damaged = 0; // Pixels sent
+} FrameTimes;
+
+static HalHost* s_hal;
+
+/// @brief One frame the way tuner_gui_task draws it, then the clock moves on by a frame
+static void frame(TunerUI& ui, FrameTimes* times = nullptr)
+{
+    uint64_t start = cycle_count();
+    bool full = ui.render();
+    bool strobe = !full && ui.render_strobe();
+    uint64_t rendered = cycle_count();
+    uint64_t damaged = 0;
+    if (full)
+    {
+        const UTILS::DirtyRects& damage = ui.damage();
+        for (size_t i = 0; i < damage.count(); i++)
+        {
+            s_hal->canvas_damage(damage[i].x, damage[i].y, damage[i].w, damage[i].h);
+            damaged += (uint64_t)damage[i].w * damage[i].h;
+        }
+        s_hal->canvas_flush();
+    }
+    else if (strobe)
+    {
+        s_hal->canvas_update(0, STROBE_BAND_Y, s_hal->canvas()->width(), STROBE_BAND_H);
+        damaged = (uint64_t)s_hal->canvas()->width() * STROBE_BAND_H;
+    }
+    uint64_t flushed = cycle_count();
+    if (times && (full || strobe))
+    {
+        times->render.push_back(rendered - start);
+        times->flush.push_back(flushed - rendered);
+        times->damaged += damaged;
+    }
+    host_clock_advance(UI_BENCH_FRAME_MS * 1000);
+}
+
+static void frames(TunerUI& ui, int count)
+{
+    for (int i = 0; i < count; i++)
+        frame(ui);
+}
+
+static void strum_info(StrumInfo& info, const float* cents)
+{
+    for (int i = 0; i < STRUM_STRINGS; i++)
+    {
+        info.frequency[i] = std::isnan(cents[i]) ? -1 : GuitarFrequencies[i] * std::exp2(cents[i] / 1200);
+        info.cents[i] = std::isnan(cents[i]) ? 0 : cents[i];
+        info.level[i] = -6.0f * i;
+        info.shared[i] = false;
+    }
+}
+
+static SpectrumWindow s_spectrum(TUNER_SAMPLE_RATE, SPECTRUM_FFT_SIZE);
+static SpectrumBands s_bands(TUNER_SAMPLE_RATE, SPECTRUM_FFT_SIZE);
+
+/// @brief Row `row` of the spectrum view the way the detector makes it: mains hum, plus
+/// a note with six harmonics at `level` (0..1)
+static void spectrum_line(SpectrumLine& line, int row, float pitch, float level)
+{
+    const double pi = 3.14159265358979323846;
+    int16_t samples[TUNER_SAMPLE_RATE / SPECTRUM_LINE_RATE];
+    const size_t count = sizeof(samples) / sizeof(samples[0]);
+    for (size_t i = 0; i < count; i++)
+    {
+        double t = (double)(row * count + i) / TUNER_SAMPLE_RATE;
+        double v = 200 * sin(2 * pi * 50 * t);
+        for (int h = 1; h <= 6; h++)
+            v += level * 8000 / h * sin(2 * pi * h * pitch * t);
+        samples[i] = (int16_t)v;
+    }
+    s_spectrum.push(samples, count);
+    memset(line.level, 0, sizeof(line.level));
+    if (s_spectrum.ready())
+        s_bands.reduce(s_spectrum.power(), line.level);
+    line.pitch = level > 0 ? pitch : -1;
+}
+
+/// @brief A detection `ms` after a pluck: it settles from flat, then vibrato sets in
+static PitchSample pitch_sample(int ms)
+{
+    const double pi = 3.14159265358979323846;
+    float cents = -35.0f * std::exp(-ms / 250.0f);
+    if (ms > 1500)
+        cents += 8.0f * std::sin(2 * pi * 5.5 * (ms - 1500) / 1000.0);
+    PitchSample sample;
+    sample.time_us = esp_timer_get_time();
+    sample.frequency = 110.0f * std::exp2(cents / 1200);
+    sample.cents = cents;
+    sample.confidence = ms < 50 ? 0.6f : 0.95f;
+    sample.amplitude = 0.5f;
+    return sample;
+}
+
+// In order, the UI keeps some state from one to the next like it does on the device
+static const Scene Scenes[] = {
+    {"splash_start", [](TunerUI& ui) { frames(ui, 1); }},
+    {"splash_logo", [](TunerUI& ui) { frames(ui, 60); }},
+    {"guitar_idle",
+     [](TunerUI& ui)
+     {
+         ui.end_splash();
+         ui.update_mode(MODE_GUITAR);
+         ui.update_string(5);
+         ui.update_freq(-1, "E", 4, 329.63f);
+         frames(ui, 200);
+     }},
+    {"guitar_e4_flat",
+     [](TunerUI& ui)
+     {
+         ui.update_freq(325.0f, "E", 4, 329.63f);
+         frames(ui, 2);
+     }},
+    {"guitar_e4_in_tune",
+     [](TunerUI& ui)
+     {
+         ui.update_freq(329.7f, "E", 4, 329.63f);
+         frames(ui, 2);
+     }},
+    {"guitar_a2_sharp",
+     [](TunerUI& ui)
+     {
+         ui.update_string(1);
+         ui.update_freq(112.5f, "A", 2, 110.0f);
+         frames(ui, 2);
+     }},
+    {"ukulele_c4",
+     [](TunerUI& ui)
+     {
+         ui.update_mode(MODE_UKULELE);
+         ui.update_string(1);
+         ui.update_freq(258.0f, "C", 4, 261.63f);
+         frames(ui, 2);
+     }},
+    {"auto_a4",
+     [](TunerUI& ui)
+     {
+         ui.update_mode(MODE_AUTO);
+         ui.update_freq(441.0f, "A", 4, 440.0f);
+         frames(ui, 200);
+     }},
+    {"strobe_a4",
+     [](TunerUI& ui)
+     {
+         ui.toggle_strobe();
+         ui.update_strobe({.phase = 0.25f, .drift = 0.5f, .reference = 440.0f, .level = 0.5f});
+         frames(ui, 10);
+     }},
+    {"strum",
+     [](TunerUI& ui)
+     {
+         ui.toggle_strobe();
+         ui.update_mode(MODE_STRUM);
+         const float cents[STRUM_STRINGS] = {-12.0f, 0.4f, 3.0f, NAN, -30.0f, 48.0f};
+         StrumInfo info;
+         strum_info(info, cents);
+         info.shared[STRUM_STRINGS - 1] = true;
+         ui.update_strum(info);
+         frames(ui, 2);
+     }},
+    {"spectrum_a2",
+     [](TunerUI& ui)
+     {
+         ui.update_mode(MODE_AUTO);
+         ui.toggle_spectrum();
+         // Hum only, then A2 plucked and ringing out
+         SpectrumLine line;
+         for (int row = 0; row < 48; row++)
+         {
+             spectrum_line(line, row, 110.0f, row < 16 ? 0.0f : std::exp(-(row - 16) / 16.0f));
+             ui.update_spectrum(line);
+             frames(ui, 4);
+         }
+     }},
+    {"history_vibrato",
+     [](TunerUI& ui)
+     {
+         ui.toggle_history();
+         // A detection per frame, about the detector's rate
+         for (int i = 0; i < 200; i++)
+         {
+             ui.update_history(pitch_sample(i * UI_BENCH_FRAME_MS));
+             frame(ui);
+         }
+     }},
+};
+
+static const Workload Workloads[] = {
+    {"tuner sweep",
+     400,
+     [](TunerUI& ui, int frame)
+     {
+         if (frame == 0)
+         {
+             // The last scene leaves the history graph on
+             ui.toggle_history();
+             ui.update_mode(MODE_GUITAR);
+             ui.update_string(5);
+         }
+         // A slow glide through the target, every frame moves the pitch circle
+         float cents = 60.0f * std::sin(frame * 0.05f);
+         ui.update_freq(329.63f * std::exp2(cents / 1200), "E", 4, 329.63f);
+     }},
+    {"strobe",
+     400,
+     [](TunerUI& ui, int frame)
+     {
+         if (frame == 0)
+         {
+             ui.update_mode(MODE_AUTO);
+             ui.update_freq(440.5f, "A", 4, 440.0f);
+             ui.toggle_strobe();
+         }
+         ui.update_strobe({.phase = std::fmod(frame * 0.03f, 1.0f), .drift = 2.0f, .reference = 440.0f, .level = 0.5f});
+     }},
+    {"strum",
+     400,
+     [](TunerUI& ui, int frame)
+     {
+         if (frame == 0)
+         {
+             ui.toggle_strobe();
+             ui.update_mode(MODE_STRUM);
+         }
+         float cents[STRUM_STRINGS];
+         for (int i = 0; i < STRUM_STRINGS; i++)
+             cents[i] = 40.0f * std::sin(frame * 0.02f + i);
+         StrumInfo info;
+         strum_info(info, cents);
+         ui.update_strum(info);
+     }},
+    {"spectrum",
+     400,
+     [](TunerUI& ui, int frame)
+     {
+         if (frame == 0)
+         {
+             ui.update_mode(MODE_AUTO);
+             ui.toggle_spectrum();
+         }
+         // A row every ~64 ms like SPECTRUM_LINE_RATE, the frames in between draw nothing
+         if (frame % 4 == 0)
+         {
+             SpectrumLine line;
+             float cents = 30.0f * std::sin(frame * 0.01f);
+             spectrum_line(line, frame / 4, 110.0f * std::exp2(cents / 1200), 1.0f);
+             ui.update_spectrum(line);
+         }
+     }},
+    {"history",
+     400,
+     [](TunerUI& ui, int frame)
+     {
+         if (frame == 0)
+             ui.toggle_history();
+         ui.update_history(pitch_sample(frame * UI_BENCH_FRAME_MS));
+     }},
+};
+
+static bool read_file(const std::string& path, std::vector<uint8_t>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool write_png(LGFX_Sprite& image, const std::string& path)
+{
+    size_t len = 0;
+    void* png = image.createPng(&len, 0, 0, image.width(), image.height());
+    if (png == nullptr)
+        return false;
+    std::ofstream file(path, std::ios::binary);
+    file.write(static_cast<const char*>(png), len);
+    free(png);
+    return (bool)file;
+}
+
+static long pixels_off(LGFX_Sprite& actual, LGFX_Sprite& expected)
+{
+    auto a = static_cast<const uint16_t*>(actual.getBuffer());
+    auto e = static_cast<const uint16_t*>(expected.getBuffer());
+    long diff = 0;
+    for (int32_t i = 0; i < actual.width() * actual.height(); i++)
+        diff += a[i] != e[i];
+    return diff;
+}
+
+/// @brief Pixels of `actual` that differ from the golden image, -1 if there is none to compare with
+static long compare_golden(LGFX_Sprite& actual, const std::string& path)
+{
+    std::vector<uint8_t> png;
+    if (!read_file(path, png))
+        return -1;
+    LGFX_Sprite golden;
+    golden.setColorDepth(lgfx::rgb565_2Byte);
+    if (golden.createSprite(actual.width(), actual.height()) == nullptr)
+        return -1;
+    golden.fillScreen(TFT_MAGENTA);
+    if (!golden.drawPng(png.data(), png.size(), 0, 0))
+        return -1;
+    return pixels_off(actual, golden);
+}
+
+/// @brief Two black sprites to draw the same thing into, the way it is expected and the way it is
+static bool collision_sprites(LGFX_Sprite& expected, LGFX_Sprite& actual)
+{
+    for (LGFX_Sprite* sprite : {&expected, &actual})
+    {
+        sprite->setColorDepth(lgfx::rgb565_2Byte);
+        if (sprite->createSprite(64, 64) == nullptr)
+            return false;
+        sprite->fillScreen(TFT_BLACK);
+    }
+    return true;
+}
+
+/// @brief Pixels that differ when `text` is drawn after `other`, whose hash is the same, instead of into a fresh cache
+static long check_glyph_collision(const char* other, const char* text)
+{
+    LGFX_Sprite expected, actual;
+    if (!collision_sprites(expected, actual))
+        return -1;
+    UTILS::GlyphCache fresh(&expected);
+    fresh.draw(&expected, text, &fonts::efontEN_10, 1, TFT_WHITE, 0, 0);
+    UTILS::GlyphCache used(&actual);
+    used.draw(&actual, other, &fonts::efontEN_10, 1, TFT_WHITE, 0, 0);
+    actual.fillScreen(TFT_BLACK);
+    used.draw(&actual, text, &fonts::efontEN_10, 1, TFT_WHITE, 0, 0);
+    return pixels_off(actual, expected);
+}
+
+/// @brief Like check_glyph_collision() for two triangles, each given as three corners
+static long check_shape_collision(const int32_t* other, const int32_t* triangle)
+{
+    LGFX_Sprite expected, actual;
+    if (!collision_sprites(expected, actual))
+        return -1;
+    const int32_t* t = triangle;
+    UTILS::ShapeCache fresh;
+    fresh.fill_triangle(&expected, t[0], t[1], t[2], t[3], t[4], t[5], TFT_WHITE);
+    UTILS::ShapeCache used;
+    used.fill_triangle(&actual, other[0], other[1], other[2], other[3], other[4], other[5], TFT_WHITE);
+    actual.fillScreen(TFT_BLACK);
+    used.fill_triangle(&actual, t[0], t[1], t[2], t[3], t[4], t[5], TFT_WHITE);
+    return pixels_off(actual, expected);
+}
+
+static uint64_t percentile(std::vector<uint64_t> values, int percent)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * percent / 100)];
+}
+
+static uint64_t mean(const std::vector<uint64_t>& values)
+{
+    uint64_t sum = 0;
+    for (uint64_t v : values)
+        sum += v;
+    return values.empty() ? 0 : sum / values.size();
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -g, --golden DIR  golden images (default host/golden)\n"
+            "  -o, --out DIR     where mismatching frames are written (default .)\n"
+            "  -u, --update      write the golden images instead of comparing\n"
+            "      --no-bench    only the golden images\n"
+            "  -v, --verbose     UI and HAL logs\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    std::string golden_dir = "host/golden";
+    std::string out_dir = ".";
+    bool update = false;
+    bool bench = true;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if ((!strcmp(arg, "-g") || !strcmp(arg, "--golden")) && has_value)
+            golden_dir = argv[++i];
+        else if ((!strcmp(arg, "-o") || !strcmp(arg, "--out")) && has_value)
+            out_dir = argv[++i];
+        else if (!strcmp(arg, "-u") || !strcmp(arg, "--update"))
+            update = true;
+        else if (!strcmp(arg, "--no-bench"))
+            bench = false;
+        else if (!strcmp(arg, "-v") || !strcmp(arg, "--verbose"))
+            verbose = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    esp_log_level_set("*", verbose ? ESP_LOG_INFO : ESP_LOG_WARN);
+
+    // Every run draws the same frames: the UI only sees the frozen clock
+    host_clock_freeze(UI_BENCH_CLOCK_START_US);
+    HalHost hal;
+    hal.init();
+    s_hal = &hal;
+    TunerUI* ui = new TunerUI(&hal);
+
+    LGFX_Sprite screen;
+    int failed = 0;
+    printf("%-20s %s\n", "scene", update ? "golden" : "pixels off");
+    for (const Scene& scene : Scenes)
+    {
+        scene.play(*ui);
+        if (!hal.screenshot(&screen))
+        {
+            fprintf(stderr, "Failed to read the display\n");
+            return 1;
+        }
+        std::string golden = golden_dir + "/" + scene.name + ".png";
+        if (update)
+        {
+            bool written = write_png(screen, golden);
+            printf("%-20s %s\n", scene.name, written ? golden.c_str() : "FAILED");
+            failed += !written;
+            continue;
+        }
+        long diff = compare_golden(screen, golden);
+        if (diff == 0)
+        {
+            printf("%-20s 0\n", scene.name);
+            continue;
+        }
+        failed++;
+        std::string actual = out_dir + "/" + scene.name + ".actual.png";
+        write_png(screen, actual);
+        if (diff < 0)
+            printf("%-20s no golden image, frame in %s\n", scene.name, actual.c_str());
+        else
+            printf("%-20s %ld, frame in %s\n", scene.name, diff, actual.c_str());
+    }
+
+    if (!update)
+    {
+        // FNV-1a gives each pair the same hash, the caches must still tell them apart
+        long diff = check_glyph_collision("51502", "5-.49");
+        printf("%-20s %ld\n", "glyph collision", diff);
+        failed += diff != 0;
+        const int32_t triangles[2][6] = {{0, 0, 31, 39, 30, 27}, {31, 0, 4, 33, 0, 39}};
+        diff = check_shape_collision(triangles[0], triangles[1]);
+        printf("%-20s %ld\n", "shape collision", diff);
+        failed += diff != 0;
+    }
+
+    if (bench)
+    {
+        const double screen_px = (double)hal.canvas()->width() * hal.canvas()->height();
+        printf("\n%-12s %7s %10s %10s %10s %10s %9s  (%s)\n",
+               "workload",
+               "frames",
+               "render",
+               "p95",
+               "flush",
+               "p95",
+               "damage",
+               CYCLE_COUNTER_UNIT);
+        for (const Workload& workload : Workloads)
+        {
+            FrameTimes times;
+            for (int i = 0; i < workload.frames; i++)
+            {
+                workload.step(*ui, i);
+                frame(*ui, &times);
+            }
+            size_t drawn = times.render.size();
+            printf("%-12s %7zu %10llu %10llu %10llu %10llu %8.1f%%\n",
+                   workload.name,
+                   drawn,
+                   (unsigned long long)mean(times.render),
+                   (unsigned long long)percentile(times.render, 95),
+                   (unsigned long long)mean(times.flush),
+                   (unsigned long long)percentile(times.flush, 95),
+                   drawn ? 100.0 * times.damaged / (drawn * screen_px) : 0.0);
+        }
+    }
+
+    delete ui;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file wav_reader.cpp
+ * @author d4rkmen
+ * @brief Minimal WAV / raw PCM loader for the host tools
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "wav_reader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static const uint16_t WAVE_FORMAT_PCM = 0x0001;
+static const uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+static const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+static bool read_file(const std::string& path, std::vector<uint8_t>& data, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "can't open " + path;
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static inline uint16_t le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static inline uint32_t le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+// Decode one sample into the -32768..32767 range
+static int32_t decode_sample(const uint8_t* p, uint16_t format, uint16_t bits)
+{
+    if (format == WAVE_FORMAT_IEEE_FLOAT)
+    {
+        float f;
+        memcpy(&f, p, sizeof(f));
+        return (int32_t)std::lround(std::max(-1.0f, std::min(1.0f, f)) * 32767.0f);
+    }
+    switch (bits)
+    {
+    case 8:
+        return ((int32_t)p[0] - 128) << 8;
+    case 16:
+        return (int16_t)le16(p);
+    case 24:
+        return ((int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24))) >> 16;
+    default:
+        return ((int32_t)le32(p)) >> 16;
+    }
+}
+
+bool load_wav(const std::string& path, AudioClip& clip, std::string& error)
+{
+    std::vector<uint8_t> data;
+    if (!read_file(path, data, error))
+        return false;
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) || memcmp(&data[8], "WAVE", 4))
+    {
+        error = path + ": not a RIFF/WAVE file";
+        return false;
+    }
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    const uint8_t* pcm = nullptr;
+    size_t pcm_len = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= data.size())
+    {
+        const uint8_t* chunk = &data[pos];
+        size_t len = le32(chunk + 4);
+        size_t avail = std::min(len, data.size() - pos - 8);
+        if (!memcmp(chunk, "fmt ", 4) && avail >= 16)
+        {
+            format = le16(chunk + 8);
+            channels = le16(chunk + 10);
+            rate = le32(chunk + 12);
+            bits = le16(chunk + 22);
+            if (format == WAVE_FORMAT_EXTENSIBLE && avail >= 26)
+                format = le16(chunk + 32);
+        }
+        else if (!memcmp(chunk, "data", 4))
+        {
+            pcm = chunk + 8;
+            pcm_len = avail;
+        }
+        pos += 8 + len + (len & 1);
+    }
+
+    if (!pcm || !channels || !rate)
+    {
+        error = path + ": missing fmt or data chunk";
+        return false;
+    }
+    bool supported = (format == WAVE_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) ||
+                     (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32);
+    if (!supported)
+    {
+        error = path + ": unsupported format " + std::to_string(format) + "/" + std::to_string(bits) + " bit";
+        return false;
+    }
+
+    size_t bytes_per_sample = bits / 8;
+    size_t frame_bytes = bytes_per_sample * channels;
+    size_t frames = pcm_len / frame_bytes;
+    clip.sample_rate = rate;
+    clip.samples.resize(frames);
+    for (size_t i = 0; i < frames; i++)
+    {
+        int32_t sum = 0;
+        for (uint16_t c = 0; c < channels; c++)
+            sum += decode_sample(pcm + i * frame_bytes + c * bytes_per_sample, format, bits);
+        clip.samples[i] = (int16_t)(sum / channels);
+    }
+    return true;
+}
+
+bool load_raw_pcm16(const std::string& path, uint32_t sample_rate, AudioClip& clip, std::string& error)
+{
+    std::vector<uint8_t> data;
+    if (!read_file(path, data, error))
+        return false;
+    clip.sample_rate = sample_rate;
+    clip.samples.resize(data.size() / 2);
+    for (size_t i = 0; i < clip.samples.size(); i++)
+        clip.samples[i] = (int16_t)le16(&data[i * 2]);
+    return true;
+}
+
+bool load_audio(const std::string& path, uint32_t raw_sample_rate, AudioClip& clip, std::string& error)
+{
+    std::string ext = path.size() > 4 ? path.substr(path.size() - 4) : "";
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".raw" || ext == ".pcm")
+        return load_raw_pcm16(path, raw_sample_rate, clip, error);
+    return load_wav(path, clip, error);
+}
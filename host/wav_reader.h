@@ -0,0 +1,32 @@
+/**
+ * @file wav_reader.h
+ * @author d4rkmen
+ * @brief Minimal WAV / raw PCM loader for the host tools
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AudioClip
+{
+    std::vector<int16_t> samples; // mono, 16-bit
+    uint32_t sample_rate = 0;
+};
+
+/// @brief Load a RIFF/WAVE file. PCM 8/16/24/32-bit and 32-bit float are supported,
+/// multi-channel input is mixed down to mono.
+/// @return false and a message in `error` if the file can't be used.
+bool load_wav(const std::string& path, AudioClip& clip, std::string& error);
+
+/// @brief Load headerless little-endian signed 16-bit mono PCM.
+bool load_raw_pcm16(const std::string& path, uint32_t sample_rate, AudioClip& clip, std::string& error);
+
+/// @brief Load `path` as WAV, or as raw PCM when the extension is .raw/.pcm.
+bool load_audio(const std::string& path, uint32_t raw_sample_rate, AudioClip& clip, std::string& error);
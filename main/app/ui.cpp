@@ -1,7 +1,9 @@
 #include "ui.h"
 #include "esp_log.h"
-#include <cmath>  // For std::log2, std::abs
-#include <string> // For std::to_string
+#include <algorithm> // For std::min
+#include <cmath>     // For std::log2, std::abs
+#include <cstring>   // For memcmp
+#include <string>    // For std::to_string
 #include <app/utils/common_define.h>
 #include <app/assets/tuna.h>
 
@@ -11,56 +13,95 @@ const float CENTS_PER_SEMITONE = 100.0f;
 const float MAX_DEVIATION_CENTS = 50.0f; // +/- 50 cents (half a semitone) maps to MAX_PITCH_DEVIATION_PX
 
 static const char* TAG = "UI";
-static const char* mode_names[] = {"AUTO", "GUITAR", "UKULELE", "VIOLIN"};
+static const char* mode_names[] = {"AUTO", "GUITAR", "UKULELE", "VIOLIN", "STRUM"};
+static const char* strum_names[STRUM_STRINGS] = {"E2", "A2", "D3", "G3", "B3", "E4"};
 
 static const char* control_hint = "[LEFT]-[RIGHT] MODE [UP]-[DOWN] STRING";
-static const char* control_hint_auto = "[LEFT]-[RIGHT] MODE";
+static const char* control_hint_auto = "[LEFT]-[RIGHT] MODE [S] STROBE";
+static const char* control_hint_strobe = "[LEFT]-[RIGHT] MODE [S] BACK";
+static const char* control_hint_strum = "[LEFT]-[RIGHT] MODE";
+static const char* control_hint_spectrum = "[LEFT]-[RIGHT] MODE [F] BACK";
+static const char* control_hint_history = "[LEFT]-[RIGHT] MODE [H] BACK";
 static int hint_char_index = -1;
 static uint32_t hint_update_time = 0;
 static uint32_t hint_timeout = HINT_ANIMATION_DELAY;
 
 TunerUI::TunerUI(HAL::Hal* hal)
-    : _hal(hal), _canvas(_hal->canvas()), _text(new LGFX_Sprite(_hal->canvas())), _current_freq(0.0f), _target_note(""),
+    : _hal(hal), _canvas(_hal->canvas()), _glyphs(_hal->canvas()), _current_freq(0.0f), _target_note(""),
       _target_octave(-1), _target_freq(0.0f), _pitch_offset_x(0.0f), _needs_update(true), _mode(MODE_GUITAR), _max_strings(6),
-      _cur_string(5), _strings_rendered_time(0), _signal_lost_time(0)
+      _cur_string(5), _strings_rendered_time(0), _signal_lost_time(0), _strobe_view(false), _strobe_time(0),
+      _spectrum_view(false), _spectrum_rows(0), _waterfall(nullptr), _waterfall_top(0),
+      _history_view(false), _history_samples(0), _history_last_us(0),
+      _damage(_canvas->width(), _canvas->height()), _splash(false), _splash_start(0)
 {
-    // _text = new LGFX_Sprite(_hal->canvas());
-    _text->createSprite(_hal->canvas()->width(), _hal->canvas()->height());
+    _scene.view = UI_VIEW_TUNER;
+    _scene.count = 0;
+    _strobe = {.phase = 0, .drift = 0, .reference = 0, .level = 0};
+    for (int i = 0; i < STRUM_STRINGS; i++)
+    {
+        _strum.frequency[i] = -1;
+        _strum.shared[i] = false;
+        _strum_time[i] = 0;
+    }
+    memset(_spectrum.level, 0, sizeof(_spectrum.level));
+    _spectrum.pitch = -1;
+    for (int i = 0; i < HISTORY_COLUMNS; i++)
+        _history[i].column = -1;
+    // Waterfall colors, black through blue, purple and orange to white
+    static const uint8_t stops[][4] = {
+        {0, 0, 0, 0}, {80, 0, 0, 160}, {140, 160, 0, 160}, {190, 255, 120, 0}, {230, 255, 230, 0}, {255, 255, 255, 255}};
+    for (int level = 0, s = 0; level < 256; level++)
+    {
+        if (level > stops[s + 1][0])
+            s++;
+        const uint8_t* a = stops[s];
+        const uint8_t* b = stops[s + 1];
+        int t = (level - a[0]) * 256 / (b[0] - a[0]);
+        _palette[level] = lgfx::swap565_t(a[1] + (b[1] - a[1]) * t / 256,
+                                          a[2] + (b[2] - a[2]) * t / 256,
+                                          a[3] + (b[3] - a[3]) * t / 256);
+    }
     init();
 }
 
-TunerUI::~TunerUI()
+TunerUI::~TunerUI() { delete[] _waterfall; }
+
+void TunerUI::init()
 {
-    _text->deleteSprite();
-    delete _text;
+    // The splash is played by render() like any other frame, the pitch
+    // detector is already listening and a note or a key cuts it short
+    _splash = true;
+    _splash_start = millis();
+    _needs_update = true; // Ensure initial render
 }
 
-void TunerUI::init()
+void TunerUI::end_splash()
+{
+    _splash = false;
+}
+
+int TunerUI::_splash_radius(uint32_t now) const
+{
+    // Slow at first and closing in faster, like the old delay per step
+    float t = std::min(1.0f, static_cast<float>(now - _splash_start) / SPLASH_SHRINK_MS);
+    return SPLASH_RADIUS - static_cast<int>((SPLASH_RADIUS - NOTE_CIRCLE_RADIUS) * t * t);
+}
+
+void TunerUI::_render_splash(int radius)
 {
-    // draw circle animation
     int center_x = _canvas->width() / 2;
     int center_y = _canvas->height() / 2;
-    for (int r = 160; r > NOTE_CIRCLE_RADIUS; r--)
-    {
-        _canvas->fillScreen(BACKGROUND_COLOR);
-        _canvas->fillCircle(center_x, center_y, r, TARGET_COLOR);
-        _hal->canvas_update();
-        // exponential delay
-        delay((r - NOTE_CIRCLE_RADIUS) / 20);
-    }
+    _canvas->fillCircle(center_x, center_y, radius, TARGET_COLOR);
+    if (radius > NOTE_CIRCLE_RADIUS)
+        return;
     // print version
-    _text->fillScreen(TFT_TRANSPARENT);
-    _text->pushImage(center_x - 48 / 2, 16, 48, 24, image_data_tuna, TFT_ORANGE);
-    _text->setFont(NOTE_TEXT_FONT);
-    _text->setTextSize(2);
-    _text->setTextColor(TFT_WHITE, TFT_TRANSPARENT); // Text color, background color (transparent)
-    _text->drawCenterString("M5Tuna", center_x, center_y - 20);
-    _text->setTextColor(NOTE_TEXT_COLOR, TFT_TRANSPARENT); // Text color, background color (transparent)
-    _text->drawCenterString(BUILD_NUMBER, center_x, center_y + 10);
-    _text->pushSprite(_canvas, 0, 0, TFT_TRANSPARENT);
-    _hal->canvas_update();
-    delay(2000);
-    _needs_update = true; // Ensure initial render
+    _canvas->pushImage(center_x - 48 / 2, 16, 48, 24, image_data_tuna, TFT_ORANGE);
+    _canvas->setFont(NOTE_TEXT_FONT);
+    _canvas->setTextSize(2);
+    _canvas->setTextColor(TFT_WHITE); // No background color, the text is drawn transparent
+    _canvas->drawCenterString("M5Tuna", center_x, center_y - 20);
+    _canvas->setTextColor(NOTE_TEXT_COLOR);
+    _canvas->drawCenterString(BUILD_NUMBER, center_x, center_y + 10);
 }
 
 void TunerUI::_calculate_pitch_offset()
@@ -90,6 +131,8 @@ void TunerUI::update_freq(float current_freq, const std::string& target_note, in
          target_octave != _target_octave))
     {
         uint32_t current_time = millis();
+        if (current_freq > 0)
+            end_splash();
         if ((current_freq < 0) && (last_freq != current_freq) && (current_time - _signal_lost_time >= SIGNAL_LOST_HOLD_TIME))
         {
             // signal lost
@@ -106,7 +149,6 @@ void TunerUI::update_freq(float current_freq, const std::string& target_note, in
         last_freq = current_freq;
 
         _calculate_pitch_offset();
-        _needs_update = true;
     }
 }
 
@@ -125,90 +167,583 @@ void TunerUI::update_string(uint8_t string)
 {
     _cur_string = string;
     _strings_rendered_time = millis();
+}
+
+void TunerUI::update_strum(const StrumInfo& info)
+{
+    // Strings fade out of a strum one by one, keep each one's last reading
+    uint32_t now = millis();
+    for (int i = 0; i < STRUM_STRINGS; i++)
+    {
+        if (info.frequency[i] <= 0)
+            continue;
+        _strum.frequency[i] = info.frequency[i];
+        _strum.cents[i] = info.cents[i];
+        _strum.level[i] = info.level[i];
+        _strum.shared[i] = info.shared[i];
+        _strum_time[i] = now;
+    }
+}
+
+void TunerUI::_render_strum()
+{
+    int center_x = _canvas->width() / 2;
+    uint32_t now = millis();
+
+    _canvas->setFont(NOTE_TEXT_FONT);
+    _canvas->setTextSize(1);
+    const int row_h = STRUM_ROW_H;
+    const int top = STRUM_ROWS_Y;
+    const int label_w = 28;
+    const int value_w = 40;
+    const int bar_x = label_w + 4;
+    const int bar_w = _canvas->width() - bar_x - value_w - 4;
+    const int bar_center = bar_x + bar_w / 2;
+
+    for (int i = 0; i < STRUM_STRINGS; i++)
+    {
+        // Highest string on top, like the single string list
+        int string = STRUM_STRINGS - 1 - i;
+        int y = top + i * row_h;
+        bool valid = _strum.frequency[string] > 0 && now - _strum_time[string] < STRUM_HOLD_TIME;
+
+        _glyphs.draw(_canvas, strum_names[string], NOTE_TEXT_FONT, 1, TFT_LIGHTGREY, 4, y);
+        _canvas->drawFastHLine(bar_x, y + row_h / 2, bar_w, TFT_DARKGREY);
+        _canvas->drawFastVLine(bar_center, y + 2, row_h - 4, TFT_DARKGREY);
+        if (!valid)
+        {
+            _glyphs.draw(_canvas, "--", NOTE_TEXT_FONT, 1, TFT_LIGHTGREY, _canvas->width() - 4, y, UTILS::GLYPH_ALIGN_RIGHT);
+            continue;
+        }
+        if (_strum.shared[string])
+        {
+            // Merged with a lower string's partial, its cents can be tens off.
+            // Plucked on its own it reads fine.
+            _glyphs.draw(_canvas, "solo", NOTE_TEXT_FONT, 1, TFT_LIGHTGREY, _canvas->width() - 4, y, UTILS::GLYPH_ALIGN_RIGHT);
+            continue;
+        }
+
+        float cents = _strum.cents[string];
+        float clamped = std::max(-STRUM_BAR_CENTS, std::min(STRUM_BAR_CENTS, cents));
+        int marker_x = bar_center + static_cast<int>(clamped / STRUM_BAR_CENTS * (bar_w / 2));
+        int color = std::abs(cents) <= STRUM_IN_TUNE_CENTS ? SUCCESS_COLOR : TUNING_COLOR;
+        _canvas->fillRect(std::min(bar_center, marker_x), y + row_h / 2 - 2, std::abs(marker_x - bar_center) + 1, 5, color);
+        _canvas->fillCircle(marker_x, y + row_h / 2, 4, color);
+
+        char value[8];
+        snprintf(value, sizeof(value), "%+d", static_cast<int>(std::round(cents)));
+        // Numbers change all the time, not worth caching
+        _canvas->setTextColor(color);
+        _canvas->drawRightString(value, _canvas->width() - 4, y);
+    }
+
+    _glyphs.draw(_canvas, mode_names[_mode], NOTE_TEXT_FONT, 1, TFT_WHITE, center_x, 10, UTILS::GLYPH_ALIGN_CENTER);
+}
+
+void TunerUI::update_spectrum(const SpectrumLine& line)
+{
+    _spectrum = line;
+    _spectrum_rows++;
+    // Rows still on their way after the view was closed
+    if (_waterfall == nullptr)
+        return;
+    // The ring moves up one row instead of the image moving down
+    _waterfall_top = (_waterfall_top + SPECTRUM_WATERFALL_H - 1) % SPECTRUM_WATERFALL_H;
+    lgfx::swap565_t* row = _waterfall + _waterfall_top * SPECTRUM_BANDS;
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+        row[b] = _palette[line.level[b]];
+}
+
+void TunerUI::toggle_spectrum()
+{
+    _spectrum_view = !_spectrum_view;
+    if (_spectrum_view)
+        _history_view = false;
+    // 25 KB, not worth keeping while the view is off
+    delete[] _waterfall;
+    _waterfall = nullptr;
+    if (_spectrum_view)
+    {
+        _waterfall = new lgfx::swap565_t[SPECTRUM_WATERFALL_H * SPECTRUM_BANDS];
+        std::fill(_waterfall, _waterfall + SPECTRUM_WATERFALL_H * SPECTRUM_BANDS, _palette[0]);
+        _waterfall_top = 0;
+        memset(_spectrum.level, 0, sizeof(_spectrum.level));
+        _spectrum.pitch = -1;
+    }
+    animateHintReset();
     _needs_update = true;
 }
 
-bool TunerUI::render()
+// Column of a frequency on the spectrum's log axis
+static int spectrum_x(float frequency)
 {
-    uint32_t current_time = millis();
-    static uint32_t last_render_time = 0;
+    return static_cast<int>(SPECTRUM_BANDS * std::log(frequency / SPECTRUM_LOW_HZ) /
+                            std::log(SPECTRUM_HIGH_HZ / SPECTRUM_LOW_HZ));
+}
 
-    bool is_draw_strings = (current_time - _strings_rendered_time < STRINGS_DISPLAY_TIME_MS) && _mode != MODE_AUTO;
-    _needs_update |= is_draw_strings;
+void TunerUI::_render_spectrum()
+{
+    const int width = std::min<int>(_canvas->width(), SPECTRUM_BANDS);
+    const int bottom = SPECTRUM_BARS_Y + SPECTRUM_BARS_H;
 
-    if (current_time - last_render_time > 33)
+    _glyphs.draw(_canvas, mode_names[_mode], NOTE_TEXT_FONT, 1, TFT_WHITE, _canvas->width() / 2, 10, UTILS::GLYPH_ALIGN_CENTER);
+
+    // 100 Hz and 1 kHz
+    for (float grid = 100.0f; grid < SPECTRUM_HIGH_HZ; grid *= 10)
+        _canvas->drawFastVLine(spectrum_x(grid), SPECTRUM_BARS_Y, SPECTRUM_BARS_H, TFT_DARKGREY);
+    for (int x = 0; x < width; x++)
     {
-        last_render_time = current_time;
-        _needs_update = true;
+        int h = _spectrum.level[x] * SPECTRUM_BARS_H / 255;
+        if (h > 0)
+            _canvas->drawFastVLine(x, bottom - h, h, PITCH_CIRCLE_COLOR);
     }
 
-    if (!_needs_update)
+    // The detected pitch across the bars, its overtones as ticks above them
+    if (_spectrum.pitch > 0)
     {
-        return false; // Nothing changed, no need to re-render
+        for (int h = 1; h <= SPECTRUM_HARMONICS && h * _spectrum.pitch < SPECTRUM_HIGH_HZ; h++)
+        {
+            int x = spectrum_x(h * _spectrum.pitch);
+            if (h == 1)
+                _canvas->drawFastVLine(x, SPECTRUM_BARS_Y, SPECTRUM_BARS_H, TARGET_COLOR);
+            else
+                _canvas->drawFastVLine(x, SPECTRUM_BARS_Y, 4, TARGET_COLOR);
+        }
+        char value[16];
+        snprintf(value, sizeof(value), "%.1f Hz", _spectrum.pitch);
+        // Numbers change all the time, not worth caching
+        _canvas->setFont(NOTE_TEXT_FONT);
+        _canvas->setTextSize(1);
+        _canvas->setTextColor(TARGET_COLOR);
+        _canvas->drawRightString(value, _canvas->width() - 4, 10);
     }
 
-    // Clear the canvas (or relevant area if optimizing)
-    _canvas->fillScreen(BACKGROUND_COLOR);
+    // The ring is copied as is, newest row first, nothing is redrawn
+    if (_waterfall)
+    {
+        int newest = SPECTRUM_WATERFALL_H - _waterfall_top;
+        _canvas->pushImage(0, SPECTRUM_WATERFALL_Y, SPECTRUM_BANDS, newest, _waterfall + _waterfall_top * SPECTRUM_BANDS);
+        if (_waterfall_top > 0)
+            _canvas->pushImage(0, SPECTRUM_WATERFALL_Y + newest, SPECTRUM_BANDS, _waterfall_top, _waterfall);
+    }
+}
 
-    // Calculate center positions
+int32_t TunerUI::_history_column(int64_t time_us) const
+{
+    return static_cast<int32_t>(time_us * HISTORY_COLUMNS / (HISTORY_GRAPH_MS * 1000LL));
+}
+
+void TunerUI::update_history(const PitchSample& sample)
+{
+    if (sample.time_us < 0)
+        return;
+    int32_t column = _history_column(sample.time_us);
+    HistoryColumn& c = _history[column % HISTORY_COLUMNS];
+    float clamped = std::max(-HISTORY_CENTS, std::min(HISTORY_CENTS, sample.cents));
+    int16_t tenths = static_cast<int16_t>(std::round(10 * clamped));
+    uint8_t confidence = static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, sample.confidence)) * 255);
+    // A column of the graph spans a few hops, it shows the spread of the detections in it
+    if (c.column != column)
+        c = {column, tenths, tenths, confidence, 0};
+    c.low = std::min(c.low, tenths);
+    c.high = std::max(c.high, tenths);
+    c.confidence = std::max(c.confidence, confidence);
+    if (c.count < UINT8_MAX)
+        c.count++;
+    _history_samples++;
+    _history_last_us = std::max(_history_last_us, sample.time_us);
+}
+
+void TunerUI::toggle_history()
+{
+    _history_view = !_history_view;
+    if (_history_view && _spectrum_view)
+        toggle_spectrum();
+    animateHintReset();
+    _needs_update = true;
+}
+
+int TunerUI::_history_rate(int32_t now_column) const
+{
+    // Detections in the last second, the detector's real update rate. Counted
+    // up to a HISTORY_RATE_MS boundary, the number would flicker otherwise.
+    now_column -= now_column % (HISTORY_COLUMNS * HISTORY_RATE_MS / HISTORY_GRAPH_MS);
+    const int32_t span = HISTORY_COLUMNS * 1000 / HISTORY_GRAPH_MS;
+    int rate = 0;
+    for (int32_t column = now_column - span + 1; column <= now_column; column++)
+    {
+        if (column < 0)
+            continue;
+        const HistoryColumn& c = _history[column % HISTORY_COLUMNS];
+        if (c.column == column)
+            rate += c.count;
+    }
+    return rate;
+}
+
+void TunerUI::_render_history()
+{
+    const int width = std::min<int>(_canvas->width(), HISTORY_COLUMNS);
+    const int mid = HISTORY_GRAPH_Y + HISTORY_GRAPH_H / 2;
+    const float scale = (HISTORY_GRAPH_H / 2 - 1) / (10 * HISTORY_CENTS); // Pixels per tenth of a cent
+    const int32_t now_column = _history_column(millis() * 1000);
+
+    _glyphs.draw(_canvas, mode_names[_mode], NOTE_TEXT_FONT, 1, TFT_WHITE, _canvas->width() / 2, 10, UTILS::GLYPH_ALIGN_CENTER);
+    char value[16];
+    snprintf(value, sizeof(value), "%d/s", _history_rate(now_column));
+    _canvas->setFont(NOTE_TEXT_FONT);
+    _canvas->setTextSize(1);
+    _canvas->setTextColor(TFT_LIGHTGREY);
+    _canvas->drawRightString(value, _canvas->width() - 4, 10);
+
+    // In tune in the middle, dashes at +/- HISTORY_IN_TUNE_CENTS
+    _canvas->drawFastHLine(0, mid, width, TFT_DARKGREY);
+    int band = static_cast<int>(std::round(10 * HISTORY_IN_TUNE_CENTS * scale));
+    for (int x = 0; x < width; x += 6)
+    {
+        _canvas->drawFastHLine(x, mid - band, 3, TFT_DARKGREY);
+        _canvas->drawFastHLine(x, mid + band, 3, TFT_DARKGREY);
+    }
+
+    for (int x = 0; x < width; x++)
+    {
+        int32_t column = now_column - (width - 1 - x);
+        if (column < 0)
+            continue;
+        const HistoryColumn& c = _history[column % HISTORY_COLUMNS];
+        if (c.column != column)
+            continue;
+        int top = mid - static_cast<int>(std::round(c.high * scale));
+        int bottom = mid - static_cast<int>(std::round(c.low * scale));
+        int color = TUNING_COLOR;
+        if (c.confidence < HISTORY_MIN_CONFIDENCE * 255)
+            color = TFT_DARKGREY;
+        else if (std::max(std::abs(c.low), std::abs(c.high)) <= 10 * HISTORY_IN_TUNE_CENTS)
+            color = SUCCESS_COLOR;
+        // Two pixels at least, a single detection is hard to see otherwise
+        _canvas->fillRect(x, top - 1, 1, std::max(bottom - top, 0) + 2, color);
+    }
+}
+
+void TunerUI::update_strobe(const StrobeInfo& info)
+{
+    _strobe = info;
+    _strobe_time = millis();
+}
+
+void TunerUI::toggle_strobe()
+{
+    _strobe_view = !_strobe_view;
+    animateHintReset();
+    _needs_update = true;
+}
+
+float TunerUI::_strobe_cents() const
+{
+    return 1200.0f * std::log2((_strobe.reference + _strobe.drift) / _strobe.reference);
+}
+
+void TunerUI::_render_strobe_text()
+{
     int center_x = _canvas->width() / 2;
-    int center_y = _canvas->height() / 2;
 
-    // 1. Draw the filled orange target note circle
-    // if pitch is in the range of 10 cents, draw the circle in green
-    _canvas->fillCircle(center_x, center_y, NOTE_CIRCLE_RADIUS, TARGET_COLOR);
+    _glyphs.draw(_canvas, mode_names[_mode], NOTE_TEXT_FONT, 1, TFT_WHITE, center_x, 10, UTILS::GLYPH_ALIGN_CENTER);
 
-    // 2. Draw the note name and octave number inside the target circle
+    std::string note = _target_note;
+    if (_target_octave >= 0)
+        note += std::to_string(_target_octave);
+    _glyphs.draw(_canvas, note.c_str(), NOTE_TEXT_FONT, 2, TARGET_COLOR, center_x, 26, UTILS::GLYPH_ALIGN_CENTER);
 
-    _text->fillScreen(TFT_TRANSPARENT);
-    _text->setTextColor(NOTE_TEXT_COLOR, TFT_TRANSPARENT); // Text color, background color (transparent)
-    // draw strings
-    if (is_draw_strings)
+    // The pattern shows the drift, the number is there for the record
+    if (_strobe.reference <= 0)
     {
-        _text->setFont(NOTE_TEXT_FONT);
-        _text->setTextSize(1);
-        // draw strings where selected is hightlighted
-        const uint8_t string_h = _text->fontHeight() + 2;
-        const uint8_t string_w = _text->textWidth("000");
-        const uint16_t all_strings_h = string_h * _max_strings;
-        const uint16_t start_y = center_y - all_strings_h / 2;
-        for (uint8_t i = 0; i < _max_strings; i++)
+        _glyphs.draw(
+            _canvas, "--", NOTE_TEXT_FONT, 1, TFT_DARKGREY, center_x, STROBE_BAND_Y + STROBE_BAND_H + 6, UTILS::GLYPH_ALIGN_CENTER);
+        return;
+    }
+    float cents = _strobe_cents();
+    char value[16];
+    snprintf(value, sizeof(value), "%+.1f c", cents);
+    _canvas->setFont(NOTE_TEXT_FONT);
+    _canvas->setTextSize(1);
+    _canvas->setTextColor(std::abs(cents) < STROBE_IN_TUNE_CENTS ? SUCCESS_COLOR : TUNING_COLOR);
+    _canvas->drawCenterString(value, center_x, STROBE_BAND_Y + STROBE_BAND_H + 6);
+}
+
+void TunerUI::_draw_strobe_rows(uint32_t now)
+{
+    const int width = _canvas->width();
+    const int row_h = STROBE_BAND_H / 2;
+    _canvas->fillRect(0, STROBE_BAND_Y, width, STROBE_BAND_H, BACKGROUND_COLOR);
+
+    bool active = _strobe.reference > 0;
+    float phase = _strobe.phase;
+    int color = TFT_DARKGREY;
+    if (active)
+    {
+        // A new phase arrives every hop, move the pattern on with the drift in between
+        uint32_t age = std::min<uint32_t>(now - _strobe_time, STROBE_EXTRAPOLATE_MS);
+        phase += _strobe.drift * age / 1000.0f;
+        float cents = _strobe_cents();
+        color = std::abs(cents) < STROBE_IN_TUNE_CENTS ? SUCCESS_COLOR : TUNING_COLOR;
+    }
+
+    for (int row = 0; row < 2; row++)
+    {
+        float turns = row == 0 ? phase : phase * STROBE_FINE_RATIO;
+        turns -= std::floor(turns);
+        // Sharp moves the bands to the right like a needle would
+        int offset = static_cast<int>(turns * STROBE_BAND_PERIOD);
+        int y = STROBE_BAND_Y + row * row_h + 1;
+        for (int x = offset - STROBE_BAND_PERIOD; x < width; x += STROBE_BAND_PERIOD)
+            _canvas->fillRect(x, y, STROBE_BAND_PERIOD / 2, row_h - 2, color);
+    }
+}
+
+bool TunerUI::render_strobe()
+{
+    if (!_strobe_view || _mode == MODE_STRUM || _spectrum_view || _history_view || _splash)
+        return false;
+    _canvas = _hal->canvas();
+    _draw_strobe_rows(millis());
+    return true;
+}
+
+bool TunerUI::animating() const
+{
+    // The splash circle shrinks, the strobe bands turn and the hint highlight walks along its text
+    if (_splash)
+        return millis() - _splash_start < SPLASH_SHRINK_MS;
+    // and the history graph scrolls until its newest detection has left it
+    if (_history_view)
+        return millis() - _history_last_us / 1000 < HISTORY_GRAPH_MS || hint_char_index >= 0;
+    return (_strobe_view && _mode != MODE_STRUM && !_spectrum_view) || hint_char_index >= 0;
+}
+
+// Cheap hash of the state an element is drawn from
+static uint32_t element_key(std::initializer_list<int64_t> values)
+{
+    uint32_t key = 2166136261u;
+    for (int64_t v : values)
+        key = (key ^ static_cast<uint32_t>(v)) * 16777619u;
+    return key;
+}
+
+static uint32_t element_key(const char* text)
+{
+    uint32_t key = 2166136261u;
+    while (text && *text)
+        key = (key ^ static_cast<uint8_t>(*text++)) * 16777619u;
+    return key;
+}
+
+void TunerUI::_add_element(UiScene& scene, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t key)
+{
+    if (scene.count < UI_SCENE_MAX_ELEMENTS)
+        scene.elements[scene.count++] = {{x, y, w, h}, key};
+}
+
+void TunerUI::_build_scene(UiScene& scene, bool is_draw_strings, const char* hint)
+{
+    const int width = _canvas->width();
+    const int height = _canvas->height();
+    const int center_x = width / 2;
+    const int center_y = height / 2;
+    scene.count = 0;
+    if (_splash)
+    {
+        scene.view = UI_VIEW_SPLASH;
+        _add_element(scene, 0, 0, width, height, element_key({_splash_radius(millis())}));
+        return;
+    }
+    if (_spectrum_view)
+        scene.view = UI_VIEW_SPECTRUM;
+    else if (_history_view)
+        scene.view = UI_VIEW_HISTORY;
+    else
+        scene.view = _mode == MODE_STRUM ? UI_VIEW_STRUM : (_strobe_view ? UI_VIEW_STROBE : UI_VIEW_TUNER);
+
+    // Title and hint are on every view
+    _add_element(scene, 0, 8, width, 20, element_key({_mode}));
+    _add_element(scene, 0, height - 12, width, 12, element_key({element_key(hint), hint_char_index}));
+
+    if (scene.view == UI_VIEW_STRUM)
+    {
+        uint32_t now = millis();
+        for (int i = 0; i < STRUM_STRINGS; i++)
         {
-            if (i == _cur_string)
-            {
-                _text->fillRoundRect(-8, start_y + i * string_h, string_w + 16, string_h, 4, TFT_LIGHTGREY);
-                _text->setTextColor(TFT_BLACK, TFT_LIGHTGREY);
-            }
+            int string = STRUM_STRINGS - 1 - i;
+            bool valid = _strum.frequency[string] > 0 && now - _strum_time[string] < STRUM_HOLD_TIME;
+            bool shared = valid && _strum.shared[string];
+            int32_t cents = valid && !shared ? static_cast<int32_t>(std::round(_strum.cents[string])) : 0;
+            _add_element(scene, 0, STRUM_ROWS_Y + i * STRUM_ROW_H, width, STRUM_ROW_H, element_key({valid, shared, cents}));
+        }
+        return;
+    }
+
+    if (scene.view == UI_VIEW_SPECTRUM)
+    {
+        int32_t tenths = _spectrum.pitch > 0 ? static_cast<int32_t>(std::round(10 * _spectrum.pitch)) : INT32_MIN;
+        _add_element(scene, width - 80, 8, 80, 20, element_key({tenths}));
+        // Every row changes the bars and moves the whole waterfall down
+        _add_element(scene, 0, SPECTRUM_BARS_Y, width, SPECTRUM_BARS_H, element_key({_spectrum_rows}));
+        _add_element(scene, 0, SPECTRUM_WATERFALL_Y, width, SPECTRUM_WATERFALL_H, element_key({_spectrum_rows}));
+        return;
+    }
+
+    if (scene.view == UI_VIEW_HISTORY)
+    {
+        int32_t now_column = _history_column(millis() * 1000);
+        _add_element(scene, width - 60, 8, 60, 20, element_key({_history_rate(now_column)}));
+        // Scrolls by a column at a time
+        _add_element(scene, 0, HISTORY_GRAPH_Y, width, HISTORY_GRAPH_H, element_key({now_column, _history_samples}));
+        return;
+    }
+
+    if (scene.view == UI_VIEW_STROBE)
+    {
+        // The rows themselves are redrawn by render_strobe()
+        _add_element(scene, 0, 26, width, 34, element_key({element_key(_target_note.c_str()), _target_octave}));
+        int32_t tenths = _strobe.reference > 0 ? static_cast<int32_t>(std::round(10 * _strobe_cents())) : INT32_MIN;
+        _add_element(scene, 0, STROBE_BAND_Y + STROBE_BAND_H + 4, width, 20, element_key({tenths}));
+        return;
+    }
+
+    // The note text is taller than the note circle
+    _add_element(scene,
+                 center_x - NOTE_CIRCLE_RADIUS,
+                 0,
+                 2 * NOTE_CIRCLE_RADIUS + 1,
+                 height - 12,
+                 element_key({element_key(_target_note.c_str()), _target_octave}));
+
+    // Pitch circle and its arrow
+    if (_current_freq > 0)
+    {
+        int offset = static_cast<int>(_pitch_offset_x);
+        int pitch_x = center_x + offset;
+        int left = pitch_x - PITCH_CIRCLE_RADIUS;
+        int right = pitch_x + PITCH_CIRCLE_RADIUS;
+        if (abs(_pitch_offset_x) > 10)
+        {
+            if (_pitch_offset_x > 0)
+                right += 20 + 10;
             else
-            {
-                _text->drawRoundRect(-8, start_y + i * string_h, string_w + 16, string_h, 4, TFT_LIGHTGREY);
-                _text->setTextColor(TFT_LIGHTGREY, TFT_TRANSPARENT);
-            }
-            _text->drawCenterString(std::to_string(_max_strings - i).c_str(), string_w / 2, start_y + i * string_h + 1);
+                left -= 20 + 10;
         }
+        _add_element(scene,
+                     left,
+                     center_y - PITCH_CIRCLE_RADIUS,
+                     right - left + 1,
+                     2 * PITCH_CIRCLE_RADIUS + 1,
+                     element_key({offset, abs(_pitch_offset_x) > 10}));
     }
-    // Draw Note Name (Large)
-    _text->setTextColor(NOTE_TEXT_COLOR, TFT_TRANSPARENT); // Text color, background color (transparent)
-    _text->setFont(NOTE_TEXT_FONT);
-    _text->setTextSize(6);
-    // Adjust Y position slightly upwards to make space for octave
-    _text->drawCenterString(_target_note.c_str(), center_x, center_y - _text->fontHeight() / 2 - 14);
+    else
+        _add_element(scene, 0, 0, 0, 0, 0);
+
+    // The string list sits on the left edge, all of it changes with the selection
+    _canvas->setFont(NOTE_TEXT_FONT);
+    _canvas->setTextSize(1);
+    const int string_h = _canvas->fontHeight() + 2;
+    const int string_w = _canvas->textWidth("000");
+    const int all_strings_h = string_h * _max_strings;
+    _add_element(scene,
+                 0,
+                 center_y - all_strings_h / 2,
+                 string_w + 9,
+                 all_strings_h,
+                 element_key({is_draw_strings, _cur_string, _max_strings}));
+}
 
-    // Draw Octave Number (Smaller) - if valid
-    if (_target_octave >= 0)
+bool TunerUI::render()
+{
+    uint32_t current_time = millis();
+
+    bool is_draw_strings = (current_time - _strings_rendered_time < STRINGS_DISPLAY_TIME_MS) && _mode != MODE_AUTO;
+    const char* hint = control_hint;
+    if (_spectrum_view)
+        hint = control_hint_spectrum;
+    else if (_history_view)
+        hint = control_hint_history;
+    else if (_mode == MODE_STRUM)
+        hint = control_hint_strum;
+    else if (_strobe_view)
+        hint = control_hint_strobe;
+    else if (_mode == MODE_AUTO)
+        hint = control_hint_auto;
+    animateHintStep(hint);
+    if (_splash && current_time - _splash_start >= SPLASH_SHRINK_MS + SPLASH_HOLD_MS)
+        end_splash();
+
+    // Only the elements whose state changed since the last frame are redrawn,
+    // their old and new bounds make up the damage
+    UiScene scene;
+    _build_scene(scene, is_draw_strings, hint);
+    _damage.clear();
+    if (_needs_update || scene.view != _scene.view || scene.count != _scene.count)
+        _damage.add_all();
+    else
     {
-        _text->setFont(OCTAVE_TEXT_FONT);
-        _text->setTextSize(2);
-        std::string octave_str = std::to_string(_target_octave);
-        _text->drawCenterString(octave_str.c_str(), center_x, center_y + _text->fontHeight() / 2 + 8);
+        for (uint8_t i = 0; i < scene.count; i++)
+        {
+            const UiElement& was = _scene.elements[i];
+            const UiElement& now = scene.elements[i];
+            if (was.key == now.key && !memcmp(&was.rect, &now.rect, sizeof(was.rect)))
+                continue;
+            _damage.add(was.rect);
+            _damage.add(now.rect);
+        }
     }
-    // draw title
-    _text->setFont(NOTE_TEXT_FONT);
-    _text->setTextSize(1);
-    _text->setTextColor(NOTE_TEXT_COLOR, TFT_TRANSPARENT); // Text color, background color (transparent)
-    _text->drawCenterString(mode_names[_mode], center_x, 10);
+    _scene = scene;
+    _needs_update = false;
+    if (_damage.empty())
+    {
+        return false; // Nothing changed, no need to re-render
+    }
+
+    // Everything is drawn with the canvas clipped to one damaged rect at a
+    // time, draw calls outside of it cost next to nothing
+    _canvas = _hal->canvas();
+    for (size_t i = 0; i < _damage.count(); i++)
+    {
+        const UTILS::DirtyRect& rect = _damage[i];
+        _canvas->setClipRect(rect.x, rect.y, rect.w, rect.h);
+
+        _canvas->fillScreen(BACKGROUND_COLOR);
+        if (scene.view == UI_VIEW_SPLASH)
+        {
+            _render_splash(_splash_radius(current_time));
+            continue;
+        }
+        if (scene.view == UI_VIEW_SPECTRUM)
+            _render_spectrum();
+        else if (scene.view == UI_VIEW_HISTORY)
+            _render_history();
+        else if (scene.view == UI_VIEW_STRUM)
+            _render_strum();
+        else if (scene.view == UI_VIEW_STROBE)
+            _render_strobe_text();
+        else
+            _render_tuner(is_draw_strings);
+        animateHintText(hint);
+        if (scene.view == UI_VIEW_STROBE)
+            _draw_strobe_rows(current_time);
+    }
+    _canvas->clearClipRect();
+    return true; // Canvas was updated
+}
+
+void TunerUI::_render_tuner(bool is_draw_strings)
+{
+    // Calculate center positions
+    int center_x = _canvas->width() / 2;
+    int center_y = _canvas->height() / 2;
+
+    // 1. Draw the filled orange target note circle
+    // if pitch is in the range of 10 cents, draw the circle in green
+    _shapes.fill_circle(_canvas, center_x, center_y, NOTE_CIRCLE_RADIUS, TARGET_COLOR);
 
-    // 3. Draw the empty pitch circle at the calculated offset
+    // 2. Draw the empty pitch circle at the calculated offset
     if (_current_freq > 0)
     {
         int pitch_circle_center_x = center_x + static_cast<int>(_pitch_offset_x);
@@ -221,7 +756,8 @@ bool TunerUI::render()
             r = PITCH_CIRCLE_RADIUS - 2;
             if (_pitch_offset_x > 0)
             {
-                _canvas->fillTriangle(pitch_circle_center_x + PITCH_CIRCLE_RADIUS + 20,
+                _shapes.fill_triangle(_canvas,
+                                      pitch_circle_center_x + PITCH_CIRCLE_RADIUS + 20,
                                       center_y,
                                       pitch_circle_center_x + PITCH_CIRCLE_RADIUS + 20 + 10,
                                       center_y - 10,
@@ -231,7 +767,8 @@ bool TunerUI::render()
             }
             else
             {
-                _canvas->fillTriangle(pitch_circle_center_x - PITCH_CIRCLE_RADIUS - 20,
+                _shapes.fill_triangle(_canvas,
+                                      pitch_circle_center_x - PITCH_CIRCLE_RADIUS - 20,
                                       center_y,
                                       pitch_circle_center_x - PITCH_CIRCLE_RADIUS - 20 - 10,
                                       center_y - 10,
@@ -240,20 +777,72 @@ bool TunerUI::render()
                                       TFT_DARKGRAY);
             }
         }
-        _canvas->fillCircle(pitch_circle_center_x, center_y, r, color);
+        _shapes.fill_circle(_canvas, pitch_circle_center_x, center_y, r, color);
     }
-    // draw control hint
-    // _text->setFont(&fonts::efontEN_10);
-    // _text->setTextSize(1);
-    // _text->setTextColor(TFT_DARKGREY, TFT_TRANSPARENT); // Text color, background color (transparent)
-    // _text->drawCenterString(_mode == MODE_AUTO ? control_hint_auto : control_hint, center_x, _text->height() - 12);
 
-    animateHintText(_mode == MODE_AUTO ? control_hint_auto : control_hint);
-    // draw the text to the canvas
-    _text->pushSprite(_canvas, 0, 0, TFT_TRANSPARENT);
+    // 3. Text goes on top of the circles, straight from the glyph cache
+    // draw strings
+    if (is_draw_strings)
+    {
+        _canvas->setFont(NOTE_TEXT_FONT);
+        _canvas->setTextSize(1);
+        // draw strings where selected is hightlighted
+        const uint8_t string_h = _canvas->fontHeight() + 2;
+        const uint8_t string_w = _canvas->textWidth("000");
+        const uint16_t all_strings_h = string_h * _max_strings;
+        const uint16_t start_y = center_y - all_strings_h / 2;
+        for (uint8_t i = 0; i < _max_strings; i++)
+        {
+            int color = TFT_LIGHTGREY;
+            if (i == _cur_string)
+            {
+                _canvas->fillRoundRect(-8, start_y + i * string_h, string_w + 16, string_h, 4, TFT_LIGHTGREY);
+                color = TFT_BLACK;
+            }
+            else
+            {
+                _canvas->drawRoundRect(-8, start_y + i * string_h, string_w + 16, string_h, 4, TFT_LIGHTGREY);
+            }
+            _glyphs.draw(_canvas,
+                         std::to_string(_max_strings - i).c_str(),
+                         NOTE_TEXT_FONT,
+                         1,
+                         color,
+                         string_w / 2,
+                         start_y + i * string_h + 1,
+                         UTILS::GLYPH_ALIGN_CENTER);
+        }
+    }
+    // Draw Note Name (Large)
+    _canvas->setFont(NOTE_TEXT_FONT);
+    _canvas->setTextSize(6);
+    // Adjust Y position slightly upwards to make space for octave
+    _glyphs.draw(_canvas,
+                 _target_note.c_str(),
+                 NOTE_TEXT_FONT,
+                 6,
+                 NOTE_TEXT_COLOR,
+                 center_x,
+                 center_y - _canvas->fontHeight() / 2 - 14,
+                 UTILS::GLYPH_ALIGN_CENTER);
 
-    _needs_update = false; // Mark as updated
-    return true;           // Canvas was updated
+    // Draw Octave Number (Smaller) - if valid
+    if (_target_octave >= 0)
+    {
+        _canvas->setFont(OCTAVE_TEXT_FONT);
+        _canvas->setTextSize(2);
+        std::string octave_str = std::to_string(_target_octave);
+        _glyphs.draw(_canvas,
+                     octave_str.c_str(),
+                     OCTAVE_TEXT_FONT,
+                     2,
+                     NOTE_TEXT_COLOR,
+                     center_x,
+                     center_y + _canvas->fontHeight() / 2 + 8,
+                     UTILS::GLYPH_ALIGN_CENTER);
+    }
+    // draw title
+    _glyphs.draw(_canvas, mode_names[_mode], NOTE_TEXT_FONT, 1, NOTE_TEXT_COLOR, center_x, 10, UTILS::GLYPH_ALIGN_CENTER);
 }
 
 void TunerUI::animateHintReset()
@@ -263,27 +852,8 @@ void TunerUI::animateHintReset()
     hint_timeout = HINT_ANIMATION_DELAY;
 }
 
-void TunerUI::animateHintText(const char* text)
+void TunerUI::animateHintStep(const char* text)
 {
-    int y_offset = _text->height() - 12;
-
-    _text->setFont(&fonts::efontEN_10);
-    _text->setTextSize(1);
-    _text->setTextColor(TFT_SILVER, TFT_TRANSPARENT);
-    _text->drawCenterString(text, _text->width() / 2, y_offset);
-
-    if (hint_char_index >= 0)
-    {
-        char highlighted_char[2] = {text[hint_char_index], '\0'};
-        _text->setTextColor(TFT_WHITE, TFT_TRANSPARENT);
-
-        // Calculate position for the single character
-        int char_width = _text->textWidth(text);
-        int start_x = _text->width() / 2 - char_width / 2;
-        int char_pos = hint_char_index * _text->textWidth("0");
-        _text->drawString(highlighted_char, start_x + char_pos, y_offset);
-    }
-
     uint32_t now = millis();
     if ((now - hint_update_time) > hint_timeout)
     {
@@ -301,3 +871,24 @@ void TunerUI::animateHintText(const char* text)
         hint_update_time = now;
     }
 }
+
+void TunerUI::animateHintText(const char* text)
+{
+    int y_offset = _canvas->height() - 12;
+
+    _glyphs.draw(_canvas, text, &fonts::efontEN_10, 1, TFT_SILVER, _canvas->width() / 2, y_offset, UTILS::GLYPH_ALIGN_CENTER);
+
+    if (hint_char_index >= 0)
+    {
+        char highlighted_char[2] = {text[hint_char_index], '\0'};
+        _canvas->setFont(&fonts::efontEN_10);
+        _canvas->setTextSize(1);
+        _canvas->setTextColor(TFT_WHITE);
+
+        // Calculate position for the single character
+        int char_width = _canvas->textWidth(text);
+        int start_x = _canvas->width() / 2 - char_width / 2;
+        int char_pos = hint_char_index * _canvas->textWidth("0");
+        _canvas->drawString(highlighted_char, start_x + char_pos, y_offset);
+    }
+}
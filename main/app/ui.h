@@ -3,6 +3,9 @@
 #include "hal/hal.h"
 #include <string>
 #include "defines.h"
+#include "app/utils/ui/dirty_rects.h"
+#include "app/utils/ui/glyph_cache.h"
+#include "app/utils/ui/shape_cache.h"
 // Placeholder defines - adjust as needed
 #define NOTE_CIRCLE_RADIUS 60
 #define PITCH_CIRCLE_RADIUS 60
@@ -16,13 +19,79 @@
 #define BACKGROUND_COLOR TFT_BLACK
 #define NOTE_TEXT_COLOR TFT_BLACK
 #define PITCH_CIRCLE_COLOR TFT_CYAN
+#define STRUM_HOLD_TIME 3000     // A string's last reading stays on screen this long
+#define STRUM_BAR_CENTS 50.0f    // +/- cents across the half width of a strum bar
+#define STRUM_IN_TUNE_CENTS 5.0f // Bar turns green within this
+#define STRUM_ROWS_Y 28
+#define STRUM_ROW_H 16
+#define STROBE_BAND_Y 62         // Strobe rows, the only part redrawn between full frames
+#define STROBE_BAND_H 36
+#define STROBE_BAND_PERIOD 32     // Pixels per light and dark band pair, one turn of phase
+#define STROBE_FINE_RATIO 4       // The lower row turns this much faster
+#define STROBE_EXTRAPOLATE_MS 100 // Stop moving the pattern if the detector goes quiet
+#define STROBE_IN_TUNE_CENTS 1.0f
+#define SPECTRUM_BARS_Y 28        // The last row as bars
+#define SPECTRUM_BARS_H 36
+#define SPECTRUM_WATERFALL_Y 66   // Rows scroll down from here, newest on top
+#define SPECTRUM_WATERFALL_H 54
+#define SPECTRUM_HARMONICS 8      // Marks at the detected pitch and its overtones
+#define HISTORY_GRAPH_Y 34        // Pitch history graph, newest on the right. Apart from the
+#define HISTORY_GRAPH_H 80        // title and under 60% of the screen, not a full frame every column
+#define HISTORY_COLUMNS 240       // One per pixel column
+#define HISTORY_GRAPH_MS 4000     // Time across the graph
+#define HISTORY_CENTS 50.0f       // +/- cents over half of the graph height
+#define HISTORY_IN_TUNE_CENTS 5.0f
+#define HISTORY_MIN_CONFIDENCE 0.8f // Less confident detections are greyed out
+#define HISTORY_RATE_MS 500       // The update rate shown is refreshed this often
+
+#define SPLASH_RADIUS 160     // The boot circle starts this large
+#define SPLASH_SHRINK_MS 500  // and closes in on the note circle,
+#define SPLASH_HOLD_MS 1000   // then the name and build stay up, unless a note or a key ends it first
+
+#define UI_SCENE_MAX_ELEMENTS 10
+
+typedef enum : uint8_t
+{
+    UI_VIEW_TUNER = 0,
+    UI_VIEW_STRUM,
+    UI_VIEW_STROBE,
+    UI_VIEW_SPECTRUM,
+    UI_VIEW_HISTORY,
+    UI_VIEW_SPLASH,
+} UiView;
+
+// Bounds of something on screen and a hash of the state it was drawn from
+typedef struct
+{
+    UTILS::DirtyRect rect;
+    uint32_t key;
+} UiElement;
+
+// Detections that fell into one pixel column of the pitch history graph
+typedef struct
+{
+    int32_t column;     // HISTORY_GRAPH_MS / HISTORY_COLUMNS periods since boot, -1 if unused
+    int16_t low;        // Tenths of a cent
+    int16_t high;
+    uint8_t confidence; // Best of the column, 0..255
+    uint8_t count;      // Detections, saturates
+} HistoryColumn;
+
+// Elements of one frame, always in the same order for a view
+typedef struct
+{
+    UiView view;
+    uint8_t count;
+    UiElement elements[UI_SCENE_MAX_ELEMENTS];
+} UiScene;
 
 class TunerUI
 {
 private:
     HAL::Hal* _hal;
-    LGFX_Sprite* _canvas;
-    LGFX_Sprite* _text;
+    LGFX_Sprite* _canvas; // Fetched again before drawing, the HAL swaps buffers on every update
+    UTILS::GlyphCache _glyphs; // Text is blitted from here, no overlay sprite
+    UTILS::ShapeCache _shapes; // Smooth circles and arrows, rasterized once
 
     // Current state
     float _current_freq;
@@ -31,24 +100,78 @@ private:
     float _target_freq;
     float _pitch_offset_x; // Calculated offset for the pitch circle
 
-    bool _needs_update;
+    bool _needs_update; // Next frame is redrawn in full
     TunerMode _mode;
     uint8_t _max_strings;
     uint8_t _cur_string;
 
     uint32_t _strings_rendered_time;
     uint32_t _signal_lost_time;
+    StrumInfo _strum;
+    uint32_t _strum_time[STRUM_STRINGS];
+    bool _strobe_view;
+    StrobeInfo _strobe;
+    uint32_t _strobe_time;     // When _strobe arrived
+    bool _spectrum_view;
+    SpectrumLine _spectrum;         // Last row, drawn as bars
+    uint32_t _spectrum_rows;        // Rows received so far
+    lgfx::swap565_t* _waterfall;    // Ring of SPECTRUM_WATERFALL_H rows, only while the view is on
+    uint16_t _waterfall_top;        // Ring index of the newest row
+    lgfx::swap565_t _palette[256];  // Level to color, in the canvas' pixel format
+    bool _history_view;
+    HistoryColumn _history[HISTORY_COLUMNS]; // A ring, indexed by column
+    uint32_t _history_samples;               // Detections received so far
+    int64_t _history_last_us;                // Time of the newest one
+    UiScene _scene;            // What is on screen
+    UTILS::DirtyRects _damage; // Regions the last render() redrew
+    bool _splash;
+    uint32_t _splash_start;
     void _calculate_pitch_offset();
+    void _add_element(UiScene& scene, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t key);
+    void _build_scene(UiScene& scene, bool is_draw_strings, const char* hint);
+    void _render_tuner(bool is_draw_strings);
+    void _render_strum();
+    void _render_strobe_text();
+    float _strobe_cents() const;
+    void _draw_strobe_rows(uint32_t now);
+    void _render_spectrum();
+    int32_t _history_column(int64_t time_us) const;
+    int _history_rate(int32_t now_column) const;
+    void _render_history();
+    int _splash_radius(uint32_t now) const;
+    void _render_splash(int radius);
 
 public:
     TunerUI(HAL::Hal* hal);
     ~TunerUI();
 
-    void init(); // Optional initialization if needed
+    void init(); // Starts the splash, it plays in render()
+    void end_splash();
+    bool in_splash() const { return _splash; }
     void update_freq(float current_freq, const std::string& target_note, int target_octave, float target_freq);
     bool render(); // Returns true if the canvas was updated
+    // Canvas regions the last render() changed, only these need to reach the display
+    const UTILS::DirtyRects& damage() const { return _damage; }
     void update_mode(TunerMode mode);
     void update_string(uint8_t string);
+    void update_strum(const StrumInfo& info);
+    void update_strobe(const StrobeInfo& info);
+    void toggle_strobe();
+    // Redraw only the strobe rows if they are shown, the caller pushes
+    // STROBE_BAND_Y..STROBE_BAND_Y + STROBE_BAND_H to the display
+    bool render_strobe();
+    // A new row of the waterfall, its pixels are written once here and
+    // only copied to the canvas after that
+    void update_spectrum(const SpectrumLine& line);
+    void toggle_spectrum();
+    bool spectrum_view() const { return _spectrum_view; }
+    // One more detection for the pitch history graph, kept while the graph is hidden too
+    void update_history(const PitchSample& sample);
+    void toggle_history();
+    bool history_view() const { return _history_view; }
+    // Something changes on screen every frame even without new data
+    bool animating() const;
+    void animateHintStep(const char* text);
     void animateHintText(const char* text);
     void animateHintReset();
 };
\ No newline at end of file
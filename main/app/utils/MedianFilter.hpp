@@ -16,11 +16,13 @@
  *
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
-#include <vector>
-#include <numeric>
-#include <iostream>
+#if !defined(TUNER_MEDIAN_FILTER)
+#define TUNER_MEDIAN_FILTER
+
 #include <algorithm>
 
+#include "fixed_filters.hpp"
+
 #define MIN_MEDIAN_WINDOW_SIZE ((size_t)3)
 #define MAX_MEDIAN_WINDOW_SIZE ((size_t)21)
 
@@ -34,45 +36,33 @@ public:
     /// @brief Sets the window size after the class has been constructed.
     /// @param size The new window size.
     void setWindowSize(size_t size) {
-        this->windowSize = size;
-        if (this->windowSize % 2 == 0) { // Ensure the window size is odd
-            this->windowSize += 1;
+        size_t windowSize = size;
+        if (windowSize % 2 == 0) { // Ensure the window size is odd
+            windowSize += 1;
         }
-        this->windowSize = std::min(this->windowSize, MAX_MEDIAN_WINDOW_SIZE);
-        this->windowSize = std::max(this->windowSize, MIN_MEDIAN_WINDOW_SIZE);
-        this->middleIndex = this->windowSize / 2;
+        windowSize = std::min(windowSize, MAX_MEDIAN_WINDOW_SIZE);
+        windowSize = std::max(windowSize, MIN_MEDIAN_WINDOW_SIZE);
+        values.set_window(windowSize);
+        calculatedValue = -1.0f;
     }
 
     /// @brief Add a value to the smoother.
     /// @param value The new value.
     /// @return Returns the calculated value IF it's available or -1 if not available.
     float addValue(float value) {
-        // Always keep the values sorted
-        auto it = std::upper_bound(values.begin(), values.end(), value);
-        values.insert(it, value);
-        size_t size = values.size();
+        // The oldest value leaves the window, kept in arrival order next to the sorted one
+        values.push(value);
+        size_t size = values.count();
         if (useMovingMode) {
-            if (size > windowSize) {
-                values.erase(values.begin());
-                size = windowSize;
-            }
-            if (size == windowSize) {
-                // Return the middle value
-                calculatedValue = values[middleIndex];
-
-                return calculatedValue;
-            } else {
-                // Return the "middle" value of the current set
-                int tempMiddleIndex = size / 2;
-                calculatedValue = values[tempMiddleIndex];
-                return calculatedValue;
-            }
-        } else if (size == windowSize) {
+            // The middle value, or the upper middle one of a window that isn't full yet
+            calculatedValue = values.at(size / 2);
+            return calculatedValue;
+        } else if (size == values.window()) {
             // Return the middle value
-            calculatedValue = values[middleIndex];
+            calculatedValue = values.at(size / 2);
 
             // Clear all the values
-            values.clear();
+            values.reset();
 
             return calculatedValue;
         }
@@ -82,14 +72,14 @@ public:
 
     /// @brief Resets the average and prep for reuse.
     void reset() {
-        values.clear();
+        values.reset();
         calculatedValue = -1.0f;
     }
 
 private:
-    size_t windowSize;
     bool useMovingMode;
-    int middleIndex;
-    std::vector<float> values;
+    FixedMedianFilter<MAX_MEDIAN_WINDOW_SIZE> values; // Sorted and in arrival order
     float calculatedValue;
 };
+
+#endif
\ No newline at end of file
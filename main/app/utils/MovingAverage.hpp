@@ -1,3 +1,6 @@
+#if !defined(TUNER_MOVING_AVERAGE)
+#define TUNER_MOVING_AVERAGE
+
 #include <vector>
 #include <numeric>
 #include <iostream>
@@ -59,4 +62,6 @@ private:
     size_t windowSize;             // Size of the moving average window
     std::vector<float> values;     // Container to store the values
     float sum;                     // Running sum of the values
-};
\ No newline at end of file
+};
+
+#endif
\ No newline at end of file
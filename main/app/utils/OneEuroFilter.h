@@ -32,6 +32,9 @@
  *
  */
 
+#if !defined(TUNER_ONE_EURO_FILTER)
+#define TUNER_ONE_EURO_FILTER
+
 #include <iostream>
 #include <stdexcept>
 #include <cmath>
@@ -134,3 +137,5 @@ public:
 } ;
 
 // -----------------------------------------------------------------
+
+#endif
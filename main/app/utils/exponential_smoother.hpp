@@ -21,6 +21,11 @@ public:
         return smoothedValue;
     }
 
+    /// @brief FilterChain stage, the time between values doesn't matter here.
+    float filter(float newValue, float dt) {
+        return smooth(newValue);
+    }
+
     void setAlpha(float alpha) {
         _alpha = std::min(alpha, 1.0f);
         _alpha = std::max(alpha, 0.0f);
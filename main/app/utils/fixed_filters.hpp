@@ -0,0 +1,358 @@
+#if !defined(TUNER_FIXED_FILTERS)
+#define TUNER_FIXED_FILTERS
+
+//
+// Smoothing filters that never touch the heap: window sizes are template
+// parameters, all state lives in the object and the math is float only, so
+// they are safe to run per detection inside the audio task. Every stage has
+// filter(value, dt) and reset(), dt being the seconds since the value before.
+// FilterChain runs any number of them in a row.
+//
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+/// @brief Mean of the last N values from a circular buffer.
+template <size_t N> class FixedMovingAverage
+{
+    static_assert(N >= 1, "FixedMovingAverage needs a window");
+
+public:
+    FixedMovingAverage() { reset(); }
+
+    /// @return The mean of the window so far, fewer than N values at first.
+    float filter(float value, float dt = 0)
+    {
+        if (_count == N)
+            _sum -= _values[_head];
+        else
+            _count++;
+        _values[_head] = value;
+        _sum += value;
+        if (++_head == N)
+        {
+            // Summed from scratch once per lap, so float rounding in the
+            // running sum can't build up
+            _head = 0;
+            _sum = 0;
+            for (size_t i = 0; i < N; i++)
+                _sum += _values[i];
+        }
+        return _sum / _count;
+    }
+
+    float value() const { return _count ? _sum / _count : 0.0f; }
+    size_t count() const { return _count; }
+
+    void reset()
+    {
+        _head = 0;
+        _count = 0;
+        _sum = 0;
+    }
+
+private:
+    float _values[N];
+    size_t _head; // Next slot to write
+    size_t _count;
+    float _sum;
+};
+
+/// @brief Median of the last N values, or of a shorter window. The values are kept twice, in
+/// arrival order in a circular buffer to know which one leaves the window,
+/// and in sorted order in an indexable skiplist: every link stores how many
+/// positions it jumps, so the middle is found in O(log N) like the insert
+/// and the removal. The nodes are a fixed pool inside the object.
+template <size_t N> class FixedMedianFilter
+{
+    static_assert(N >= 1 && N < 254, "FixedMedianFilter window must be 1..253");
+
+    // log4(N) + 1 levels, see _random_levels()
+    static constexpr int _levels_for(size_t n) { return n <= 1 ? 1 : 1 + _levels_for((n + 3) / 4); }
+    static constexpr int LEVELS = _levels_for(N) < 8 ? _levels_for(N) : 8;
+    static constexpr uint8_t HEAD = N;     // Before the smallest value
+    static constexpr uint8_t TAIL = N + 1; // After the largest, its value is +inf
+
+public:
+    FixedMedianFilter() : _window(N), _random(0x9e3779b9) { reset(); }
+
+    /// @return The median of the window so far, NaN and infinite values are ignored.
+    float filter(float value, float dt = 0)
+    {
+        push(value);
+        return median();
+    }
+
+    /// @brief Add a value without working out the median.
+    void push(float value)
+    {
+        // +inf would sort past the TAIL sentinel
+        if (!std::isfinite(value))
+            return;
+        if (_count == _window)
+        {
+            _remove(_order[_order_head]);
+            _count--;
+        }
+        _order[_order_head] = value;
+        _order_head = _order_head + 1 == _window ? 0 : _order_head + 1;
+        _count++;
+        _insert(value);
+    }
+
+    /// @brief Shorten the window to 1..N values, starts over.
+    void set_window(size_t window)
+    {
+        _window = window < 1 ? 1 : (window > N ? N : window);
+        reset();
+    }
+
+    size_t window() const { return _window; }
+
+    /// @brief The middle value, the mean of the middle two for an even count.
+    float median() const
+    {
+        if (_count == 0)
+            return 0.0f;
+        float upper = at(_count / 2);
+        return _count & 1 ? upper : (at(_count / 2 - 1) + upper) * 0.5f;
+    }
+
+    /// @brief The i-th smallest value in the window, 0 .. count() - 1.
+    float at(size_t i) const
+    {
+        // Positions count from 1, the head is position 0
+        size_t left = i + 1;
+        uint8_t node = HEAD;
+        for (int level = LEVELS - 1; level >= 0; level--)
+        {
+            while (_nodes[node].width[level] <= left)
+            {
+                left -= _nodes[node].width[level];
+                node = _nodes[node].next[level];
+            }
+        }
+        return _nodes[node].value;
+    }
+
+    size_t count() const { return _count; }
+
+    void reset()
+    {
+        _count = 0;
+        _order_head = 0;
+        for (int level = 0; level < LEVELS; level++)
+        {
+            _nodes[HEAD].next[level] = TAIL;
+            _nodes[HEAD].width[level] = 1;
+        }
+        _nodes[HEAD].levels = LEVELS;
+        _nodes[TAIL].value = INFINITY;
+        _free_count = N;
+        for (size_t i = 0; i < N; i++)
+            _free[i] = (uint8_t)i;
+    }
+
+private:
+    typedef struct
+    {
+        float value;
+        uint8_t levels;
+        uint8_t next[LEVELS];
+        uint8_t width[LEVELS]; // Positions the link jumps over, the target included
+    } Node;
+
+    void _insert(float value)
+    {
+        // The last node before the new one on each level, and how far along it is
+        uint8_t chain[LEVELS];
+        size_t steps[LEVELS];
+        uint8_t node = HEAD;
+        for (int level = LEVELS - 1; level >= 0; level--)
+        {
+            steps[level] = 0;
+            while (_nodes[_nodes[node].next[level]].value <= value)
+            {
+                steps[level] += _nodes[node].width[level];
+                node = _nodes[node].next[level];
+            }
+            chain[level] = node;
+        }
+        uint8_t fresh = _free[--_free_count];
+        Node& added = _nodes[fresh];
+        added.value = value;
+        added.levels = _random_levels();
+        size_t behind = 0; // Positions between chain[level] and the new node
+        for (int level = 0; level < added.levels; level++)
+        {
+            Node& prev = _nodes[chain[level]];
+            added.next[level] = prev.next[level];
+            added.width[level] = (uint8_t)(prev.width[level] - behind);
+            prev.next[level] = fresh;
+            prev.width[level] = (uint8_t)(behind + 1);
+            behind += steps[level];
+        }
+        for (int level = added.levels; level < LEVELS; level++)
+            _nodes[chain[level]].width[level]++;
+    }
+
+    void _remove(float value)
+    {
+        uint8_t chain[LEVELS];
+        uint8_t node = HEAD;
+        for (int level = LEVELS - 1; level >= 0; level--)
+        {
+            while (_nodes[_nodes[node].next[level]].value < value)
+                node = _nodes[node].next[level];
+            chain[level] = node;
+        }
+        // Any node with an equal value will do, they can't be told apart
+        uint8_t gone = _nodes[chain[0]].next[0];
+        const Node& removed = _nodes[gone];
+        for (int level = 0; level < removed.levels; level++)
+        {
+            Node& prev = _nodes[chain[level]];
+            prev.width[level] = (uint8_t)(prev.width[level] + removed.width[level] - 1);
+            prev.next[level] = removed.next[level];
+        }
+        for (int level = removed.levels; level < LEVELS; level++)
+            _nodes[chain[level]].width[level]--;
+        _free[_free_count++] = gone;
+    }
+
+    /// @brief Levels of a new node from a xorshift: a quarter of the nodes get
+    /// a second level, a sixteenth a third and so on. Fewer levels than the
+    /// textbook one half, which is quicker for windows this short.
+    uint8_t _random_levels()
+    {
+        _random ^= _random << 13;
+        _random ^= _random >> 17;
+        _random ^= _random << 5;
+        uint8_t levels = 1;
+        for (uint32_t bits = _random; (bits & 3) == 3 && levels < LEVELS; bits >>= 2)
+            levels++;
+        return levels;
+    }
+
+    Node _nodes[N + 2];
+    uint8_t _free[N];
+    size_t _free_count;
+    float _order[N]; // Arrival order, the oldest at _order_head once full
+    size_t _order_head;
+    size_t _count;
+    size_t _window; // Values in the median, up to N
+    uint32_t _random;
+};
+
+/// @brief Outlier rejection for frequencies: a value more than `max_cents`
+/// away from the median of the last N is replaced by that median, anything
+/// else passes untouched. The median itself isn't smooth enough to follow a
+/// note within a cent, but it is a good reference for what the note is.
+template <size_t N> class FixedOutlierFilter
+{
+public:
+    explicit FixedOutlierFilter(float max_cents) : _max_ratio(exp2f(max_cents / 1200.0f)) {}
+
+    float filter(float value, float dt = 0)
+    {
+        _median.push(value);
+        return accepts(value) ? value : _median.median();
+    }
+
+    /// @brief false if `value` is further from the median than the gate allows.
+    bool accepts(float value) const
+    {
+        // Nothing to compare against until the window is half full
+        if (_median.count() <= N / 2)
+            return true;
+        float median = _median.median();
+        return !(value > median * _max_ratio || value * _max_ratio < median);
+    }
+
+    void reset() { _median.reset(); }
+
+private:
+    float _max_ratio;
+    FixedMedianFilter<N> _median;
+};
+
+/// @brief The 1€ filter (Casiez, Roussel, Vogel) in float with the state
+/// inline, a low pass whose cutoff rises with the speed of the signal.
+class FixedOneEuroFilter
+{
+public:
+    /// @param rate Expected values per second, only used until the first dt.
+    FixedOneEuroFilter(float rate, float min_cutoff, float beta, float derivative_cutoff)
+        : _dt(1.0f / rate), _min_cutoff(min_cutoff > 0 ? min_cutoff : 1.0f), _beta(beta),
+          _derivative_cutoff(derivative_cutoff > 0 ? derivative_cutoff : 1.0f)
+    {
+        reset();
+    }
+
+    float filter(float value, float dt)
+    {
+        if (dt > 0)
+            _dt = dt;
+        if (!_initialized)
+        {
+            _initialized = true;
+            _value = value;
+            _derivative = 0;
+            return value;
+        }
+        _derivative += _alpha(_derivative_cutoff) * ((value - _value) / _dt - _derivative);
+        float cutoff = _min_cutoff + _beta * fabsf(_derivative);
+        _value += _alpha(cutoff) * (value - _value);
+        return _value;
+    }
+
+    void reset() { _initialized = false; }
+
+private:
+    /// @brief Smoothing factor of a first order low pass at `cutoff` Hz
+    float _alpha(float cutoff) const
+    {
+        float tau = 1.0f / (2.0f * (float)M_PI * cutoff);
+        return _dt / (_dt + tau);
+    }
+
+    float _dt;
+    float _min_cutoff;
+    float _beta;
+    float _derivative_cutoff;
+    bool _initialized;
+    float _value;      // Last filtered value
+    float _derivative; // Filtered speed of the value, per second
+};
+
+/// @brief Stages run one after the other, each gets the output of the one before.
+/// Stages are held by value, anything with filter(float, float) and reset() fits.
+template <typename... Stages> class FilterChain
+{
+public:
+    explicit FilterChain(const Stages&... stages) : _stages(stages...) {}
+
+    float filter(float value, float dt) { return _filter<0>(value, dt); }
+
+    /// @brief Reset every stage, stage<I>().reset() for some of them.
+    void reset() { std::apply([](Stages&... stage) { (stage.reset(), ...); }, _stages); }
+
+    template <size_t I> auto& stage() { return std::get<I>(_stages); }
+
+    static constexpr size_t size() { return sizeof...(Stages); }
+
+private:
+    template <size_t I> float _filter(float value, float dt)
+    {
+        if constexpr (I == sizeof...(Stages))
+            return value;
+        else
+            return _filter<I + 1>(std::get<I>(_stages).filter(value, dt), dt);
+    }
+
+    std::tuple<Stages...> _stages;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#if !defined(TUNER_POW2_HISTOGRAM)
+#define TUNER_POW2_HISTOGRAM
+
+//
+// Percentiles of a power of two histogram: bucket 0 holds values below
+// `first`, bucket i values below first << i, the last bucket is open. Used
+// by the GUI's frame times and the detector task's DSP profile, which fill
+// their buckets differently but read them the same way.
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Upper bound of the bucket holding the given percentile of `count`
+/// values, capped at `max`, which is also the answer for the open bucket.
+static inline uint32_t pow2_percentile(const uint32_t* buckets,
+                                       size_t bucket_count,
+                                       uint32_t count,
+                                       uint32_t first,
+                                       uint32_t max,
+                                       uint8_t percent)
+{
+    if (count == 0)
+        return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+    uint32_t seen = 0;
+    for (size_t i = 0; i + 1 < bucket_count; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(first << i, max);
+    }
+    return max;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#if !defined(TUNER_SPSC_RING)
+#define TUNER_SPSC_RING
+
+//
+// Lock-free ring for exactly one producer and one consumer task. The
+// producer owns _head, the consumer owns _tail; each only reads the other's
+// index, with acquire/release ordering so the item is written before the
+// index that publishes it. No FreeRTOS calls, nothing blocks: a full ring
+// drops the new item and counts it.
+//
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T, size_t N> class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing length must be a power of two");
+
+public:
+    SpscRing() : _head(0), _tail(0), _dropped(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// @brief Producer: append an item.
+    /// @return false if the ring was full, the item is dropped.
+    bool push(const T& item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= N)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Consumer: take the oldest item.
+    /// @return false if the ring was empty.
+    bool pop(T& item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        item = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Items waiting, exact from the consumer, a lower bound from the producer.
+    size_t size() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+
+    /// @brief Items pushed into a full ring so far.
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T _items[N];
+    // Free running, only the low bits index _items
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+    std::atomic<uint32_t> _dropped;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file dirty_rects.cpp
+ * @brief Screen regions that changed since the last frame
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "dirty_rects.h"
+
+#include <algorithm>
+
+namespace UTILS
+{
+    static DirtyRect bounds_of(const DirtyRect& a, const DirtyRect& b)
+    {
+        int32_t x = std::min(a.x, b.x);
+        int32_t y = std::min(a.y, b.y);
+        int32_t r = std::max(a.x + a.w, b.x + b.w);
+        int32_t bottom = std::max(a.y + a.h, b.y + b.h);
+        return {x, y, r - x, bottom - y};
+    }
+
+    static bool touches(const DirtyRect& a, const DirtyRect& b)
+    {
+        return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+    }
+
+    DirtyRects::DirtyRects(int32_t width, int32_t height) : _width(width), _height(height), _count(0) {}
+
+    void DirtyRects::add(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        // Clip to the screen
+        int32_t r = std::min(x + w, _width);
+        int32_t b = std::min(y + h, _height);
+        x = std::max(x, (int32_t)0);
+        y = std::max(y, (int32_t)0);
+        if (r <= x || b <= y)
+            return;
+        DirtyRect rect = {x, y, r - x, b - y};
+
+        // Swallow every rect the new one touches, the result may touch others again
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (size_t i = 0; i < _count; i++)
+            {
+                if (!touches(rect, _rects[i]))
+                    continue;
+                rect = bounds_of(rect, _rects[i]);
+                _rects[i] = _rects[--_count];
+                merged = true;
+                break;
+            }
+        }
+
+        if (_count == DIRTY_RECTS_MAX)
+        {
+            // Out of slots, grow the rect that needs the fewest extra pixels
+            size_t best = 0;
+            int32_t best_growth = INT32_MAX;
+            for (size_t i = 0; i < _count; i++)
+            {
+                DirtyRect u = bounds_of(rect, _rects[i]);
+                int32_t growth = u.w * u.h - _rects[i].w * _rects[i].h;
+                if (growth < best_growth)
+                {
+                    best_growth = growth;
+                    best = i;
+                }
+            }
+            rect = bounds_of(rect, _rects[best]);
+            _rects[best] = _rects[--_count];
+            add(rect);
+            return;
+        }
+        _rects[_count++] = rect;
+
+        if (area() * 100 >= _width * _height * DIRTY_RECTS_FULL_PERCENT)
+            add_all();
+    }
+
+    void DirtyRects::add_all()
+    {
+        _rects[0] = {0, 0, _width, _height};
+        _count = 1;
+    }
+
+    bool DirtyRects::full() const { return _count == 1 && _rects[0].w == _width && _rects[0].h == _height; }
+
+    int32_t DirtyRects::area() const
+    {
+        int32_t total = 0;
+        for (size_t i = 0; i < _count; i++)
+            total += _rects[i].w * _rects[i].h;
+        return total;
+    }
+} // namespace UTILS
@@ -0,0 +1,67 @@
+/**
+ * @file dirty_rects.h
+ * @brief Screen regions that changed since the last frame
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Few and large beats many and small, every rect is a separate SPI window
+#define DIRTY_RECTS_MAX 4
+// Once the rects cover this much of the screen a single full frame is cheaper
+#define DIRTY_RECTS_FULL_PERCENT 60
+
+namespace UTILS
+{
+    typedef struct
+    {
+        int32_t x;
+        int32_t y;
+        int32_t w;
+        int32_t h;
+    } DirtyRect;
+
+    /**
+     * @brief Damage list of a frame, overlapping rects are merged as they are added
+     */
+    class DirtyRects
+    {
+    public:
+        DirtyRects(int32_t width, int32_t height);
+
+        void clear() { _count = 0; }
+
+        /**
+         * @brief Mark a region, clipped to the screen. Empty regions are ignored
+         */
+        void add(int32_t x, int32_t y, int32_t w, int32_t h);
+        void add(const DirtyRect& rect) { add(rect.x, rect.y, rect.w, rect.h); }
+
+        /**
+         * @brief Mark the whole screen
+         */
+        void add_all();
+
+        bool empty() const { return _count == 0; }
+        bool full() const;
+        size_t count() const { return _count; }
+        const DirtyRect& operator[](size_t i) const { return _rects[i]; }
+
+        /**
+         * @brief Pixels covered, rects never overlap
+         */
+        int32_t area() const;
+
+    private:
+        int32_t _width;
+        int32_t _height;
+        DirtyRect _rects[DIRTY_RECTS_MAX];
+        size_t _count;
+    };
+} // namespace UTILS
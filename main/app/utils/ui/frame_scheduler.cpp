@@ -0,0 +1,158 @@
+/**
+ * @file frame_scheduler.cpp
+ * @brief Paces the GUI loop to a frame period and keeps frame time statistics
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "../pow2_histogram.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace UTILS
+{
+    void FrameHistogram::clear()
+    {
+        std::fill(_buckets, _buckets + FRAME_HISTOGRAM_BUCKETS, 0);
+        _count = 0;
+        _max = 0;
+        _sum = 0;
+    }
+
+    void FrameHistogram::add(uint32_t us)
+    {
+        size_t i = 0;
+        while (i < FRAME_HISTOGRAM_BUCKETS - 1 && us >= bucket_limit(i))
+            i++;
+        _buckets[i]++;
+        _count++;
+        _sum += us;
+        _max = std::max(_max, us);
+    }
+
+    uint32_t FrameHistogram::percentile(uint8_t percent) const
+    {
+        return pow2_percentile(_buckets, FRAME_HISTOGRAM_BUCKETS, _count, FRAME_HISTOGRAM_FIRST_US, _max, percent);
+    }
+
+    FrameScheduler::FrameScheduler(uint32_t period_ms, uint32_t idle_ms)
+        : _period_us((int64_t)period_ms * 1000), _idle_ms(idle_ms),
+          _deadline(esp_timer_get_time()), _mark(0), _log_time(esp_timer_get_time()), _frames(0), _missed(0),
+          _idle_wakes(0)
+    {
+    }
+
+    void FrameScheduler::set_period(uint32_t period_ms) { _period_us = (int64_t)std::max<uint32_t>(period_ms, 1) * 1000; }
+
+    static void sleep_until(int64_t time)
+    {
+        int64_t left = time - esp_timer_get_time();
+        if (left > 0)
+            vTaskDelay(std::max<TickType_t>(1, pdMS_TO_TICKS((left + 999) / 1000)));
+    }
+
+    void FrameScheduler::wait(bool animating)
+    {
+        if (!animating)
+        {
+            // Nothing moves on its own, only new data or the idle timeout start a frame
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(_idle_ms)) == 0)
+            {
+                _deadline = esp_timer_get_time();
+                return;
+            }
+            _idle_wakes++;
+        }
+
+        int64_t next = _deadline + _period_us;
+        int64_t now = esp_timer_get_time();
+        if (now < next)
+        {
+            // Data that arrives in between is picked up by this frame
+            sleep_until(next);
+            _deadline = next;
+        }
+        else
+        {
+            // Late: start right away on the tick just passed, the ones in between are lost
+            int64_t late = (now - next) / _period_us;
+            if (animating)
+                _missed += (uint32_t)late + 1;
+            _deadline = next + late * _period_us;
+        }
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+
+    void FrameScheduler::render_begin() { _mark = esp_timer_get_time(); }
+
+    void FrameScheduler::render_end(bool drawn)
+    {
+        if (!drawn)
+            return;
+        _render.add((uint32_t)(esp_timer_get_time() - _mark));
+        _frames++;
+    }
+
+    void FrameScheduler::flush_begin() { _mark = esp_timer_get_time(); }
+
+    void FrameScheduler::flush_end() { _flush.add((uint32_t)(esp_timer_get_time() - _mark)); }
+
+    void FrameScheduler::clear_stats()
+    {
+        _render.clear();
+        _flush.clear();
+        _send.clear();
+        _frames = 0;
+        _missed = 0;
+        _idle_wakes = 0;
+    }
+
+    static void log_histogram(const char* tag, const char* name, const FrameHistogram& h)
+    {
+        char buckets[FRAME_HISTOGRAM_BUCKETS * 11 + 1];
+        size_t len = 0;
+        for (size_t i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+            len += snprintf(buckets + len, sizeof(buckets) - len, " %" PRIu32, h.bucket(i));
+        ESP_LOGI(tag,
+                 "%-6s n %" PRIu32 " mean %" PRIu32 " p50 %" PRIu32 " p95 %" PRIu32 " max %" PRIu32 " us |%s",
+                 name,
+                 h.count(),
+                 h.mean(),
+                 h.percentile(50),
+                 h.percentile(95),
+                 h.max(),
+                 buckets);
+    }
+
+    void FrameScheduler::log(const char* tag, uint32_t interval_ms)
+    {
+        int64_t now = esp_timer_get_time();
+        if (interval_ms == 0 || now - _log_time < (int64_t)interval_ms * 1000)
+            return;
+        uint32_t seconds = std::max<uint32_t>(1, (uint32_t)((now - _log_time) / 1000000));
+        ESP_LOGI(tag,
+                 "%" PRIu32 " frames in %" PRIu32 " s, %" PRIu32 " ticks missed, %" PRIu32 " woken by data, period %" PRIu32
+                 " ms. Buckets from <%d us, doubling",
+                 _frames,
+                 seconds,
+                 _missed,
+                 _idle_wakes,
+                 period(),
+                 FRAME_HISTOGRAM_FIRST_US);
+        log_histogram(tag, "render", _render);
+        log_histogram(tag, "flush", _flush);
+        log_histogram(tag, "send", _send);
+        clear_stats();
+        _log_time = now;
+    }
+} // namespace UTILS
@@ -0,0 +1,108 @@
+/**
+ * @file frame_scheduler.h
+ * @brief Paces the GUI loop to a frame period and keeps frame time statistics
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Bucket 0 is below FRAME_HISTOGRAM_FIRST_US, each next one is twice as wide, the last is open
+#define FRAME_HISTOGRAM_BUCKETS 12
+#define FRAME_HISTOGRAM_FIRST_US 64
+
+namespace UTILS
+{
+    /**
+     * @brief Power of two histogram of durations in microseconds
+     */
+    class FrameHistogram
+    {
+    public:
+        FrameHistogram() { clear(); }
+
+        void clear();
+        void add(uint32_t us);
+
+        uint32_t count() const { return _count; }
+        uint32_t max() const { return _max; }
+        uint32_t mean() const { return _count ? (uint32_t)(_sum / _count) : 0; }
+        /**
+         * @brief Upper bound of the bucket holding the given percentile, max() for the open one
+         */
+        uint32_t percentile(uint8_t percent) const;
+        uint32_t bucket(size_t i) const { return _buckets[i]; }
+        static uint32_t bucket_limit(size_t i) { return (uint32_t)FRAME_HISTOGRAM_FIRST_US << i; }
+
+    private:
+        uint32_t _buckets[FRAME_HISTOGRAM_BUCKETS];
+        uint32_t _count;
+        uint32_t _max;
+        uint64_t _sum;
+    };
+
+    /**
+     * @brief vsync-like pacing for a loop that polls, renders and flushes
+     *
+     * While something animates, frames start on a fixed grid of period_ms
+     * ticks and a frame that overruns skips to the next tick instead of
+     * bunching up. Otherwise the task sleeps until it gets a task notification
+     * (xTaskNotifyGive from the pitch detector on new data) or idle_ms passes,
+     * so input is still polled. A notification right after a frame is held
+     * back to the next tick, several of them make one frame.
+     */
+    class FrameScheduler
+    {
+    public:
+        FrameScheduler(uint32_t period_ms, uint32_t idle_ms);
+
+        void set_period(uint32_t period_ms);
+        uint32_t period() const { return (uint32_t)(_period_us / 1000); }
+
+        /**
+         * @brief Sleep until the next frame is due, from the task that renders
+         * @param animating Something has to be drawn on the next tick regardless of new data
+         */
+        void wait(bool animating);
+
+        // Around the parts of a frame, for the statistics
+        void render_begin();
+        void render_end(bool drawn);
+        void flush_begin();
+        void flush_end();
+        // Time the display took to send the frame, measured elsewhere
+        void add_send_time(uint32_t us) { _send.add(us); }
+
+        const FrameHistogram& render_time() const { return _render; }
+        const FrameHistogram& flush_time() const { return _flush; }
+        const FrameHistogram& send_time() const { return _send; }
+        uint32_t frames() const { return _frames; }
+        uint32_t missed() const { return _missed; }
+        uint32_t idle_wakes() const { return _idle_wakes; }
+
+        /**
+         * @brief Print the statistics every interval_ms and start over, call once a frame
+         */
+        void log(const char* tag, uint32_t interval_ms);
+        void clear_stats();
+
+    private:
+        int64_t _period_us;
+        uint32_t _idle_ms;
+        int64_t _deadline;  // Tick the last frame started on
+        int64_t _mark;      // Start of the part of a frame being timed
+        int64_t _log_time;
+
+        FrameHistogram _render;
+        FrameHistogram _flush;
+        FrameHistogram _send;
+        uint32_t _frames;     // Frames that drew something
+        uint32_t _missed;     // Ticks a frame didn't start on because the one before ran late
+        uint32_t _idle_wakes; // Frames started by wake() out of idle
+    };
+} // namespace UTILS
@@ -0,0 +1,130 @@
+/**
+ * @file glyph_cache.cpp
+ * @brief Pre-rasterized text for the strings the UI draws over and over
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "glyph_cache.h"
+
+#include <cstring>
+
+namespace UTILS
+{
+    static uint32_t text_key(const char* text)
+    {
+        uint32_t key = 2166136261u;
+        while (*text)
+            key = (key ^ static_cast<uint8_t>(*text++)) * 16777619u;
+        return key;
+    }
+
+    GlyphCache::GlyphCache(lgfx::LovyanGFX* parent) : _parent(parent), _clock(0), _hits(0), _misses(0)
+    {
+        memset(_entries, 0, sizeof(_entries));
+    }
+
+    GlyphCache::~GlyphCache() { clear(); }
+
+    void GlyphCache::clear()
+    {
+        for (size_t i = 0; i < GLYPH_CACHE_ENTRIES; i++)
+        {
+            if (_entries[i].sprite)
+            {
+                _entries[i].sprite->deleteSprite();
+                delete _entries[i].sprite;
+            }
+        }
+        memset(_entries, 0, sizeof(_entries));
+    }
+
+    GlyphCache::Entry* GlyphCache::_find(const char* text, const lgfx::IFont* font, float size)
+    {
+        uint32_t key = text_key(text);
+        Entry* victim = &_entries[0];
+        for (size_t i = 0; i < GLYPH_CACHE_ENTRIES; i++)
+        {
+            Entry& e = _entries[i];
+            if (e.sprite && e.key == key && e.font == font && e.size == size && strcmp(e.text, text) == 0)
+            {
+                _hits++;
+                e.last_used = ++_clock;
+                return &e;
+            }
+            // Free slots first, then the least recently used one
+            if (victim->sprite && (!e.sprite || e.last_used < victim->last_used))
+                victim = &e;
+        }
+
+        _misses++;
+        if (victim->sprite == nullptr)
+            victim->sprite = new LGFX_Sprite(_parent);
+        LGFX_Sprite* sprite = victim->sprite;
+        sprite->deleteSprite();
+        sprite->setColorDepth(1);
+        sprite->setFont(font);
+        sprite->setTextSize(size);
+        int32_t w = sprite->textWidth(text);
+        int32_t h = sprite->fontHeight();
+        if (w <= 0 || sprite->createSprite(w, h) == nullptr)
+        {
+            delete sprite;
+            victim->sprite = nullptr;
+            return nullptr;
+        }
+        sprite->createPalette();
+        sprite->fillScreen(0);
+        sprite->setTextColor(1);
+        sprite->drawString(text, 0, 0);
+
+        victim->key = key;
+        strcpy(victim->text, text);
+        victim->font = font;
+        victim->size = size;
+        victim->last_used = ++_clock;
+        return victim;
+    }
+
+    int32_t GlyphCache::draw(lgfx::LovyanGFX* dst,
+                             const char* text,
+                             const lgfx::IFont* font,
+                             float size,
+                             int color,
+                             int32_t x,
+                             int32_t y,
+                             GlyphAlign align)
+    {
+        if (text == nullptr || *text == '\0')
+            return 0;
+        if (strlen(text) >= GLYPH_TEXT_MAX)
+        {
+            // Too long to keep, drawn like drawString would
+            dst->setFont(font);
+            dst->setTextSize(size);
+            dst->setTextColor(color);
+            int32_t w = dst->textWidth(text);
+            if (align == GLYPH_ALIGN_CENTER)
+                x -= w / 2;
+            else if (align == GLYPH_ALIGN_RIGHT)
+                x -= w;
+            dst->drawString(text, x, y);
+            return w;
+        }
+        Entry* e = _find(text, font, size);
+        if (e == nullptr)
+            return 0;
+
+        int32_t w = e->sprite->width();
+        if (align == GLYPH_ALIGN_CENTER)
+            x -= w / 2;
+        else if (align == GLYPH_ALIGN_RIGHT)
+            x -= w;
+        // Only the set pixels are written, palette index 0 is transparent
+        e->sprite->setPaletteColor(1, color);
+        e->sprite->pushSprite(dst, x, y, 0);
+        return w;
+    }
+} // namespace UTILS
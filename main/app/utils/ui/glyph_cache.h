@@ -0,0 +1,87 @@
+/**
+ * @file glyph_cache.h
+ * @brief Pre-rasterized text for the strings the UI draws over and over
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lgfx/v1/LGFX_Sprite.hpp"
+
+// Note names, octaves, mode names, hints, string labels: a few dozen distinct strings
+#define GLYPH_CACHE_ENTRIES 32
+// Longest cached text plus its terminator, the hints are about 40 characters.
+// Longer text is drawn directly.
+#define GLYPH_TEXT_MAX 48
+
+namespace UTILS
+{
+    typedef enum
+    {
+        GLYPH_ALIGN_LEFT = 0,
+        GLYPH_ALIGN_CENTER,
+        GLYPH_ALIGN_RIGHT,
+    } GlyphAlign;
+
+    /**
+     * @brief Text rendered once into 1-bit sprites, then blitted in any color
+     *
+     * Each entry is as large as its text, the palette's index 0 is the
+     * transparent background and index 1 is recolored before every blit.
+     * The least recently used entry is replaced when the cache is full, text
+     * that changes every frame (numbers) is better drawn directly.
+     */
+    class GlyphCache
+    {
+    public:
+        explicit GlyphCache(lgfx::LovyanGFX* parent);
+        ~GlyphCache();
+
+        GlyphCache(const GlyphCache&) = delete;
+        GlyphCache& operator=(const GlyphCache&) = delete;
+
+        /**
+         * @brief Draw text onto dst, y is the top of the text like drawString
+         *
+         * @return Width of the text in pixels
+         */
+        int32_t draw(lgfx::LovyanGFX* dst,
+                     const char* text,
+                     const lgfx::IFont* font,
+                     float size,
+                     int color, // RGB565 like the TFT_ colors
+                     int32_t x,
+                     int32_t y,
+                     GlyphAlign align = GLYPH_ALIGN_LEFT);
+
+        void clear();
+
+        size_t hits() const { return _hits; }
+        size_t misses() const { return _misses; }
+
+    private:
+        typedef struct
+        {
+            uint32_t key; // Hash of text, compared first
+            char text[GLYPH_TEXT_MAX];
+            const lgfx::IFont* font;
+            float size;
+            uint32_t last_used;
+            LGFX_Sprite* sprite;
+        } Entry;
+
+        Entry* _find(const char* text, const lgfx::IFont* font, float size);
+
+        lgfx::LovyanGFX* _parent;
+        Entry _entries[GLYPH_CACHE_ENTRIES];
+        uint32_t _clock;
+        size_t _hits;
+        size_t _misses;
+    };
+} // namespace UTILS
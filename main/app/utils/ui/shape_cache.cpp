@@ -0,0 +1,228 @@
+/**
+ * @file shape_cache.cpp
+ * @brief Anti-aliased circles and triangles, rasterized once and blitted as row spans
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "shape_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace UTILS
+{
+    static uint32_t shape_key(char kind, const int32_t* geometry)
+    {
+        uint32_t key = (2166136261u ^ static_cast<uint32_t>(kind)) * 16777619u;
+        for (int i = 0; i < 6; i++)
+            key = (key ^ static_cast<uint32_t>(geometry[i])) * 16777619u;
+        return key;
+    }
+
+    // Signed distance from a pixel center to the outline, negative inside.
+    // Outlines sit half a pixel out so the shapes cover what fillCircle and
+    // fillTriangle would.
+
+    static float circle_distance(float x, float y, const float* params)
+    {
+        // params: center, radius
+        return std::hypot(x - params[0], y - params[1]) - params[2] - 0.5f;
+    }
+
+    static float triangle_distance(float x, float y, const float* params)
+    {
+        // params: three vertices, winding of the triangle
+        float d = -INFINITY;
+        for (int i = 0; i < 3; i++)
+        {
+            float ax = params[2 * i], ay = params[2 * i + 1];
+            float bx = params[(2 * i + 2) % 6], by = params[(2 * i + 3) % 6];
+            float cross = (bx - ax) * (y - ay) - (by - ay) * (x - ax);
+            d = std::max(d, -params[6] * cross / std::hypot(bx - ax, by - ay));
+        }
+        return d - 0.5f;
+    }
+
+    // RGB565 in the sprite's byte order
+    static inline uint16_t swap565(uint16_t c) { return static_cast<uint16_t>((c << 8) | (c >> 8)); }
+
+    static inline uint16_t blend565(uint16_t fg, uint16_t bg, uint8_t alpha)
+    {
+        int a = alpha;
+        int r = ((bg >> 11) * (255 - a) + (fg >> 11) * a + 127) / 255;
+        int g = (((bg >> 5) & 0x3F) * (255 - a) + ((fg >> 5) & 0x3F) * a + 127) / 255;
+        int b = ((bg & 0x1F) * (255 - a) + (fg & 0x1F) * a + 127) / 255;
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    ShapeCache::ShapeCache() : _clock(0), _hits(0), _misses(0) { memset(_shapes, 0, sizeof(_shapes)); }
+
+    ShapeCache::~ShapeCache() { clear(); }
+
+    void ShapeCache::clear()
+    {
+        for (size_t i = 0; i < SHAPE_CACHE_ENTRIES; i++)
+        {
+            delete[] _shapes[i].rows;
+            delete[] _shapes[i].coverage;
+        }
+        memset(_shapes, 0, sizeof(_shapes));
+    }
+
+    ShapeCache::Shape* ShapeCache::_find(uint32_t key,
+                                         const int32_t* geometry,
+                                         int32_t width,
+                                         int32_t height,
+                                         Distance distance,
+                                         const float* params)
+    {
+        Shape* victim = &_shapes[0];
+        for (size_t i = 0; i < SHAPE_CACHE_ENTRIES; i++)
+        {
+            Shape& s = _shapes[i];
+            if (s.rows && s.key == key && s.distance == distance && memcmp(s.geometry, geometry, sizeof(s.geometry)) == 0)
+            {
+                _hits++;
+                s.last_used = ++_clock;
+                return &s;
+            }
+            // Free slots first, then the least recently used one
+            if (victim->rows && (!s.rows || s.last_used < victim->last_used))
+                victim = &s;
+        }
+
+        _misses++;
+        delete[] victim->rows;
+        delete[] victim->coverage;
+        memset(victim, 0, sizeof(*victim));
+
+        // One row of coverage at a time, only the edges are kept
+        Row* rows = new Row[height];
+        std::vector<uint8_t> line(width);
+        std::vector<uint8_t> edges;
+        for (int32_t y = 0; y < height; y++)
+        {
+            for (int32_t x = 0; x < width; x++)
+            {
+                float c = std::clamp(0.5f - distance(x + 0.5f, y + 0.5f, params), 0.0f, 1.0f);
+                line[x] = static_cast<uint8_t>(c * 255 + 0.5f);
+            }
+            Row& row = rows[y];
+            row.left = row.right = row.solid_begin = row.solid_end = 0;
+            row.coverage = static_cast<uint16_t>(edges.size());
+            int32_t left = 0;
+            while (left < width && line[left] == 0)
+                left++;
+            if (left == width)
+                continue;
+            int32_t right = width;
+            while (line[right - 1] == 0)
+                right--;
+            int32_t solid_begin = left;
+            while (solid_begin < right && line[solid_begin] != 255)
+                solid_begin++;
+            int32_t solid_end = right;
+            while (solid_end > solid_begin && line[solid_end - 1] != 255)
+                solid_end--;
+            if (solid_begin == right)
+                solid_end = right; // No full pixel, the whole row is one edge
+            row.left = left;
+            row.solid_begin = solid_begin;
+            row.solid_end = solid_end;
+            row.right = right;
+            edges.insert(edges.end(), line.begin() + left, line.begin() + solid_begin);
+            edges.insert(edges.end(), line.begin() + solid_end, line.begin() + right);
+        }
+
+        victim->key = key;
+        victim->distance = distance;
+        memcpy(victim->geometry, geometry, sizeof(victim->geometry));
+        victim->width = width;
+        victim->height = height;
+        victim->last_used = ++_clock;
+        victim->rows = rows;
+        victim->coverage = new uint8_t[std::max<size_t>(edges.size(), 1)];
+        std::copy(edges.begin(), edges.end(), victim->coverage);
+        return victim;
+    }
+
+    void ShapeCache::_blit(LGFX_Sprite* dst, const Shape* shape, int32_t x, int32_t y, int color)
+    {
+        int32_t clip_x, clip_y, clip_w, clip_h;
+        dst->getClipRect(&clip_x, &clip_y, &clip_w, &clip_h);
+        const int32_t clip_right = clip_x + clip_w;
+        const int32_t stride = dst->width();
+        uint16_t* pixels = static_cast<uint16_t*>(dst->getBuffer());
+        const uint16_t fg = static_cast<uint16_t>(color);
+        const uint16_t fg_swapped = swap565(fg);
+
+        int32_t first = std::max(0, clip_y - y);
+        int32_t last = std::min(shape->height, clip_y + clip_h - y);
+        for (int32_t i = first; i < last; i++)
+        {
+            const Row& row = shape->rows[i];
+            uint16_t* line = pixels + (y + i) * stride;
+            const uint8_t* coverage = shape->coverage + row.coverage;
+            auto blend = [&](int32_t px, uint8_t alpha)
+            {
+                if (px >= clip_x && px < clip_right)
+                    line[px] = swap565(blend565(fg, swap565(line[px]), alpha));
+            };
+
+            for (int32_t px = row.left; px < row.solid_begin; px++)
+                blend(x + px, *coverage++);
+            int32_t begin = std::max(x + row.solid_begin, clip_x);
+            int32_t end = std::min(x + row.solid_end, clip_right);
+            if (begin < end)
+                std::fill(line + begin, line + end, fg_swapped);
+            for (int32_t px = row.solid_end; px < row.right; px++)
+                blend(x + px, *coverage++);
+        }
+    }
+
+    void ShapeCache::fill_circle(LGFX_Sprite* dst, int32_t x, int32_t y, int32_t r, int color)
+    {
+        if (dst->getColorDepth() != lgfx::rgb565_2Byte || r < 0)
+        {
+            dst->fillCircle(x, y, r, color);
+            return;
+        }
+        const int32_t geometry[6] = {r};
+        const float params[] = {r + 0.5f, r + 0.5f, static_cast<float>(r)};
+        Shape* shape = _find(shape_key('C', geometry), geometry, 2 * r + 1, 2 * r + 1, circle_distance, params);
+        _blit(dst, shape, x - r, y - r, color);
+    }
+
+    void ShapeCache::fill_triangle(LGFX_Sprite* dst,
+                                   int32_t x0,
+                                   int32_t y0,
+                                   int32_t x1,
+                                   int32_t y1,
+                                   int32_t x2,
+                                   int32_t y2,
+                                   int color)
+    {
+        int32_t area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        if (dst->getColorDepth() != lgfx::rgb565_2Byte || area == 0)
+        {
+            dst->fillTriangle(x0, y0, x1, y1, x2, y2, color);
+            return;
+        }
+        // Cached relative to the bounding box, one pixel of margin for the smooth edge
+        int32_t left = std::min({x0, x1, x2}) - 1;
+        int32_t top = std::min({y0, y1, y2}) - 1;
+        int32_t width = std::max({x0, x1, x2}) - left + 2;
+        int32_t height = std::max({y0, y1, y2}) - top + 2;
+        x0 -= left, x1 -= left, x2 -= left;
+        y0 -= top, y1 -= top, y2 -= top;
+        const int32_t geometry[6] = {x0, y0, x1, y1, x2, y2};
+        const float params[] = {x0 + 0.5f, y0 + 0.5f, x1 + 0.5f, y1 + 0.5f, x2 + 0.5f, y2 + 0.5f, area > 0 ? 1.0f : -1.0f};
+        Shape* shape = _find(shape_key('T', geometry), geometry, width, height, triangle_distance, params);
+        _blit(dst, shape, left, top, color);
+    }
+} // namespace UTILS
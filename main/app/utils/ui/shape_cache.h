@@ -0,0 +1,100 @@
+/**
+ * @file shape_cache.h
+ * @brief Anti-aliased circles and triangles, rasterized once and blitted as row spans
+ * @version 0.1
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lgfx/v1/LGFX_Sprite.hpp"
+
+// Note circle, pitch circle in two sizes, two arrows
+#define SHAPE_CACHE_ENTRIES 8
+
+namespace UTILS
+{
+    /**
+     * @brief Coverage masks of filled shapes, drawn into a 16-bit sprite in any color
+     *
+     * A shape is kept as one run per row: the partly covered pixels of the
+     * left edge, a fully covered span and the partly covered pixels of the
+     * right edge. Only the edges are blended with what is under them, the
+     * span is a plain fill of the sprite's row. Shapes are cached by size
+     * and not by position or color, the least recently used one is replaced
+     * when the cache is full. Convex shapes only, that is all the UI draws.
+     */
+    class ShapeCache
+    {
+    public:
+        ShapeCache();
+        ~ShapeCache();
+
+        ShapeCache(const ShapeCache&) = delete;
+        ShapeCache& operator=(const ShapeCache&) = delete;
+
+        /**
+         * @brief Like fillCircle(), covers the same 2r + 1 square with a smooth edge
+         */
+        void fill_circle(LGFX_Sprite* dst, int32_t x, int32_t y, int32_t r, int color);
+
+        /**
+         * @brief Like fillTriangle(), with smooth edges
+         */
+        void fill_triangle(LGFX_Sprite* dst,
+                           int32_t x0,
+                           int32_t y0,
+                           int32_t x1,
+                           int32_t y1,
+                           int32_t x2,
+                           int32_t y2,
+                           int color); // RGB565 like the TFT_ colors
+
+        void clear();
+
+        size_t hits() const { return _hits; }
+        size_t misses() const { return _misses; }
+
+    private:
+        typedef float (*Distance)(float x, float y, const float* params);
+
+        typedef struct
+        {
+            int16_t left;        // First pixel with any coverage
+            int16_t solid_begin; // Fully covered from here
+            int16_t solid_end;   // ... to here
+            int16_t right;       // One past the last pixel with any coverage
+            uint16_t coverage;   // Index of the left edge's values, the right edge's follow
+        } Row;
+
+        typedef struct
+        {
+            uint32_t key;        // Hash of kind and geometry, compared first
+            Distance distance;   // Kind of shape
+            int32_t geometry[6]; // Circle: radius. Triangle: corners relative to the box
+            int32_t width;
+            int32_t height;
+            uint32_t last_used;
+            Row* rows;
+            uint8_t* coverage; // 0..255 per edge pixel
+        } Shape;
+
+        Shape* _find(uint32_t key,
+                     const int32_t* geometry,
+                     int32_t width,
+                     int32_t height,
+                     Distance distance,
+                     const float* params);
+        void _blit(LGFX_Sprite* dst, const Shape* shape, int32_t x, int32_t y, int color);
+
+        Shape _shapes[SHAPE_CACHE_ENTRIES];
+        uint32_t _clock;
+        size_t _hits;
+        size_t _misses;
+    };
+} // namespace UTILS
@@ -78,6 +78,7 @@ typedef struct
     float targetFrequency;
     TunerNoteName targetNote;
     int targetOctave;
+    float confidence; // 0..1, periodicity of the detected signal
 } FrequencyInfo;
 
 typedef enum : uint8_t
@@ -93,9 +94,68 @@ typedef enum
     MODE_GUITAR,
     MODE_UKULELE,
     MODE_VIOLIN,
+    MODE_STRUM, // All six guitar strings from one strum
     MODE_COUNT // Number of modes
 } TunerMode;
 
+typedef struct
+{
+    TunerMode mode;
+    float frequency; // Selected string, 0 in MODE_AUTO and MODE_STRUM
+    bool spectrum;   // The spectrum view is on, the detector sends SpectrumLines
+} TunerTarget;
+
+// The mode the GUI comes up in. The pitch detector opens this mode's capture
+// profile at boot, long before the GUI sends its first target, so that
+// target doesn't restart the mic.
+#define TUNER_START_MODE MODE_GUITAR
+
+#define STRUM_STRINGS 6
+
+typedef struct
+{
+    float frequency[STRUM_STRINGS]; // -1 if the string wasn't heard
+    float cents[STRUM_STRINGS];     // Offset from the string's target
+    float level[STRUM_STRINGS];     // dB relative to the strongest partial
+    bool shared[STRUM_STRINGS];     // Merged with a lower string's partial, cents can be tens off
+} StrumInfo;
+
+// Strobe view, phase of the input against the target note once per block
+typedef struct
+{
+    float phase;     // Turns, 0..1
+    float drift;     // Hz above the reference, the phase rotates at this rate
+    float reference; // Hz, 0 if there is no note to compare against
+    float level;     // Amplitude of the input at the reference
+} StrobeInfo;
+
+// Spectrum view, one row of the waterfall, log spaced from SPECTRUM_LOW_HZ
+// to SPECTRUM_HIGH_HZ with one band per pixel column
+#define SPECTRUM_BANDS 240
+#define SPECTRUM_LOW_HZ 40.0f
+#define SPECTRUM_HIGH_HZ 4000.0f
+// Rows per second while the view is on
+#define SPECTRUM_LINE_RATE 16
+
+typedef struct
+{
+    uint8_t level[SPECTRUM_BANDS]; // 0 (floor) .. 255 (full scale)
+    float pitch;                   // Hz, last detected pitch, -1 if there is none
+} SpectrumLine;
+
+// Pitch history graph, every detection rather than the latest one
+typedef struct
+{
+    int64_t time_us;  // esp_timer time of the detection, from the sample clock
+    float frequency;  // Hz, smoothed
+    float cents;      // Offset from the nearest note
+    float confidence; // 0..1
+    float amplitude;  // 0..1, peak to peak of the input window over full scale
+} PitchSample;
+
+// Standard guitar tuning, also the targets of MODE_STRUM
+extern const float GuitarFrequencies[STRUM_STRINGS];
+
 //
 // RTOS Queues
 //
@@ -107,13 +167,44 @@ typedef enum
 #define FREQUENCY_QUEUE_LENGTH 1
 #define FREQUENCY_QUEUE_ITEM_SIZE sizeof(FrequencyInfo)
 
+// The GUI overwrites the selected mode and string here. The pitch detector
+// task switches its capture profile (see pitch/pitch_profile.h) when the
+// mode changes and only looks around the string's note in string modes.
+#define TARGET_QUEUE_LENGTH 1
+
+// MODE_STRUM results, overwritten after every analysis like frequencyQueue
+#define STRUM_QUEUE_LENGTH 1
+
+// Strobe phase, overwritten after every block, the GUI receives it so it
+// knows when a new one arrived and extrapolates the phase in between
+#define STROBE_QUEUE_LENGTH 1
+
+// Spectrum view rows. Every one of them is a row of the waterfall so they
+// are queued rather than overwritten, the detector drops a row instead of
+// waiting if the GUI falls behind.
+#define SPECTRUM_QUEUE_LENGTH 4
+
+// Detections on their way to the pitch history graph, a lock-free ring and
+// not a queue (see pitch_detector_task.h). A power of two, the GUI empties
+// it every frame and the detector makes a few per hop at most.
+#define PITCH_HISTORY_LENGTH 64
+
 //
 // Pitch Detector Related
 //
 
+// Defaults for the host tools and PitchPipelineConfig. On the device every
+// TunerMode has its own sample rate, window and hop, see pitch/pitch_profile.h.
 #define TUNER_FRAME_SIZE 1024
 #define TUNER_SAMPLE_RATE (16 * 1000) // 16kHz
 
+// The mic is recorded continuously in blocks of TUNER_HOP_SIZE samples and
+// every block is fed to the detector as soon as it is complete. The input
+// gate and normalization still look at the last TUNER_FRAME_SIZE samples.
+#define TUNER_HOP_SIZE 256
+// Blocks in the Mic_Class stream ring, one is always being written by the mic task
+#define TUNER_HOP_BUFFERS 4
+
 // If the difference between the minimum and maximum input values
 // is less than this value, discard the reading and do not evaluate
 // the frequency. This should help cut down on the noise from the
@@ -122,6 +213,13 @@ typedef enum
 // #define TUNER_READING_DIFF_MINIMUM      80
 #define TUNER_READING_DIFF_MINIMUM 600
 
+// The pitch modes find notes with pitch/onset_detector.h instead: a note
+// starts when the envelope of the raw samples rises above TUNER_ONSET_LEVEL,
+// the amplitude of the swing above, and only ends once it has decayed below
+// TUNER_RELEASE_LEVEL, so quiet sustains keep ringing on the display.
+#define TUNER_ONSET_LEVEL (TUNER_READING_DIFF_MINIMUM / 2)
+#define TUNER_RELEASE_LEVEL (TUNER_READING_DIFF_MINIMUM / 6)
+
 //
 // Smoothing
 //
@@ -140,6 +238,15 @@ typedef enum
 // Exponential Smoothing
 #define EXP_SMOOTHING ((float)0.5)
 
+// Moving average window, in detections
+#define MOVING_AVERAGE_SIZE 5
+
+// Outlier rejection ahead of the other filters: detections further than
+// MEDIAN_FILTER_MAX_CENTS from the median of the last MEDIAN_FILTER_SIZE
+// are replaced by the median
+#define MEDIAN_FILTER_SIZE 7
+#define MEDIAN_FILTER_MAX_CENTS 300
+
 #define A4_FREQ 440.0
 
 #define HINT_ANIMATION_SPEED 20
@@ -0,0 +1,57 @@
+/**
+ * @file boot_timing.cpp
+ * @author d4rkmen
+ * @brief Timestamps of the boot phases, to see where start-up time goes
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "boot_timing.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <atomic>
+
+static const char* TAG = "Boot";
+
+namespace HAL
+{
+    typedef struct
+    {
+        int64_t time;
+        const char* phase;
+    } BootMark;
+
+    static BootMark s_marks[BOOT_TIMING_MAX_MARKS];
+    static std::atomic<size_t> s_count(0);
+
+    void boot_mark(const char* phase)
+    {
+        size_t i = s_count.fetch_add(1);
+        if (i >= BOOT_TIMING_MAX_MARKS)
+            return;
+        s_marks[i].time = esp_timer_get_time();
+        s_marks[i].phase = phase;
+    }
+
+    void boot_log()
+    {
+        size_t count = s_count.load();
+        if (count > BOOT_TIMING_MAX_MARKS)
+            count = BOOT_TIMING_MAX_MARKS;
+        int64_t last = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            // A mark being written right now
+            if (s_marks[i].phase == nullptr)
+                continue;
+            ESP_LOGI(TAG,
+                     "%-16s %6.1f ms (+%.1f)",
+                     s_marks[i].phase,
+                     s_marks[i].time / 1000.0,
+                     (s_marks[i].time - last) / 1000.0);
+            last = s_marks[i].time;
+        }
+    }
+} // namespace HAL
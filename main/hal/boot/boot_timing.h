@@ -0,0 +1,30 @@
+/**
+ * @file boot_timing.h
+ * @author d4rkmen
+ * @brief Timestamps of the boot phases, to see where start-up time goes
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Marks past this are dropped
+#define BOOT_TIMING_MAX_MARKS 16
+
+namespace HAL
+{
+    /**
+     * @brief Record that a boot phase has finished, from any task
+     * @param phase Has to outlive the boot log, a string literal
+     */
+    void boot_mark(const char* phase);
+
+    /**
+     * @brief Print the marks in the order they were taken, with the time since the timer started
+     */
+    void boot_log();
+} // namespace HAL
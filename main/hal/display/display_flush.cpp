@@ -0,0 +1,166 @@
+/**
+ * @file display_flush.cpp
+ * @author d4rkmen
+ * @brief Double-buffered canvas, sent to the display by DMA from its own task
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "display_flush.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "DisplayFlush";
+
+using namespace HAL;
+
+DisplayFlush::DisplayFlush(LGFX_Device* display)
+    : _display(display), _buffers{nullptr, nullptr}, _width(display->width()), _height(display->height()), _back(0),
+      _rect_count(0), _sending_count(0), _front(1), _task_handle(nullptr), _idle(nullptr), _frames(0), _send_time(0)
+{
+}
+
+DisplayFlush::~DisplayFlush()
+{
+    if (_task_handle)
+    {
+        wait();
+        vTaskDelete(_task_handle);
+    }
+    if (_idle)
+        vSemaphoreDelete(_idle);
+    for (int i = 0; i < 2; i++)
+    {
+        if (_buffers[i])
+        {
+            _buffers[i]->deleteSprite();
+            delete _buffers[i];
+        }
+    }
+}
+
+bool DisplayFlush::begin()
+{
+    // Both buffers have to be DMA capable, so internal RAM
+    for (int i = 0; i < 2; i++)
+    {
+        _buffers[i] = new LGFX_Sprite(_display);
+        _buffers[i]->setPsram(false);
+        if (_buffers[i]->createSprite(_width, _height) == nullptr)
+        {
+            ESP_LOGE(TAG, "Failed to allocate frame buffer %d", i);
+            return false;
+        }
+        _buffers[i]->fillScreen(TFT_BLACK);
+    }
+
+    _idle = xSemaphoreCreateBinary();
+    if (_idle == nullptr)
+        return false;
+    xSemaphoreGive(_idle);
+    if (xTaskCreatePinnedToCore(_task,
+                                "display_flush",
+                                DISPLAY_FLUSH_TASK_STACK,
+                                this,
+                                DISPLAY_FLUSH_TASK_PRIORITY,
+                                &_task_handle,
+                                DISPLAY_FLUSH_TASK_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start the flush task");
+        return false;
+    }
+    return true;
+}
+
+void DisplayFlush::damage(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    if (w <= 0 || h <= 0)
+        return;
+    if (_rect_count == DISPLAY_FLUSH_MAX_RECTS)
+    {
+        // Out of slots, the last one grows to take this one in
+        Rect& r = _rects[_rect_count - 1];
+        int32_t right = std::max(r.x + r.w, x + w);
+        int32_t bottom = std::max(r.y + r.h, y + h);
+        r.x = std::min(r.x, x);
+        r.y = std::min(r.y, y);
+        r.w = right - r.x;
+        r.h = bottom - r.y;
+        return;
+    }
+    _rects[_rect_count++] = {x, y, w, h};
+}
+
+void DisplayFlush::flush()
+{
+    if (_rect_count == 0)
+        return;
+
+    // The previous frame has to be on the display before its buffer is drawn again
+    xSemaphoreTake(_idle, portMAX_DELAY);
+    std::copy(_rects, _rects + _rect_count, _sending);
+    _sending_count = _rect_count;
+    _rect_count = 0;
+    _front = _back;
+    _back ^= 1;
+    xTaskNotifyGive(_task_handle);
+
+    // Reading the front buffer while the DMA does is fine
+    for (size_t i = 0; i < _sending_count; i++)
+        _carry(_sending[i]);
+}
+
+void DisplayFlush::_carry(const Rect& r)
+{
+    int32_t x = std::max<int32_t>(r.x, 0);
+    int32_t y = std::max<int32_t>(r.y, 0);
+    int32_t right = std::min(r.x + r.w, _width);
+    int32_t bottom = std::min(r.y + r.h, _height);
+    if (right <= x || bottom <= y)
+        return;
+    auto src = static_cast<const uint16_t*>(_buffers[_front]->getBuffer());
+    auto dst = static_cast<uint16_t*>(_buffers[_back]->getBuffer());
+    for (int32_t row = y; row < bottom; row++)
+        memcpy(dst + row * _width + x, src + row * _width + x, (right - x) * sizeof(uint16_t));
+}
+
+void DisplayFlush::wait()
+{
+    xSemaphoreTake(_idle, portMAX_DELAY);
+    xSemaphoreGive(_idle);
+}
+
+void DisplayFlush::_send()
+{
+    // Sprites keep their pixels in the panel's byte order, rows of a clipped
+    // region go out as DMA transfers straight from the buffer
+    int64_t start = esp_timer_get_time();
+    auto pixels = static_cast<const lgfx::swap565_t*>(_buffers[_front]->getBuffer());
+    _display->startWrite();
+    for (size_t i = 0; i < _sending_count; i++)
+    {
+        const Rect& r = _sending[i];
+        _display->setClipRect(r.x, r.y, r.w, r.h);
+        _display->pushImageDMA(0, 0, _width, _height, pixels);
+    }
+    _display->clearClipRect();
+    _display->waitDMA();
+    _display->endWrite();
+    _send_time = (uint32_t)(esp_timer_get_time() - start);
+    _frames++;
+}
+
+void DisplayFlush::_task(void* arg)
+{
+    DisplayFlush* self = static_cast<DisplayFlush*>(arg);
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->_send();
+        xSemaphoreGive(self->_idle);
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file display_flush.h
+ * @author d4rkmen
+ * @brief Double-buffered canvas, sent to the display by DMA from its own task
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include "M5GFX.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// Regions per frame, more are merged into their bounding box
+#define DISPLAY_FLUSH_MAX_RECTS 8
+// Below the pitch detector on core 1, the SPI wait spins and the GUI on core 0 keeps drawing
+#define DISPLAY_FLUSH_TASK_PRIORITY 4
+#define DISPLAY_FLUSH_TASK_CORE 1
+#define DISPLAY_FLUSH_TASK_STACK 3072
+
+namespace HAL
+{
+    /**
+     * @brief Two full-screen canvases, one is drawn while the other is on the wire
+     *
+     * The GUI draws into canvas() and marks what it changed with damage().
+     * flush() hands the canvas to the flush task and returns right away with
+     * the other one as the new canvas(). It only blocks if the previous
+     * frame is still being sent.
+     *
+     * The damaged regions are copied over to the new canvas() at the swap,
+     * so it always holds the frame just flushed and callers can keep
+     * drawing on top of what they drew before, like on a single sprite.
+     */
+    class DisplayFlush
+    {
+    public:
+        explicit DisplayFlush(LGFX_Device* display);
+        ~DisplayFlush();
+
+        bool begin();
+
+        inline LGFX_Sprite* canvas() { return _buffers[_back]; }
+
+        void damage(int32_t x, int32_t y, int32_t w, int32_t h);
+        void damage_all() { damage(0, 0, _width, _height); }
+
+        /**
+         * @brief Send the damaged regions of canvas() and swap the buffers
+         */
+        void flush();
+
+        /**
+         * @brief Block until the last flushed frame is on the display
+         */
+        void wait();
+
+        uint32_t frames() const { return _frames; }
+        // How long the last frame took on the wire, in microseconds
+        uint32_t send_time() const { return _send_time; }
+
+    private:
+        typedef struct
+        {
+            int32_t x;
+            int32_t y;
+            int32_t w;
+            int32_t h;
+        } Rect;
+
+        static void _task(void* arg);
+        void _carry(const Rect& r);
+        void _send();
+
+        LGFX_Device* _display;
+        LGFX_Sprite* _buffers[2];
+        int32_t _width;
+        int32_t _height;
+        uint8_t _back;
+
+        Rect _rects[DISPLAY_FLUSH_MAX_RECTS]; // Collected for the next flush
+        size_t _rect_count;
+        Rect _sending[DISPLAY_FLUSH_MAX_RECTS]; // Owned by the flush task until _idle is given
+        size_t _sending_count;
+        uint8_t _front;
+
+        TaskHandle_t _task_handle;
+        SemaphoreHandle_t _idle;
+        uint32_t _frames;
+        uint32_t _send_time;
+    };
+} // namespace HAL
@@ -10,6 +10,8 @@
  */
 #pragma once
 #include "M5GFX.h"
+#include "boot/boot_timing.h"
+#include "display/display_flush.h"
 #include "keyboard/keyboard.h"
 #ifdef HAVE_SDCARD
 #include "sdcard/sdcard.h"
@@ -38,7 +40,7 @@ namespace HAL
     {
     protected:
         LGFX_Device* _display;
-        LGFX_Sprite* _canvas;
+        DisplayFlush* _flush; // Owns the double-buffered canvas
 
 #ifdef HAVE_SETTINGS
         SETTINGS::Settings* _settings;
@@ -66,7 +68,7 @@ namespace HAL
             SETTINGS::Settings* settings
 #endif
             )
-            : _display(nullptr), _canvas(nullptr)
+            : _display(nullptr), _flush(nullptr)
 #ifdef HAVE_SETTINGS
               ,
               _settings(settings)
@@ -101,7 +103,8 @@ namespace HAL
 
         // Getter
         inline LGFX_Device* display() { return _display; }
-        inline LGFX_Sprite* canvas() { return _canvas; }
+        // The back buffer, a different sprite after every canvas update
+        inline LGFX_Sprite* canvas() { return _flush->canvas(); }
 #ifdef HAVE_SETTINGS
         inline SETTINGS::Settings* settings() { return _settings; }
 #endif
@@ -123,11 +126,30 @@ namespace HAL
         inline WiFi* wifi() { return _wifi; }
 #endif
         // Canvas
-        inline void canvas_update() { _canvas->pushSprite(0, 0); }
+        // Updates are sent in the background, canvas() then returns the other buffer
+        inline void canvas_update()
+        {
+            _flush->damage_all();
+            _flush->flush();
+        }
+        // Send only part of the canvas
+        inline void canvas_update(int32_t x, int32_t y, int32_t w, int32_t h)
+        {
+            _flush->damage(x, y, w, h);
+            _flush->flush();
+        }
+        // Several regions of one frame: mark each of them, then flush once
+        inline void canvas_damage(int32_t x, int32_t y, int32_t w, int32_t h) { _flush->damage(x, y, w, h); }
+        inline void canvas_flush() { _flush->flush(); }
+        // Microseconds the last completed update spent on the wire
+        inline uint32_t canvas_send_time() { return _flush->send_time(); }
 
         // Override
         virtual std::string type() { return "null"; }
         virtual void init() {}
+        // init() may leave the display coming up in the background, display(), canvas()
+        // and the canvas updates are only valid once this returns
+        virtual void wait_display() {}
 
 #ifdef HAVE_SPEAKER
         virtual void playLastSound() {}
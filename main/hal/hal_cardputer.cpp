@@ -17,6 +17,12 @@
 
 static const char* TAG = "HAL";
 
+// The panel's reset and wake-up delays run here while the rest of the HAL comes up
+#define DISPLAY_INIT_TASK_STACK 4096
+#define DISPLAY_INIT_TASK_PRIORITY 5
+#define DISPLAY_INIT_TASK_CORE 1
+#define DISPLAY_READY_BIT BIT0
+
 using namespace HAL;
 
 void HalCardputer::_init_display()
@@ -27,15 +33,33 @@ void HalCardputer::_init_display()
     _display = new M5GFX;
     _display->init();
 
-    // Canvas
-    _canvas = new LGFX_Sprite(_display);
-    _canvas->createSprite(_display->width(), _display->height());
+    // Canvas, double-buffered and flushed by DMA
+    _flush = new DisplayFlush(_display);
+    if (!_flush->begin())
+    {
+        ESP_LOGE(TAG, "Failed to start the display flush");
+    }
+    boot_mark("display");
+}
+
+void HalCardputer::_display_task(void* arg)
+{
+    HalCardputer* self = static_cast<HalCardputer*>(arg);
+    self->_init_display();
+    xEventGroupSetBits(self->_display_ready, DISPLAY_READY_BIT);
+    vTaskDelete(NULL);
+}
+
+void HalCardputer::wait_display()
+{
+    xEventGroupWaitBits(_display_ready, DISPLAY_READY_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
 }
 
 void HalCardputer::_init_keyboard()
 {
     _keyboard = new KEYBOARD::Keyboard;
     _keyboard->init();
+    boot_mark("keyboard");
 }
 #ifdef HAVE_MIC
 void HalCardputer::_init_mic()
@@ -63,6 +87,7 @@ void HalCardputer::_init_mic()
     {
         ESP_LOGI(TAG, "Microphone initialized successfully");
     }
+    boot_mark("mic");
 }
 #endif
 #ifdef HAVE_SPEAKER
@@ -98,7 +123,20 @@ void HalCardputer::init()
 {
     ESP_LOGI(TAG, "HAL init");
 
-    _init_display();
+    // Nothing else needs the display, the mic and the pitch detector can start while it comes up
+    _display_ready = xEventGroupCreate();
+    if (xTaskCreatePinnedToCore(_display_task,
+                                "hal_display",
+                                DISPLAY_INIT_TASK_STACK,
+                                this,
+                                DISPLAY_INIT_TASK_PRIORITY,
+                                nullptr,
+                                DISPLAY_INIT_TASK_CORE) != pdPASS)
+    {
+        ESP_LOGW(TAG, "No display init task, initializing in line");
+        _init_display();
+        xEventGroupSetBits(_display_ready, DISPLAY_READY_BIT);
+    }
     _init_keyboard();
 #ifdef HAVE_SPEAKER
     _init_speaker();
@@ -119,6 +157,7 @@ void HalCardputer::init()
 #ifdef HAVE_WIFI
     _init_wifi();
 #endif
+    boot_mark("hal");
 }
 
 #ifdef HAVE_BATTERY
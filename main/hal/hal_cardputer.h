@@ -9,6 +9,7 @@
  *
  */
 #include "hal.h"
+#include "freertos/event_groups.h"
 #ifdef HAVE_SETTINGS
 #include "settings/settings.h"
 #endif
@@ -17,6 +18,8 @@ namespace HAL
     class HalCardputer : public Hal
     {
     private:
+        EventGroupHandle_t _display_ready;
+        static void _display_task(void* arg);
         void _init_display();
         void _init_keyboard();
 #ifdef HAVE_MIC
@@ -49,11 +52,13 @@ namespace HAL
 #ifdef HAVE_SETTINGS
                   settings
 #endif
-              )
+                  ),
+              _display_ready(nullptr)
         {
         }
         std::string type() override { return "cardputer"; }
         void init() override;
+        void wait_display() override;
 #ifdef HAVE_SPEAKER
         void playErrorSound() override
         {
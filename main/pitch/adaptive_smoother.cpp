@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "adaptive_smoother.h"
+
+#include <algorithm>
+#include <cmath>
+
+AdaptiveSmoother::AdaptiveSmoother()
+    : _confidence(1), _next_envelope(0), _jump_ratio(exp2f(ADAPTIVE_JUMP_CENTS / 1200.0f))
+{
+    reset();
+}
+
+/// @brief Smoothing factor of a first order low pass at `cutoff` Hz
+static float lowpass_alpha(float cutoff, float dt) { return dt / (dt + 1.0f / (2.0f * (float)M_PI * cutoff)); }
+
+void AdaptiveSmoother::reset()
+{
+    _value = 0;
+    _speed = 0;
+    _age = 0;
+    _envelope = 0;
+    _started = false;
+}
+
+float AdaptiveSmoother::filter(float frequency, float dt)
+{
+    float envelope = _next_envelope;
+    bool attack = !_started || envelope > _envelope * ADAPTIVE_ATTACK_RISE || frequency > _value * _jump_ratio ||
+                  frequency * _jump_ratio < _value;
+    _envelope = envelope;
+    if (attack || dt <= 0)
+    {
+        if (attack)
+        {
+            _started = true;
+            _age = 0;
+            _speed = 0;
+            _value = frequency;
+        }
+        return _value;
+    }
+    _age += dt;
+
+    // 1200 / ln(2), cents from a small relative change
+    float speed = 1731.234f * (frequency - _value) / (_value * dt);
+    _speed += lowpass_alpha(ADAPTIVE_DERIVATIVE_HZ, dt) * (speed - _speed);
+
+    // From the attack cutoff down to the sustain one, evenly in octaves
+    float settle = std::min(_age * (1000.0f / ADAPTIVE_SETTLE_MS), 1.0f);
+    float cutoff = ADAPTIVE_ATTACK_HZ * powf(ADAPTIVE_SUSTAIN_HZ / ADAPTIVE_ATTACK_HZ, settle);
+    cutoff += ADAPTIVE_BETA * fabsf(_speed);
+
+    float weight = (_confidence - ADAPTIVE_MIN_CONFIDENCE) / (1.0f - ADAPTIVE_MIN_CONFIDENCE);
+    weight = std::max(ADAPTIVE_MIN_WEIGHT, std::min(weight, 1.0f));
+    _value += weight * lowpass_alpha(cutoff, dt) * (frequency - _value);
+    return _value;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_ADAPTIVE_SMOOTHER)
+#define TUNER_ADAPTIVE_SMOOTHER
+
+//
+// Smoothing of the detected frequency that follows the note's life instead
+// of fixed constants. It is a 1€ filter, a low pass whose cutoff rises with
+// the speed of the pitch, with a minimum cutoff that moves:
+//
+//  - a pluck, seen as the first reading, a jump in the signal range or a
+//    jump in pitch, starts an attack. The reading is taken as it is and the
+//    cutoff starts at ADAPTIVE_ATTACK_HZ, next to no lag,
+//  - over ADAPTIVE_SETTLE_MS the cutoff falls to ADAPTIVE_SUSTAIN_HZ, heavy
+//    averaging for the sustain. The speed term still follows the string
+//    settling after the attack or a bend,
+//  - every reading is weighted by the detector's confidence on top, an
+//    unsure one barely moves the output.
+//
+// Platform-free like the rest of main/pitch.
+//
+
+// Minimum cutoff right after an attack and once settled, in Hz
+#define ADAPTIVE_ATTACK_HZ 40.0f
+#define ADAPTIVE_SUSTAIN_HZ 0.3f
+// Time from the attack until the sustain cutoff is reached
+#define ADAPTIVE_SETTLE_MS 400.0f
+// Cutoff added per cent/s of pitch movement, and the cutoff of the speed estimate
+#define ADAPTIVE_BETA 0.005f
+#define ADAPTIVE_DERIVATIVE_HZ 1.0f
+// Signal range growing by this factor from one reading to the next is a new pluck
+#define ADAPTIVE_ATTACK_RISE 1.5f
+// A reading this far from the output is a new note, not jitter
+#define ADAPTIVE_JUMP_CENTS 40.0f
+// Readings at or below this confidence get the least weight, 1.0 the full one
+#define ADAPTIVE_MIN_CONFIDENCE 0.5f
+#define ADAPTIVE_MIN_WEIGHT 0.1f
+
+/// @brief FilterChain stage, set_detection() before each filter().
+class AdaptiveSmoother
+{
+public:
+    AdaptiveSmoother();
+
+    /// @brief What the detector knows about the next reading.
+    /// @param confidence Periodicity or NSDF peak, 0..1.
+    /// @param envelope Signal range around the reading, any unit.
+    void set_detection(float confidence, float envelope)
+    {
+        _confidence = confidence;
+        _next_envelope = envelope;
+    }
+
+    /// @param dt Seconds since the reading before.
+    float filter(float frequency, float dt);
+
+    void reset();
+
+    /// @brief Seconds since the last attack.
+    float age() const { return _age; }
+
+private:
+    float _value;
+    float _speed; // Filtered, cents per second
+    float _age;
+    float _envelope; // Of the reading before
+    float _confidence;
+    float _next_envelope;
+    float _jump_ratio;
+    bool _started;
+};
+
+#endif
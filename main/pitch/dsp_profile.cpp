@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "dsp_profile.h"
+
+static const char* const StageNames[DSP_STAGE_COUNT] = {
+    "hop", "pipeline", "onset", "sig_cond", "detector", "filters", "note", "strobe", "strum", "publish",
+};
+
+const char* dsp_stage_name(DspStage stage) { return stage < DSP_STAGE_COUNT ? StageNames[stage] : "unknown"; }
+
+#if defined(HAVE_DSP_PROFILE)
+
+#include <algorithm>
+#include <cstdio>
+
+#include "app/utils/pow2_histogram.hpp"
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <chrono>
+#include <thread>
+#endif
+
+DspProfile dspProfile;
+
+uint32_t dsp_profile_ticks_per_second()
+{
+#if defined(ESP_PLATFORM)
+    return CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000;
+#elif defined(__x86_64__) || defined(__i386__)
+    // The TSC against the steady clock over 20 ms, the first call waits for it
+    static const uint32_t rate = []()
+    {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t ticks = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return (uint32_t)std::min(((double)__rdtsc() - ticks) / seconds, 4e9);
+    }();
+    return rate;
+#else
+    return 1000000000;
+#endif
+}
+
+uint32_t DspStageStats::percentile(uint8_t percent) const
+{
+    return pow2_percentile(buckets, DSP_PROFILE_BUCKETS, count, DSP_PROFILE_FIRST_TICKS, max, percent);
+}
+
+DspProfile::DspProfile() : _ran(0), _budget(0), _sequence(0), _clear(false), _budget_us(0)
+{
+    std::fill(_hop, _hop + DSP_STAGE_COUNT, 0);
+    _zero();
+}
+
+void DspProfile::_zero()
+{
+    _hops.store(0, std::memory_order_relaxed);
+    _overruns.store(0, std::memory_order_relaxed);
+    for (Stage& stage : _stages)
+    {
+        stage.count.store(0, std::memory_order_relaxed);
+        stage.min.store(UINT32_MAX, std::memory_order_relaxed);
+        stage.max.store(0, std::memory_order_relaxed);
+        stage.sum_low.store(0, std::memory_order_relaxed);
+        stage.sum_high.store(0, std::memory_order_relaxed);
+        for (auto& bucket : stage.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void DspProfile::set_budget_us(uint32_t us)
+{
+    _budget = (uint32_t)std::min<uint64_t>((uint64_t)us * dsp_profile_ticks_per_second() / 1000000, UINT32_MAX);
+    _budget_us.store(us, std::memory_order_relaxed);
+}
+
+void DspProfile::end_hop()
+{
+    // Single writer: plain loads and stores of the atomics, no read-modify-write
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (_clear.exchange(false, std::memory_order_relaxed))
+        _zero();
+    _hops.store(_hops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (_budget && (_ran & (1u << DSP_STAGE_HOP)) && _hop[DSP_STAGE_HOP] > _budget)
+        _overruns.store(_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    for (int i = 0; i < DSP_STAGE_COUNT; i++)
+    {
+        if (!(_ran & (1u << i)))
+            continue;
+        uint32_t ticks = _hop[i];
+        _hop[i] = 0;
+        Stage& stage = _stages[i];
+        stage.count.store(stage.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        stage.min.store(std::min(stage.min.load(std::memory_order_relaxed), ticks), std::memory_order_relaxed);
+        stage.max.store(std::max(stage.max.load(std::memory_order_relaxed), ticks), std::memory_order_relaxed);
+        uint32_t low = stage.sum_low.load(std::memory_order_relaxed);
+        stage.sum_low.store(low + ticks, std::memory_order_relaxed);
+        if (low + ticks < low)
+            stage.sum_high.store(stage.sum_high.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        uint32_t doublings = ticks / DSP_PROFILE_FIRST_TICKS;
+        size_t bucket = doublings ? std::min<size_t>(32 - __builtin_clz(doublings), DSP_PROFILE_BUCKETS - 1) : 0;
+        stage.buckets[bucket].store(stage.buckets[bucket].load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+    }
+    _ran = 0;
+
+    _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void DspProfile::snapshot(DspStage stage, DspStageStats& stats) const
+{
+    const Stage& from = _stages[stage];
+    while (true)
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_acquire);
+        if (sequence & 1)
+            continue;
+        stats.count = from.count.load(std::memory_order_relaxed);
+        stats.min = from.min.load(std::memory_order_relaxed);
+        stats.max = from.max.load(std::memory_order_relaxed);
+        stats.sum = (uint64_t)from.sum_high.load(std::memory_order_relaxed) << 32 |
+                    from.sum_low.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < DSP_PROFILE_BUCKETS; i++)
+            stats.buckets[i] = from.buckets[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == sequence)
+            break;
+    }
+    if (stats.count == 0)
+        stats.min = 0;
+}
+
+void DspProfile::dump(void (*print)(const char* line, void* user), void* user) const
+{
+    char line[160];
+    const double us_per_tick = 1e6 / dsp_profile_ticks_per_second();
+    uint32_t budget_us = _budget_us.load(std::memory_order_relaxed);
+    DspStageStats stats;
+    snapshot(DSP_STAGE_HOP, stats);
+    if (budget_us && stats.count)
+        snprintf(line,
+                 sizeof(line),
+                 "%lu hops, %lu over the %lu us budget, load mean %.1f%% max %.1f%%",
+                 (unsigned long)hops(),
+                 (unsigned long)overruns(),
+                 (unsigned long)budget_us,
+                 100.0 * stats.mean() * us_per_tick / budget_us,
+                 100.0 * stats.max * us_per_tick / budget_us);
+    else
+        snprintf(line, sizeof(line), "%lu hops", (unsigned long)hops());
+    print(line, user);
+    for (int i = 0; i < DSP_STAGE_COUNT; i++)
+    {
+        snapshot((DspStage)i, stats);
+        if (stats.count == 0)
+            continue;
+        snprintf(line,
+                 sizeof(line),
+                 "%-9s n %lu min %.1f mean %.1f p50 %.1f p90 %.1f p99 %.1f max %.1f us",
+                 dsp_stage_name((DspStage)i),
+                 (unsigned long)stats.count,
+                 stats.min * us_per_tick,
+                 stats.mean() * us_per_tick,
+                 stats.percentile(50) * us_per_tick,
+                 stats.percentile(90) * us_per_tick,
+                 stats.percentile(99) * us_per_tick,
+                 stats.max * us_per_tick);
+        print(line, user);
+    }
+}
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_DSP_PROFILE)
+#define TUNER_DSP_PROFILE
+
+//
+// Where the detector task's time goes. Every DSP stage adds its cycle count
+// while a hop is processed, then end_hop() files each stage's total for the
+// hop as count, min, sum, max and a power of two histogram for the
+// percentiles. Only built with HAVE_DSP_PROFILE (top level CMakeLists.txt,
+// or -DTUNER_DSP_PROFILE=ON for the host build), otherwise the DSP_PROFILE_*
+// macros are empty and none of this is compiled in.
+//
+// The detector task is the only writer. Other tasks take a consistent copy
+// with snapshot(): the writer bumps a sequence number before and after it
+// files a hop and the reader tries again if the number changed, neither side
+// ever waits on a lock.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+typedef enum
+{
+    DSP_STAGE_HOP = 0,     // All pitch_detector_task does with a mic block
+    DSP_STAGE_PIPELINE,    // PitchPipeline::process
+    DSP_STAGE_ONSET,       // Envelope and gate
+    DSP_STAGE_CONDITIONER, // q::signal_conditioner
+    DSP_STAGE_DETECTOR,    // q::pitch_detector, or the target detector's NSDF
+    DSP_STAGE_FILTERS,     // Smoothing chain
+    DSP_STAGE_NOTE,        // get_frequency_info
+    DSP_STAGE_STROBE,      // StrobeDemodulator::process
+    DSP_STAGE_STRUM,       // StrumAnalyzer push and analysis
+    DSP_STAGE_PUBLISH,     // Queues, history and the log line
+    DSP_STAGE_COUNT
+} DspStage;
+
+const char* dsp_stage_name(DspStage stage);
+
+#if defined(HAVE_DSP_PROFILE)
+
+#include <atomic>
+
+#if defined(ESP_PLATFORM)
+#include "esp_cpu.h"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Bucket 0 is below DSP_PROFILE_FIRST_TICKS, each next one is twice as wide, the last is open
+#define DSP_PROFILE_BUCKETS 24
+#define DSP_PROFILE_FIRST_TICKS 256
+
+/// @brief CPU cycles on the device and on x86 hosts, nanoseconds elsewhere.
+/// 32 bits, only differences over less than a few seconds mean anything.
+static inline uint32_t dsp_profile_ticks()
+{
+#if defined(ESP_PLATFORM)
+    return esp_cpu_get_cycle_count();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+/// @brief Rate of dsp_profile_ticks(), measured once on x86 hosts.
+uint32_t dsp_profile_ticks_per_second();
+
+/// @brief A copy of one stage's statistics, in ticks per hop.
+typedef struct
+{
+    uint32_t count; // Hops the stage ran in
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[DSP_PROFILE_BUCKETS];
+
+    uint32_t mean() const { return count ? (uint32_t)(sum / count) : 0; }
+    /// @brief Upper bound of the bucket holding the given percentile, max for the open one
+    uint32_t percentile(uint8_t percent) const;
+} DspStageStats;
+
+class DspProfile
+{
+public:
+    DspProfile();
+
+    DspProfile(const DspProfile&) = delete;
+    DspProfile& operator=(const DspProfile&) = delete;
+
+    /// @brief Writer: time spent in a stage during the current hop.
+    void add(DspStage stage, uint32_t ticks)
+    {
+        _hop[stage] += ticks;
+        _ran |= 1u << stage;
+    }
+
+    /// @brief Writer: file the hop's totals, stages that didn't run are left out.
+    void end_hop();
+
+    /// @brief Writer: the time one hop of audio lasts, hops that take longer are overruns.
+    void set_budget_us(uint32_t us);
+
+    /// @brief Any task: a consistent copy of a stage's statistics.
+    void snapshot(DspStage stage, DspStageStats& stats) const;
+
+    /// @brief Any task: hops filed and the ones over the budget.
+    uint32_t hops() const { return _hops.load(std::memory_order_relaxed); }
+    uint32_t overruns() const { return _overruns.load(std::memory_order_relaxed); }
+
+    /// @brief Any task: start over, done by the writer with the next hop.
+    void clear() { _clear.store(true, std::memory_order_relaxed); }
+
+    /// @brief Any task: a summary line, then one line per stage that ran, in microseconds.
+    void dump(void (*print)(const char* line, void* user), void* user) const;
+
+private:
+    typedef struct
+    {
+        std::atomic<uint32_t> count;
+        std::atomic<uint32_t> min;
+        std::atomic<uint32_t> max;
+        std::atomic<uint32_t> sum_low;
+        std::atomic<uint32_t> sum_high;
+        std::atomic<uint32_t> buckets[DSP_PROFILE_BUCKETS];
+    } Stage;
+
+    void _zero();
+
+    // Writer only
+    uint32_t _hop[DSP_STAGE_COUNT];
+    uint32_t _ran; // Bit per stage
+    uint32_t _budget;
+
+    // Odd while the writer is filing a hop
+    std::atomic<uint32_t> _sequence;
+    std::atomic<bool> _clear;
+    std::atomic<uint32_t> _hops;
+    std::atomic<uint32_t> _overruns;
+    std::atomic<uint32_t> _budget_us;
+    Stage _stages[DSP_STAGE_COUNT];
+};
+
+extern DspProfile dspProfile;
+
+#define DSP_PROFILE_BEGIN(mark) const uint32_t mark = dsp_profile_ticks()
+#define DSP_PROFILE_END(stage, mark) dspProfile.add(stage, dsp_profile_ticks() - (mark))
+#define DSP_PROFILE_END_HOP() dspProfile.end_hop()
+
+#else
+
+#define DSP_PROFILE_BEGIN(mark) (void)0
+#define DSP_PROFILE_END(stage, mark) (void)0
+#define DSP_PROFILE_END_HOP() (void)0
+
+#endif
+
+#endif
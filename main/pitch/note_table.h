@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_NOTE_TABLE)
+#define TUNER_NOTE_TABLE
+
+//
+// Note frequencies worked out by the compiler from the A4 reference and a
+// temperament, and the nearest note lookup of get_frequency_info() without
+// double precision log2 and pow, which are software emulated on the ESP32-S3:
+//
+//  1. a float log2 from the exponent bits and a quadratic of the mantissa
+//     picks the MIDI note, good to about 0.06 semitones,
+//  2. the cents against that note's table entry come from the ratio, within
+//     a semitone of 1, through ln(r) = 2 atanh((r - 1) / (r + 1)). Four
+//     terms of the series are exact to far below 0.001 cents,
+//  3. a note picked wrong next to a boundary is more than 50 cents off and
+//     its neighbour is taken instead.
+//
+// Platform-free like the rest of main/pitch.
+//
+
+#include <cstdint>
+#include <cstring>
+
+#include "defines.h"
+
+// MIDI notes 0 (C-1) .. 127 (G9)
+#define NOTE_TABLE_SIZE 128
+#define NOTE_MIDI_A4 69
+
+// Cents away from equal temperament for each note, C first. A4 is the
+// reference, its offset should be 0.
+typedef struct
+{
+    float cents[12];
+} Temperament;
+
+constexpr Temperament EqualTemperament = {{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+typedef struct
+{
+    int midi;        // -1 if the frequency is outside of the table
+    float frequency; // Of the note
+    float cents;     // Offset of the frequency from the note
+} NoteMatch;
+
+/// @brief 2^x for constant expressions, std::exp2 isn't constexpr
+constexpr double constexpr_exp2(double x)
+{
+    double scale = 1;
+    for (; x >= 1; x -= 1)
+        scale *= 2;
+    for (; x < 0; x += 1)
+        scale /= 2;
+    // e^(x ln 2) for 0 <= x < 1, the series has converged after 20 terms
+    const double t = x * 0.69314718055994530942;
+    double term = 1, sum = 1;
+    for (int n = 1; n < 20; n++)
+    {
+        term *= t / n;
+        sum += term;
+    }
+    return scale * sum;
+}
+
+/// @brief log2 in float, within 0.005 of the real one.
+inline float fast_log2(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    // One less than the real exponent, the quadratic below is log2(m) + 1
+    int exponent = (int)((bits >> 23) & 0xff) - 128;
+    // The mantissa as a float in [1, 2)
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    return exponent + (-0.34484843f * m + 2.02466578f) * m - 0.67487759f;
+}
+
+/// @brief 1200 log2(ratio) for ratios close to 1, a few semitones either way.
+inline float ratio_cents(float ratio)
+{
+    float u = (ratio - 1) / (ratio + 1);
+    float u2 = u * u;
+    // ln(r) = 2 (u + u^3 / 3 + u^5 / 5 + u^7 / 7 + ...), 1200 / ln(2) = 1731.234
+    return 3462.468f * u * (1 + u2 * (1.0f / 3 + u2 * (1.0f / 5 + u2 * (1.0f / 7))));
+}
+
+template <uint32_t A4_MILLIHZ, const Temperament& TEMPERAMENT = EqualTemperament> class NoteTable
+{
+public:
+    static constexpr float a4() { return A4_MILLIHZ / 1000.0f; }
+
+    /// @brief Frequency of a MIDI note, 0 .. NOTE_TABLE_SIZE - 1.
+    static constexpr float frequency(int midi) { return _table.hz[midi]; }
+
+    /// @brief Frequency of a note in an octave, C4 is middle C.
+    static constexpr float frequency(TunerNoteName note, int octave) { return frequency((octave + 1) * 12 + note); }
+
+    /// @brief The nearest note to a frequency and how far off it is.
+    static NoteMatch nearest(float hz)
+    {
+        NoteMatch match = {-1, 0, 0};
+        if (!(hz > frequency(0) / 2 && hz < frequency(NOTE_TABLE_SIZE - 1) * 2))
+            return match;
+        int midi = (int)(12 * fast_log2(hz * (1.0f / a4())) + (NOTE_MIDI_A4 + 0.5f));
+        midi = midi < 0 ? 0 : (midi >= NOTE_TABLE_SIZE ? NOTE_TABLE_SIZE - 1 : midi);
+        float cents = ratio_cents(hz / frequency(midi));
+        // Off by one next to a boundary, or an uneven temperament
+        int next = cents > 0 ? midi + 1 : midi - 1;
+        if ((cents > 50 || cents < -50) && next >= 0 && next < NOTE_TABLE_SIZE)
+        {
+            float next_cents = ratio_cents(hz / frequency(next));
+            if (next_cents * next_cents < cents * cents)
+            {
+                midi = next;
+                cents = next_cents;
+            }
+        }
+        match.midi = midi;
+        match.frequency = frequency(midi);
+        match.cents = cents;
+        return match;
+    }
+
+private:
+    typedef struct
+    {
+        float hz[NOTE_TABLE_SIZE];
+    } Table;
+
+    static constexpr Table _make()
+    {
+        Table table = {};
+        for (int midi = 0; midi < NOTE_TABLE_SIZE; midi++)
+        {
+            double semitones = midi - NOTE_MIDI_A4 + TEMPERAMENT.cents[midi % 12] / 100.0;
+            table.hz[midi] = (float)(A4_MILLIHZ / 1000.0 * constexpr_exp2(semitones / 12));
+        }
+        return table;
+    }
+
+    static constexpr Table _table = _make();
+};
+
+// The tuner's notes
+typedef NoteTable<static_cast<uint32_t>(A4_FREQ * 1000)> TunerNotes;
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "onset_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+/// @brief Per step factor of a decay with time constant `ms`.
+static float step_decay(float ms, float sample_rate, size_t count) { return expf(-1000.0f * count / (ms * sample_rate)); }
+
+OnsetDetector::OnsetDetector(float sample_rate, float onset_level, float release_level)
+    : _sample_rate(sample_rate), _onset_level(onset_level), _release_level(std::min(release_level, onset_level)),
+      _peak_decay(step_decay(ONSET_RELEASE_MS, sample_rate, ONSET_STEP)),
+      _average_alpha(1.0f - step_decay(ONSET_AVERAGE_MS, sample_rate, ONSET_STEP)),
+      _dc_alpha(1.0f - step_decay(ONSET_DC_MS, sample_rate, ONSET_STEP))
+{
+    reset();
+}
+
+void OnsetDetector::reset()
+{
+    _dc = 0;
+    _peak = 0;
+    _average = 0;
+    _active = false;
+    _armed = false;
+}
+
+OnsetEvent OnsetDetector::push(const int16_t* samples, size_t count)
+{
+    // min, max and sum only, the compiler keeps them in vector registers
+    int32_t lo = samples[0], hi = samples[0], sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        lo = std::min<int32_t>(lo, samples[i]);
+        hi = std::max<int32_t>(hi, samples[i]);
+        sum += samples[i];
+    }
+    float peak_decay = _peak_decay, average_alpha = _average_alpha, dc_alpha = _dc_alpha;
+    if (count != ONSET_STEP)
+    {
+        peak_decay = step_decay(ONSET_RELEASE_MS, _sample_rate, count);
+        average_alpha = 1.0f - step_decay(ONSET_AVERAGE_MS, _sample_rate, count);
+        dc_alpha = 1.0f - step_decay(ONSET_DC_MS, _sample_rate, count);
+    }
+    _dc += dc_alpha * ((float)sum / count - _dc);
+    float level = std::max(hi - _dc, _dc - lo);
+    _peak = std::max(level, _peak * peak_decay);
+    _average += average_alpha * (_peak - _average);
+
+    if (!_active)
+    {
+        if (_peak < _onset_level)
+            return ONSET_NONE;
+        // The average still lags behind, no re-pluck until it caught up
+        _active = true;
+        _armed = false;
+        return ONSET_NOTE_ON;
+    }
+    if (_peak < _release_level)
+    {
+        _active = false;
+        return ONSET_NOTE_OFF;
+    }
+    if (!_armed)
+    {
+        _armed = _peak < _average * ONSET_REARM;
+        return ONSET_NONE;
+    }
+    if (_peak > _average * ONSET_RISE && _peak >= _onset_level)
+    {
+        _armed = false;
+        return ONSET_NOTE_ON;
+    }
+    return ONSET_NONE;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_ONSET_DETECTOR)
+#define TUNER_ONSET_DETECTOR
+
+//
+// Note onsets and offsets from the envelope of the raw mic samples, followed
+// in steps of ONSET_STEP samples (1 ms at 16 kHz):
+//
+//  - the envelope is a peak follower on the signal minus its DC, instant
+//    attack and ONSET_RELEASE_MS decay, next to a slower average of it,
+//  - the gate opens when the envelope rises above the onset level and only
+//    closes below the lower release level, a decaying string doesn't
+//    flicker on and off around a single threshold,
+//  - while the gate is open, a peak ONSET_RISE times above the average is a
+//    new pluck. It has to fall back under ONSET_REARM times the average
+//    before the next one counts, so one attack is reported once.
+//
+// The levels are in raw counts, the input is not normalized here.
+// Platform-free like the rest of main/pitch.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+// Samples per envelope step, events are reported at the first one
+#define ONSET_STEP 16
+// Decay of the peak envelope, long enough to ride over the period of B0
+#define ONSET_RELEASE_MS 50.0f
+// Time constant of the average a re-pluck is measured against
+#define ONSET_AVERAGE_MS 150.0f
+#define ONSET_RISE 1.8f
+#define ONSET_REARM 1.2f
+// Time constant of the DC estimate
+#define ONSET_DC_MS 200.0f
+
+typedef enum
+{
+    ONSET_NONE = 0,
+    ONSET_NOTE_ON,  // The gate opened or the string was plucked again
+    ONSET_NOTE_OFF, // The envelope decayed below the release level
+} OnsetEvent;
+
+class OnsetDetector
+{
+public:
+    /// @param onset_level Envelope that opens the gate, raw counts.
+    /// @param release_level Envelope that closes it, below onset_level.
+    OnsetDetector(float sample_rate, float onset_level, float release_level);
+
+    /// @brief Follow one step of raw samples.
+    /// @param count 1..ONSET_STEP, shorter steps only at the end of a block.
+    OnsetEvent push(const int16_t* samples, size_t count);
+
+    /// @brief The gate is open, a note is ringing.
+    bool active() const { return _active; }
+
+    /// @brief Peak envelope in raw counts.
+    float envelope() const { return _peak; }
+
+    /// @brief Close the gate and start from silence.
+    void reset();
+
+private:
+    float _sample_rate;
+    float _onset_level;
+    float _release_level;
+    // Per full step
+    float _peak_decay;
+    float _average_alpha;
+    float _dc_alpha;
+
+    float _dc;
+    float _peak;
+    float _average;
+    bool _active;
+    bool _armed; // A rise of the peak counts as a new pluck
+};
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "pitch_pipeline.h"
+#include "dsp_profile.h"
+#include "note_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+bool get_frequency_info(float input_freq, FrequencyInfo* freqInfo, float confidence)
+{
+    if (input_freq <= 0.0f)
+    {
+        // Set frequency info to indicate invalid/no frequency
+        freqInfo->frequency = input_freq;
+        freqInfo->cents = 0.0f;
+        freqInfo->confidence = 0.0f;
+        freqInfo->targetFrequency = -1.0f;
+        freqInfo->targetNote = NOTE_NONE; // Assuming NOTE_NONE indicates no note
+        freqInfo->targetOctave = -1;
+        return false;
+    }
+
+    // Nearest MIDI note from the compile time table, float math only
+    NoteMatch match = TunerNotes::nearest(input_freq);
+    if (match.midi < 0)
+        return get_frequency_info(-1, freqInfo);
+
+    // Populate the output struct
+    freqInfo->frequency = input_freq;
+    freqInfo->targetFrequency = match.frequency;
+    // MIDI note 60 is C4, TunerNoteName is 0=C, 1=C#, ..., 11=B
+    freqInfo->targetNote = static_cast<TunerNoteName>(match.midi % 12);
+    freqInfo->targetOctave = match.midi / 12 - 1;
+    freqInfo->cents = match.cents;
+    freqInfo->confidence = confidence;
+
+    return true;
+}
+
+/// @brief Min and max of a block of raw samples in one pass.
+/// Four independent lanes keep the compiler on MIN/MAX instructions without a
+/// loop carried dependency on a single pair of registers.
+static inline void scan_range(const int16_t* samples, size_t count, int32_t& minVal, int32_t& maxVal)
+{
+    int32_t lo[4] = {samples[0], samples[0], samples[0], samples[0]};
+    int32_t hi[4] = {samples[0], samples[0], samples[0], samples[0]};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; lane++)
+        {
+            int32_t v = samples[i + lane];
+            lo[lane] = v < lo[lane] ? v : lo[lane];
+            hi[lane] = v > hi[lane] ? v : hi[lane];
+        }
+    }
+    for (; i < count; i++)
+    {
+        lo[0] = std::min<int32_t>(lo[0], samples[i]);
+        hi[0] = std::max<int32_t>(hi[0], samples[i]);
+    }
+    minVal = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    maxVal = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+}
+
+PitchPipeline::PitchPipeline(const PitchPipelineConfig& config)
+    : _config(config), _onset(config.sample_rate, (float)config.onset_level, (float)config.release_level),
+      _sig_cond(q::signal_conditioner::config{}, config.low_fs, config.high_fs, config.sample_rate),
+      _pd(config.low_fs, config.high_fs, config.sample_rate, -40_dB), _target(config.sample_rate),
+      _filters(FixedOutlierFilter<MEDIAN_FILTER_SIZE>(MEDIAN_FILTER_MAX_CENTS),
+               FixedOneEuroFilter(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF, EU_FILTER_BETA, EU_FILTER_DERIVATIVE_CUTOFF),
+               FixedMovingAverage<MOVING_AVERAGE_SIZE>(),
+               ExponentialSmoother(EXP_SMOOTHING),
+               FixedOneEuroFilter(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF_2, EU_FILTER_BETA_2, EU_FILTER_DERIVATIVE_CUTOFF_2)),
+      _adaptive(FixedOutlierFilter<MEDIAN_FILTER_SIZE>(MEDIAN_FILTER_MAX_CENTS), AdaptiveSmoother()),
+      _last_detection_index(0), _onset_check(false), _range_head(0), _range_count(0), _range_samples(0), _last_seen_note(NOTE_NONE),
+      _same_note_seen_count(0), _sample_index(0), _sink(nullptr), _sink_user(nullptr)
+{
+    set_target(config.target_frequency);
+}
+
+bool PitchPipeline::set_target(float frequency)
+{
+    if (frequency == _target.target())
+        return true;
+    bool res = _target.set_target(frequency);
+    _config.target_frequency = _target.target();
+    reset();
+    return res;
+}
+
+void PitchPipeline::_push_range(int32_t minVal, int32_t maxVal, size_t count)
+{
+    if (_range_count == PITCH_RANGE_BLOCKS)
+    {
+        _range_samples -= _range_len[_range_head];
+        _range_head = (_range_head + 1) % PITCH_RANGE_BLOCKS;
+        _range_count--;
+    }
+    size_t tail = (_range_head + _range_count) % PITCH_RANGE_BLOCKS;
+    _range_min[tail] = minVal;
+    _range_max[tail] = maxVal;
+    _range_len[tail] = count;
+    _range_count++;
+    _range_samples += count;
+
+    // Drop the oldest blocks as long as the rest still covers the window
+    while (_range_count > 1 && _range_samples - _range_len[_range_head] >= _config.window_size)
+    {
+        _range_samples -= _range_len[_range_head];
+        _range_head = (_range_head + 1) % PITCH_RANGE_BLOCKS;
+        _range_count--;
+    }
+}
+
+void PitchPipeline::reset()
+{
+    _onset.reset();
+    _restart();
+}
+
+void PitchPipeline::_restart(bool outliers)
+{
+    // The 1EU filters are left alone on purpose, resetting them makes the
+    // first readings after a pause jump around too much.
+    if (outliers)
+    {
+        _filters.stage<PITCH_FILTER_OUTLIERS>().reset();
+        _adaptive.stage<PITCH_FILTER_OUTLIERS>().reset();
+    }
+    _filters.stage<PITCH_FILTER_AVERAGE>().reset();
+    _filters.stage<PITCH_FILTER_SMOOTHER>().reset();
+    _adaptive.stage<PITCH_FILTER_ADAPTIVE>().reset();
+    _pd.reset();
+    _target.reset();
+
+    _onset_check = false;
+    _last_seen_note = NOTE_NONE;
+    _same_note_seen_count = 0;
+}
+
+void PitchPipeline::skip(uint64_t count)
+{
+    if (count == 0)
+        return;
+    _sample_index += count;
+    _range_head = 0;
+    _range_count = 0;
+    _range_samples = 0;
+    reset();
+}
+
+PitchFrameResult PitchPipeline::process(const int16_t* samples, size_t count)
+{
+    PitchFrameResult result = {};
+    result.status = PITCH_FRAME_NO_PITCH;
+    get_frequency_info(-1, &result.reading.info);
+
+    uint64_t first_index = _sample_index;
+    _sample_index += count;
+    if (count == 0)
+    {
+        result.status = PITCH_FRAME_SILENT;
+        return result;
+    }
+
+    // Track the min and max values we see so we can convert to values between -1.0f and +1.0f.
+    // This is the only pass over the raw block before the detector loop, the
+    // samples are converted one at a time below instead of into a float copy.
+    int32_t minVal, maxVal;
+    scan_range(samples, count, minVal, maxVal);
+    _push_range(minVal, maxVal, count);
+    for (size_t i = 0; i < _range_count; i++)
+    {
+        size_t block = (_range_head + i) % PITCH_RANGE_BLOCKS;
+        minVal = std::min(minVal, _range_min[block]);
+        maxVal = std::max(maxVal, _range_max[block]);
+    }
+
+    result.range = maxVal - minVal;
+    bool heard = _onset.active();
+
+    // String modes: one narrowband analysis per block instead of the full
+    // range detector. The NSDF doesn't care about the input level so the raw
+    // samples go in as they are, from the start of the note on.
+    if (_target.active())
+    {
+        size_t from = 0;
+        DSP_PROFILE_BEGIN(onset_start);
+        for (size_t step = 0; step < count; step += ONSET_STEP)
+        {
+            OnsetEvent event = _onset.push(samples + step, std::min<size_t>(ONSET_STEP, count - step));
+            if (event == ONSET_NONE)
+                continue;
+            _on_onset(event, first_index + step, result);
+            from = step;
+            heard = true;
+        }
+        DSP_PROFILE_END(DSP_STAGE_ONSET, onset_start);
+        if (!heard)
+            result.status = PITCH_FRAME_SILENT;
+        if (!_onset.active())
+            return result;
+        DSP_PROFILE_BEGIN(detector_start);
+        _target.push(samples + from, count - from);
+        TargetReading reading;
+        bool found = _target.analyze(reading);
+        DSP_PROFILE_END(DSP_STAGE_DETECTOR, detector_start);
+        if (found)
+            _on_detection(reading.frequency, reading.confidence, first_index + count - 1, result);
+        return result;
+    }
+
+    // Normalize the values between -1.0 and +1.0 before processing with qlib.
+    // One division per frame, a multiply per sample.
+    const float gain = 1.0f / std::max(1, std::max(std::abs(minVal), std::abs(maxVal)));
+    for (size_t step = 0; step < count; step += ONSET_STEP)
+    {
+        size_t end = std::min<size_t>(step + ONSET_STEP, count);
+        DSP_PROFILE_BEGIN(onset_start);
+        OnsetEvent event = _onset.push(samples + step, end - step);
+        if (event != ONSET_NONE)
+        {
+            _on_onset(event, first_index + step, result);
+            heard = true;
+        }
+        DSP_PROFILE_END(DSP_STAGE_ONSET, onset_start);
+        // Nothing goes into the detector between notes
+        if (!_onset.active())
+            continue;
+
+        // Signal Conditioner, a step at a time so each stage runs in a tight loop
+        DSP_PROFILE_BEGIN(conditioner_start);
+        for (size_t i = step; i < end; i++)
+            _conditioned[i - step] = _sig_cond(samples[i] * gain);
+        DSP_PROFILE_END(DSP_STAGE_CONDITIONER, conditioner_start);
+
+        // Send in each value into the pitch detector, the detections are
+        // smoothed once the step is through
+        DSP_PROFILE_BEGIN(detector_start);
+        size_t detections = 0;
+        for (size_t i = step; i < end; i++)
+        {
+            if (!_pd(_conditioned[i - step]))
+                continue;
+            _found[detections++] = {_pd.get_frequency(), _pd.periodicity(), first_index + i};
+        }
+        DSP_PROFILE_END(DSP_STAGE_DETECTOR, detector_start);
+
+        // calculated a frequency
+        for (size_t i = 0; i < detections; i++)
+            _on_detection(_found[i].frequency, _found[i].confidence, _found[i].index, result);
+    }
+
+    if (!heard)
+        result.status = PITCH_FRAME_SILENT;
+    return result;
+}
+
+void PitchPipeline::_on_onset(OnsetEvent event, uint64_t index, PitchFrameResult& result)
+{
+    // The signal conditioner is never reset, its envelopes carry over from note to note
+    if (event == ONSET_NOTE_OFF)
+    {
+        _restart();
+        return;
+    }
+    // A new pluck locks on like the first one, nothing of the note before is
+    // left in the detector or the smoothing. The outlier gate keeps its
+    // median, empty after silence, so the wild readings of a re-pluck's
+    // attack are still caught. Unless the new note is another one, the
+    // first detection decides that.
+    _restart(false);
+    _onset_check = true;
+    result.onset = true;
+    result.onset_index = index;
+}
+
+void PitchPipeline::_on_detection(float raw, float confidence, uint64_t index, PitchFrameResult& result)
+{
+    float f = raw;
+    result.detections++;
+    result.status = PITCH_FRAME_PITCH;
+
+    // The time between detections comes from the sample clock so the host
+    // replay behaves exactly like the device.
+    float dt = (float)(index - _last_detection_index) / _config.sample_rate;
+    _last_detection_index = index;
+    if (_onset_check)
+    {
+        // Held against the median of the note before, a different note
+        // would be replaced by it until the window filled up again
+        _onset_check = false;
+        FixedOutlierFilter<MEDIAN_FILTER_SIZE>& gate = _config.adaptive_smoothing
+                                                           ? _adaptive.stage<PITCH_FILTER_OUTLIERS>()
+                                                           : _filters.stage<PITCH_FILTER_OUTLIERS>();
+        if (!gate.accepts(f))
+            gate.reset();
+    }
+    DSP_PROFILE_BEGIN(filters_start);
+    if (_config.adaptive_smoothing)
+    {
+        _adaptive.stage<PITCH_FILTER_ADAPTIVE>().set_detection(confidence, (float)result.range);
+        f = _adaptive.filter(f, dt);
+    }
+    else
+        f = _filters.filter(f, dt);
+    DSP_PROFILE_END(DSP_STAGE_FILTERS, filters_start);
+
+    DSP_PROFILE_BEGIN(note_start);
+    FrequencyInfo freqInfo;
+    bool valid = get_frequency_info(f, &freqInfo, confidence);
+    DSP_PROFILE_END(DSP_STAGE_NOTE, note_start);
+    if (!valid)
+        return;
+    if (_sink)
+    {
+        PitchReading reading = {freqInfo, raw, index};
+        _sink(reading, result.range, _sink_user);
+    }
+
+    // Only show frequency info if we've seen the
+    // same target note more than once in a row.
+    // Doing this seems to help prevent sporadic
+    // notes from appearing right as you pluck a
+    // string.
+    if (_last_seen_note == freqInfo.targetNote)
+    {
+        _same_note_seen_count++;
+    }
+    else
+    {
+        _same_note_seen_count = 0;
+    }
+    _last_seen_note = freqInfo.targetNote;
+
+    // The target detector only reports confident peaks next to the
+    // selected string, its readings don't need to repeat.
+    bool publish = _target.active() || _same_note_seen_count > 1;
+    if (publish || !result.publish)
+    {
+        result.reading.info = freqInfo;
+        result.reading.raw_frequency = raw;
+        result.reading.sample_index = index;
+    }
+    result.publish |= publish;
+}
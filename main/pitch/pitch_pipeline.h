@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_PITCH_PIPELINE)
+#define TUNER_PITCH_PIPELINE
+
+//
+// Platform-free pitch pipeline: signal conditioning, q::pitch_detector and the
+// smoothing filters. Nothing in here may depend on FreeRTOS or ESP-IDF so the
+// same code runs inside pitch_detector_task and in the host tools.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+#include "defines.h"
+
+//
+// Q DSP Library for Pitch Detection
+//
+#include <q/pitch/pitch_detector.hpp>
+#include <q/fx/signal_conditioner.hpp>
+#include <q/support/literals.hpp>
+#include <q/support/pitch_names.hpp>
+
+//
+// Smoothing Filters
+//
+#include "app/utils/exponential_smoother.hpp"
+#include "app/utils/fixed_filters.hpp"
+
+#include "adaptive_smoother.h"
+#include "onset_detector.h"
+#include "target_detector.h"
+
+struct PitchPipelineConfig
+{
+    float sample_rate = TUNER_SAMPLE_RATE;
+    cycfi::q::frequency low_fs = cycfi::q::pitch_names::B[0];  // Lowest string on a 5-string bass
+    cycfi::q::frequency high_fs = cycfi::q::pitch_names::C[7]; // Setting this higher helps to catch the high harmonics
+    int32_t onset_level = TUNER_ONSET_LEVEL;     // Raw envelope that starts a note
+    int32_t release_level = TUNER_RELEASE_LEVEL; // and the one that ends it
+    size_t window_size = TUNER_FRAME_SIZE;       // Samples the normalization looks at
+    float target_frequency = 0;            // String modes: only look around this note, 0 searches low_fs..high_fs
+    bool adaptive_smoothing = true;        // AdaptiveFilterChain, false for the fixed PitchFilterChain
+};
+
+// Max number of blocks the range window can span, window_size / block size
+// must stay below this or the window is cut short.
+#define PITCH_RANGE_BLOCKS 32
+
+typedef enum
+{
+    PITCH_FRAME_SILENT = 0, // No note was ringing during the frame, the pipeline is reset
+    PITCH_FRAME_NO_PITCH,   // Frame was processed but the detector did not report a frequency
+    PITCH_FRAME_PITCH,      // At least one frequency was detected in the frame
+} PitchFrameStatus;
+
+typedef struct
+{
+    FrequencyInfo info;    // Smoothed frequency mapped to the closest note
+    float raw_frequency;   // Frequency as reported by q::pitch_detector
+    uint64_t sample_index; // Absolute index of the sample that completed the detection
+} PitchReading;
+
+typedef struct
+{
+    PitchFrameStatus status;
+    int32_t range;         // max - min of the raw samples in the last window_size samples
+    size_t detections;     // Number of detector hits in the frame
+    bool onset;            // A note started in the frame, the detector and the filters started over
+    uint64_t onset_index;  // Absolute index of the sample it started at, the last one if several
+    bool publish;          // true if `reading` passed the same-note check and should be shown
+    PitchReading reading;  // Last published reading, or the last detection if none was published
+} PitchFrameResult;
+
+// outliers -> 1EU -> moving average -> exponential smoothing -> 1EU, run on
+// every detection. Octave jumps are dropped before they reach the rest.
+typedef FilterChain<FixedOutlierFilter<MEDIAN_FILTER_SIZE>,
+                    FixedOneEuroFilter,
+                    FixedMovingAverage<MOVING_AVERAGE_SIZE>,
+                    ExponentialSmoother,
+                    FixedOneEuroFilter>
+    PitchFilterChain;
+
+// Stages of PitchFilterChain that start over with the detector
+#define PITCH_FILTER_OUTLIERS 0
+#define PITCH_FILTER_AVERAGE 2
+#define PITCH_FILTER_SMOOTHER 3
+
+// outliers -> smoothing that adapts to the attack, the sustain and the
+// detector's confidence
+typedef FilterChain<FixedOutlierFilter<MEDIAN_FILTER_SIZE>, AdaptiveSmoother> AdaptiveFilterChain;
+
+// PITCH_FILTER_OUTLIERS is the first stage here as well
+#define PITCH_FILTER_ADAPTIVE 1
+
+// A q::pitch_detector hit, kept until the step of samples is through
+typedef struct
+{
+    float frequency;
+    float confidence;
+    uint64_t index;
+} PitchDetection;
+
+/// @brief Called from process() for every detection, published or not.
+/// @param range Same as PitchFrameResult::range for the block.
+typedef void (*PitchDetectionSink)(const PitchReading& reading, int32_t range, const void* user);
+
+/// @brief Function to compute the closest note and cent deviation
+/// @return false if the frequency is not valid, freqInfo is filled with "no note" values
+bool get_frequency_info(float input_freq, FrequencyInfo* freqInfo, float confidence = 0.0f);
+
+class PitchPipeline
+{
+public:
+    explicit PitchPipeline(const PitchPipelineConfig& config = PitchPipelineConfig());
+
+    /// @brief Run one block of raw mic samples through the pipeline.
+    /// Blocks may be shorter than window_size, the normalization then looks
+    /// at the current block plus as many previous ones as fit in the window.
+    /// @param samples Raw 16-bit samples as delivered by the microphone.
+    /// @param count Number of samples in the block.
+    PitchFrameResult process(const int16_t* samples, size_t count);
+
+    /// @brief Reset the detector and the smoothing filters, the next sample
+    /// above the onset level starts a note.
+    void reset();
+
+    /// @brief Switch between the narrowband target detector (frequency > 0)
+    /// and the full range q::pitch_detector (0), keeps the capture settings.
+    /// @return false if the target can't be detected at this sample rate, the
+    /// full range detector is used then.
+    bool set_target(float frequency);
+    float target() const { return _target.target(); }
+
+    /// @brief Account for samples that never reached the pipeline (dropped
+    /// mic blocks). Keeps sample indexes absolute, the detector is reset since
+    /// the signal is no longer continuous.
+    void skip(uint64_t count);
+
+    /// @brief Also hand every detection to `sink`, the result of process()
+    /// only carries the last one of a block. nullptr stops it.
+    void set_detection_sink(PitchDetectionSink sink, const void* user)
+    {
+        _sink = sink;
+        _sink_user = user;
+    }
+
+    const PitchPipelineConfig& config() const { return _config; }
+
+    /// @brief Absolute index of the next sample to be processed.
+    uint64_t sample_index() const { return _sample_index; }
+
+private:
+    void _push_range(int32_t minVal, int32_t maxVal, size_t count);
+    /// @brief Reset the detector and the filters but keep following the envelope.
+    /// @param outliers Also forget the median of the outlier gates.
+    void _restart(bool outliers = true);
+    void _on_onset(OnsetEvent event, uint64_t index, PitchFrameResult& result);
+    void _on_detection(float raw, float confidence, uint64_t index, PitchFrameResult& result);
+
+    PitchPipelineConfig _config;
+
+    OnsetDetector _onset;
+    cycfi::q::signal_conditioner _sig_cond;
+    cycfi::q::pitch_detector _pd;
+    TargetDetector _target;
+
+    // One onset step on its way through the detector, members rather than
+    // locals to keep them off the detector task's stack
+    float _conditioned[ONSET_STEP];
+    PitchDetection _found[ONSET_STEP];
+
+    PitchFilterChain _filters;
+    AdaptiveFilterChain _adaptive;
+    uint64_t _last_detection_index; // For the time between detections
+    bool _onset_check;              // The next detection is the first of a new pluck
+
+    // min/max of the most recent blocks, oldest at _range_head
+    int32_t _range_min[PITCH_RANGE_BLOCKS];
+    int32_t _range_max[PITCH_RANGE_BLOCKS];
+    size_t _range_len[PITCH_RANGE_BLOCKS];
+    size_t _range_head;
+    size_t _range_count;
+    size_t _range_samples;
+
+    TunerNoteName _last_seen_note;
+    int _same_note_seen_count;
+    uint64_t _sample_index;
+    PitchDetectionSink _sink;
+    const void* _sink_user;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "pitch_profile.h"
+
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::pitch_names;
+
+// Samples per period of the highest note that q::pitch_detector is given when
+// a rate allows it: notes up to 1 kHz at 8 kHz, 2 kHz at 16 kHz
+#define PROFILE_RATE_HEADROOM 8
+// One detector run every 16 ms at any sample rate: 128 samples at 8 kHz, 256 at 16 kHz
+#define PROFILE_HOPS_PER_SECOND 62.5
+#define PROFILE_WINDOW_PERIODS 2
+
+static const uint32_t profile_sample_rates[] = {8 * 1000, 16 * 1000};
+
+PitchProfile pitch_profile_for_range(const char* name, q::frequency low_fs, q::frequency high_fs)
+{
+    PitchProfile profile;
+    profile.name = name;
+    profile.low_fs = low_fs;
+    profile.high_fs = high_fs;
+
+    size_t rates = sizeof(profile_sample_rates) / sizeof(profile_sample_rates[0]);
+    profile.sample_rate = 0;
+    for (size_t i = 0; i < rates; i++)
+    {
+        if (q::as_double(high_fs) * PROFILE_RATE_HEADROOM <= profile_sample_rates[i])
+        {
+            profile.sample_rate = profile_sample_rates[i];
+            break;
+        }
+    }
+    if (profile.sample_rate == 0)
+    {
+        // Clamped to the fastest rate, the top of the range gets less headroom.
+        // Auto and violin go up to C7 (2093 Hz), 7.6 samples per period at 16 kHz.
+        profile.sample_rate = profile_sample_rates[rates - 1];
+    }
+
+    profile.hop_size = (size_t)(profile.sample_rate / PROFILE_HOPS_PER_SECOND);
+
+    size_t hops = (size_t)std::ceil(PROFILE_WINDOW_PERIODS * profile.sample_rate / q::as_double(low_fs) / profile.hop_size);
+    if (hops < 2)
+        hops = 2;
+    if (hops > PITCH_RANGE_BLOCKS)
+        hops = PITCH_RANGE_BLOCKS;
+    profile.window_size = hops * profile.hop_size;
+    return profile;
+}
+
+// Ranges leave room below the lowest string for down tunings, the upper end
+// covers a few harmonics of the highest string.
+static const PitchProfile mode_profiles[MODE_COUNT] = {
+    pitch_profile_for_range("auto", B[0], C[7]),    // 5-string bass to the top of the detector
+    pitch_profile_for_range("guitar", B[1], B[5]),  // E2 string, down to B standard
+    pitch_profile_for_range("ukulele", F[3], A[6]), // low-G G3 string
+    pitch_profile_for_range("violin", F[3], C[7]),  // G3 string, E5 harmonics
+    pitch_profile_for_range("strum", B[1], B[5]),   // same as guitar, sets the strum FFT's resolution
+};
+
+const PitchProfile& pitch_profile_for_mode(TunerMode mode)
+{
+    if (mode < 0 || mode >= MODE_COUNT)
+        return mode_profiles[MODE_AUTO];
+    return mode_profiles[mode];
+}
+
+PitchPipelineConfig pitch_pipeline_config(const PitchProfile& profile)
+{
+    PitchPipelineConfig config;
+    config.sample_rate = profile.sample_rate;
+    config.low_fs = profile.low_fs;
+    config.high_fs = profile.high_fs;
+    config.window_size = profile.window_size;
+    return config;
+}
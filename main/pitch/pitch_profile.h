@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_PITCH_PROFILE)
+#define TUNER_PITCH_PROFILE
+
+//
+// Capture and detector settings per tuning mode. The lowest note an
+// instrument can play sets the detector window and therefore the latency,
+// the highest one sets the sample rate. Each mode gets the cheapest settings
+// that still cover its range.
+//
+
+#include "pitch_pipeline.h"
+
+typedef struct
+{
+    const char* name;
+    uint32_t sample_rate;
+    size_t window_size;            // Normalization window, a whole number of hops
+    size_t hop_size;               // Samples per mic block, one detector run each
+    cycfi::q::frequency low_fs;    // Lowest note the detector looks for
+    cycfi::q::frequency high_fs;   // Highest note, harmonics included
+} PitchProfile;
+
+/// @brief Derive capture settings from the range of notes to detect.
+/// The sample rate is the lower of 8 / 16 kHz that keeps high_fs below
+/// sample_rate / 8, 16 kHz when neither does. Hops are 16 ms long and the
+/// window spans two periods of low_fs (at least two hops).
+PitchProfile pitch_profile_for_range(const char* name, cycfi::q::frequency low_fs, cycfi::q::frequency high_fs);
+
+/// @brief Settings for a tuning mode, computed once from the instrument range.
+const PitchProfile& pitch_profile_for_mode(TunerMode mode);
+
+/// @brief Pipeline configuration matching a profile.
+PitchPipelineConfig pitch_pipeline_config(const PitchProfile& profile);
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "real_fft.h"
+
+#include <cmath>
+
+RealFFT::RealFFT(size_t size) : _size(size), _half(size / 2)
+{
+    const double pi = 3.14159265358979323846;
+
+    size_t twiddles = 3 * _half / 4;
+    _twiddles = new FFTComplex[twiddles];
+    for (size_t k = 0; k < twiddles; k++)
+    {
+        double a = -2.0 * pi * k / _half;
+        _twiddles[k] = {(float)cos(a), (float)sin(a)};
+    }
+
+    _split = new FFTComplex[_half / 2 + 1];
+    for (size_t k = 0; k <= _half / 2; k++)
+    {
+        double a = -2.0 * pi * k / _size;
+        _split[k] = {(float)cos(a), (float)sin(a)};
+    }
+
+    // Only the index pairs that actually move, each stored once
+    size_t bits = 0;
+    while (((size_t)1 << bits) < _half)
+        bits++;
+    _reverse = new uint16_t[_half];
+    _reverse_count = 0;
+    for (size_t i = 0; i < _half; i++)
+    {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        if (i < r)
+        {
+            _reverse[_reverse_count++] = (uint16_t)i;
+            _reverse[_reverse_count++] = (uint16_t)r;
+        }
+    }
+}
+
+RealFFT::~RealFFT()
+{
+    delete[] _twiddles;
+    delete[] _split;
+    delete[] _reverse;
+}
+
+void RealFFT::_complex_fft(FFTComplex* data)
+{
+    for (size_t i = 0; i < _reverse_count; i += 2)
+    {
+        FFTComplex t = data[_reverse[i]];
+        data[_reverse[i]] = data[_reverse[i + 1]];
+        data[_reverse[i + 1]] = t;
+    }
+
+    // log2(_half) odd: one radix-2 stage first, radix-4 from there on
+    size_t span = 1;
+    size_t bits = 0;
+    while (((size_t)1 << bits) < _half)
+        bits++;
+    if (bits & 1)
+    {
+        for (size_t i = 0; i < _half; i += 2)
+        {
+            FFTComplex a = data[i], b = data[i + 1];
+            data[i] = {a.re + b.re, a.im + b.im};
+            data[i + 1] = {a.re - b.re, a.im - b.im};
+        }
+        span = 2;
+    }
+
+    // Each butterfly merges four sub-transforms of `span` points. Input was
+    // bit reversed, so the blocks in memory are the sub-transforms of the
+    // samples 4n, 4n + 2, 4n + 1 and 4n + 3 in that order.
+    for (; span < _half; span *= 4)
+    {
+        size_t step = _half / (4 * span);
+        for (size_t base = 0; base < _half; base += 4 * span)
+        {
+            for (size_t k = 0; k < span; k++)
+            {
+                const FFTComplex& w1 = _twiddles[k * step];
+                const FFTComplex& w2 = _twiddles[2 * k * step];
+                const FFTComplex& w3 = _twiddles[3 * k * step];
+                FFTComplex* p = data + base + k;
+
+                FFTComplex a = p[0];
+                FFTComplex b = p[span];     // 4n + 2
+                FFTComplex c = p[2 * span]; // 4n + 1
+                FFTComplex d = p[3 * span]; // 4n + 3
+                b = {b.re * w2.re - b.im * w2.im, b.re * w2.im + b.im * w2.re};
+                c = {c.re * w1.re - c.im * w1.im, c.re * w1.im + c.im * w1.re};
+                d = {d.re * w3.re - d.im * w3.im, d.re * w3.im + d.im * w3.re};
+
+                FFTComplex s0 = {a.re + b.re, a.im + b.im};
+                FFTComplex s1 = {a.re - b.re, a.im - b.im};
+                FFTComplex s2 = {c.re + d.re, c.im + d.im};
+                FFTComplex s3 = {c.re - d.re, c.im - d.im};
+
+                p[0] = {s0.re + s2.re, s0.im + s2.im};
+                p[2 * span] = {s0.re - s2.re, s0.im - s2.im};
+                // -j * s3 and +j * s3
+                p[span] = {s1.re + s3.im, s1.im - s3.re};
+                p[3 * span] = {s1.re - s3.im, s1.im + s3.re};
+            }
+        }
+    }
+}
+
+void RealFFT::forward(float* data)
+{
+    FFTComplex* z = (FFTComplex*)data;
+    _complex_fft(z);
+
+    // Split the packed transform into the spectrum of the real input
+    FFTComplex z0 = z[0];
+    z[0] = {z0.re + z0.im, z0.re - z0.im};
+    for (size_t k = 1; k <= _half / 2; k++)
+    {
+        FFTComplex a = z[k];
+        FFTComplex b = z[_half - k];
+        FFTComplex e = {0.5f * (a.re + b.re), 0.5f * (a.im - b.im)};
+        // -j/2 * (a - conj(b))
+        FFTComplex o = {0.5f * (a.im + b.im), -0.5f * (a.re - b.re)};
+        const FFTComplex& w = _split[k];
+        FFTComplex wo = {o.re * w.re - o.im * w.im, o.re * w.im + o.im * w.re};
+        z[k] = {e.re + wo.re, e.im + wo.im};
+        z[_half - k] = {e.re - wo.re, -(e.im - wo.im)};
+    }
+}
+
+void RealFFT::power(float* data, size_t size)
+{
+    data[0] = data[0] * data[0];
+    for (size_t k = 1; k < size / 2; k++)
+        data[k] = data[2 * k] * data[2 * k] + data[2 * k + 1] * data[2 * k + 1];
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_REAL_FFT)
+#define TUNER_REAL_FFT
+
+//
+// In-place FFT of a real signal. The N real samples are packed into N/2
+// complex ones, transformed with radix-4 butterflies (plus one radix-2 stage
+// when log2(N/2) is odd) and split into the N/2 + 1 bins of the real
+// spectrum. All twiddles are computed once in the constructor.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+typedef struct
+{
+    float re;
+    float im;
+} FFTComplex;
+
+class RealFFT
+{
+public:
+    /// @param size Number of real samples, a power of two, at least 16.
+    explicit RealFFT(size_t size);
+    ~RealFFT();
+
+    RealFFT(const RealFFT&) = delete;
+    RealFFT& operator=(const RealFFT&) = delete;
+
+    size_t size() const { return _size; }
+
+    /// @brief Transform `size()` real samples in place.
+    /// On return data holds size() / 2 + 1 complex bins, bin N/2 (Nyquist)
+    /// is packed into the imaginary part of bin 0 like most real FFTs do.
+    void forward(float* data);
+
+    /// @brief Squared magnitudes of the bins left by forward(), in place.
+    /// data[k] = |X[k]|^2 for k = 0 .. size() / 2 - 1.
+    static void power(float* data, size_t size);
+
+private:
+    void _complex_fft(FFTComplex* data);
+
+    size_t _size;
+    size_t _half;           // complex FFT length
+    FFTComplex* _twiddles;  // exp(-2 pi i k / _half), k < 3 * _half / 4
+    FFTComplex* _split;     // exp(-2 pi i k / _size), k < _half / 2, for the real split
+    uint16_t* _reverse;     // bit reversed index, only for pairs that need a swap
+    size_t _reverse_count;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "spectrum_window.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpectrumWindow::SpectrumWindow(float sample_rate, size_t size)
+    : _sample_rate(sample_rate), _size(size), _fft(size), _write(0), _count(0), _transformed(false)
+{
+    const double pi = 3.14159265358979323846;
+    _window = new float[_size / 2];
+    for (size_t i = 0; i < _size / 2; i++)
+        _window[i] = (float)(0.5 - 0.5 * cos(2.0 * pi * i / (_size - 1)));
+    _work = new float[_size];
+    _history = new int16_t[_size];
+}
+
+SpectrumWindow::~SpectrumWindow()
+{
+    delete[] _window;
+    delete[] _work;
+    delete[] _history;
+}
+
+void SpectrumWindow::push(const int16_t* samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        _history[_write] = samples[i];
+        _write = (_write + 1) % _size;
+    }
+    _count = std::min(_count + count, _size);
+    _transformed = false;
+}
+
+int32_t SpectrumWindow::range() const
+{
+    int32_t min_val = INT16_MAX, max_val = INT16_MIN;
+    for (size_t i = 0; i < _count; i++)
+    {
+        min_val = std::min(min_val, (int32_t)_history[i]);
+        max_val = std::max(max_val, (int32_t)_history[i]);
+    }
+    return _count ? max_val - min_val : 0;
+}
+
+const float* SpectrumWindow::power()
+{
+    if (_transformed)
+        return _work;
+    // Oldest sample first, _write is where the next one would go
+    for (size_t i = 0; i < _size; i++)
+    {
+        float w = i < _size / 2 ? _window[i] : _window[_size - 1 - i];
+        _work[i] = _history[(_write + i) % _size] * w;
+    }
+    _fft.forward(_work);
+    RealFFT::power(_work, _size);
+    _transformed = true;
+    return _work;
+}
+
+SpectrumBands::SpectrumBands(float sample_rate, size_t size) : _bins(size / 2)
+{
+    // A full scale sine peaks at amplitude * size / 2 times the Hann window's gain of 1/2
+    const float peak = 32767.0f * size / 4;
+    _full_scale = peak * peak;
+
+    const float bin_hz = sample_rate / size;
+    const float ratio = std::log(SPECTRUM_HIGH_HZ / SPECTRUM_LOW_HZ) / SPECTRUM_BANDS;
+    for (size_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        float low = SPECTRUM_LOW_HZ * std::exp(ratio * b) / bin_hz;
+        float high = SPECTRUM_LOW_HZ * std::exp(ratio * (b + 1)) / bin_hz;
+        if (high - low < 1)
+        {
+            float center = std::sqrt(low * high);
+            size_t first = (size_t)center;
+            _first[b] = (uint16_t)std::min(first, _bins);
+            _last[b] = _first[b];
+            _frac[b] = center - first;
+            continue;
+        }
+        size_t first = (size_t)std::lround(low);
+        size_t last = std::max(first, (size_t)std::lround(high) - 1);
+        _first[b] = (uint16_t)std::min(first, _bins);
+        _last[b] = (uint16_t)std::min(last, _bins - 1);
+        _frac[b] = -1;
+    }
+}
+
+void SpectrumBands::reduce(const float* power, uint8_t* levels) const
+{
+    // The floor to full scale range is spread over 0..255
+    const float scale = 255.0f / -SPECTRUM_FLOOR_DB;
+    for (size_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        size_t first = _first[b];
+        float p = 0;
+        if (_frac[b] >= 0)
+        {
+            // Narrower than a bin, low notes fall in between bins
+            if (first + 1 < _bins)
+                p = power[first] + _frac[b] * (power[first + 1] - power[first]);
+        }
+        else
+        {
+            // The strongest bin, a partial shouldn't fade when it is averaged with its neighbours
+            for (size_t k = first; k <= _last[b] && k < _bins; k++)
+                p = std::max(p, power[k]);
+        }
+        float db = p > 0 ? 10.0f * std::log10(p / _full_scale) : SPECTRUM_FLOOR_DB;
+        float level = (db - SPECTRUM_FLOOR_DB) * scale;
+        levels[b] = (uint8_t)std::max(0.0f, std::min(255.0f, level));
+    }
+}
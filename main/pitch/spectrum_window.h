@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_SPECTRUM_WINDOW)
+#define TUNER_SPECTRUM_WINDOW
+
+//
+// The last N raw samples and their Hann windowed power spectrum. The strum
+// analyzer looks for peaks in it and the spectrum view shows it, in
+// MODE_STRUM both read the same window and the FFT runs at most once per
+// push no matter how many of them ask.
+//
+// SpectrumBands reduces a power spectrum to the SPECTRUM_BANDS log spaced
+// levels of a SpectrumLine (see defines.h).
+//
+// Platform-free like the rest of main/pitch.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+#include "defines.h"
+#include "real_fft.h"
+
+// Pitch modes, 128 ms at 16 kHz and 7.8 Hz per bin, the bands below ~300 Hz
+// are interpolated between bins
+#define SPECTRUM_FFT_SIZE 2048
+// Level 0 of a band, dB below a full scale sine. Any lower and the window's
+// leakage around strong partials fills the bars.
+#define SPECTRUM_FLOOR_DB -72.0f
+
+class SpectrumWindow
+{
+public:
+    /// @param size Samples in the window, a power of two, at least 16.
+    SpectrumWindow(float sample_rate, size_t size);
+    ~SpectrumWindow();
+
+    SpectrumWindow(const SpectrumWindow&) = delete;
+    SpectrumWindow& operator=(const SpectrumWindow&) = delete;
+
+    /// @brief Append raw samples, only the last size() are kept.
+    void push(const int16_t* samples, size_t count);
+
+    /// @brief true once the whole window has been collected.
+    bool ready() const { return _count == _size; }
+
+    void reset()
+    {
+        _write = 0;
+        _count = 0;
+        _transformed = false;
+    }
+
+    /// @brief max - min of the samples in the window.
+    int32_t range() const;
+
+    /// @brief Power spectrum of the window, size() / 2 bins of |X[k]|^2.
+    /// Transformed on the first call after a push, later calls return the
+    /// same buffer. Only valid once ready().
+    const float* power();
+
+    size_t size() const { return _size; }
+    float sample_rate() const { return _sample_rate; }
+    float bin_hz() const { return _sample_rate / _size; }
+
+private:
+    float _sample_rate;
+    size_t _size;
+    RealFFT _fft;
+    float* _window; // first half of the Hann window, it is symmetric
+    float* _work;
+    int16_t* _history;
+    size_t _write;
+    size_t _count;
+    bool _transformed; // _work holds the power of the current window
+};
+
+class SpectrumBands
+{
+public:
+    /// @brief Band edges for spectra of `size` samples at `sample_rate`.
+    SpectrumBands(float sample_rate, size_t size);
+
+    /// @brief Levels of the SPECTRUM_BANDS bands, 0 at SPECTRUM_FLOOR_DB and
+    /// below, 255 for a full scale sine. Bands above Nyquist are 0.
+    void reduce(const float* power, uint8_t* levels) const;
+
+private:
+    // Band b covers bins _first[b] .. _last[b], or sits between bin
+    // _first[b] and the next one at _frac[b] if it is narrower than a bin
+    uint16_t _first[SPECTRUM_BANDS];
+    uint16_t _last[SPECTRUM_BANDS];
+    float _frac[SPECTRUM_BANDS];
+    size_t _bins;
+    float _full_scale; // Power of the peak bin of a full scale sine
+};
+
+#endif
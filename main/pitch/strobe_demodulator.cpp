@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "strobe_demodulator.h"
+
+#include <cmath>
+
+static const double two_pi = 6.28318530717958647692;
+
+StrobeDemodulator::StrobeDemodulator(float sample_rate) : _sample_rate(sample_rate), _reference(0)
+{
+    _alpha = (float)(1.0 - std::exp(-two_pi * STROBE_LOWPASS_HZ / sample_rate));
+    set_reference(0);
+}
+
+void StrobeDemodulator::set_reference(float frequency)
+{
+    _reference = frequency > 0 && frequency < _sample_rate / 2 ? frequency : 0;
+    double w = -two_pi * _reference / _sample_rate;
+    _step_re = (float)std::cos(w);
+    _step_im = (float)std::sin(w);
+    reset();
+}
+
+void StrobeDemodulator::reset()
+{
+    _osc_re = 1;
+    _osc_im = 0;
+    _re[0] = _re[1] = 0;
+    _im[0] = _im[1] = 0;
+    _last_phase = 0;
+    _slot = 0;
+    _blocks = 0;
+}
+
+bool StrobeDemodulator::process(const int16_t* samples, size_t count, StrobeInfo& info)
+{
+    info.phase = 0;
+    info.drift = 0;
+    info.reference = _reference;
+    info.level = 0;
+    if (_reference <= 0 || count == 0)
+        return false;
+
+    float osc_re = _osc_re, osc_im = _osc_im;
+    float re0 = _re[0], im0 = _im[0], re1 = _re[1], im1 = _im[1];
+    const float a = _alpha;
+    for (size_t i = 0; i < count; i++)
+    {
+        float x = samples[i];
+        re0 += a * (x * osc_re - re0);
+        im0 += a * (x * osc_im - im0);
+        re1 += a * (re0 - re1);
+        im1 += a * (im0 - im1);
+
+        float next_re = osc_re * _step_re - osc_im * _step_im;
+        osc_im = osc_re * _step_im + osc_im * _step_re;
+        osc_re = next_re;
+    }
+    // The rotation is exact enough over a block, only the magnitude creeps
+    float norm = 1.0f / std::sqrt(osc_re * osc_re + osc_im * osc_im);
+    _osc_re = osc_re * norm;
+    _osc_im = osc_im * norm;
+    _re[0] = re0;
+    _im[0] = im0;
+    _re[1] = re1;
+    _im[1] = im1;
+
+    double phase = std::atan2((double)im1, (double)re1) / two_pi;
+    if (phase < 0)
+        phase += 1;
+    // Unwrap the step between two blocks, the error is well under half a turn per block
+    double step = phase - _last_phase;
+    step -= std::floor(step + 0.5);
+    _last_phase = phase;
+
+    size_t prev = _slot;
+    _slot = (_slot + 1) % STROBE_DRIFT_BLOCKS;
+    _unwrapped[_slot] = _blocks == 0 ? phase : _unwrapped[prev] + step;
+    _block_samples[_slot] = _blocks == 0 ? count : _block_samples[prev] + count;
+    if (_blocks < STROBE_SETTLE_BLOCKS + STROBE_DRIFT_BLOCKS)
+        _blocks++;
+    if (_blocks < STROBE_SETTLE_BLOCKS + STROBE_DRIFT_BLOCKS)
+        return false;
+
+    // The oldest entry is the next one to be overwritten
+    size_t oldest = (_slot + 1) % STROBE_DRIFT_BLOCKS;
+    double turns = _unwrapped[_slot] - _unwrapped[oldest];
+    size_t span = _block_samples[_slot] - _block_samples[oldest];
+
+    info.phase = (float)phase;
+    info.drift = (float)(turns * _sample_rate / span);
+    // Amplitude of the component at the reference, half the sine's peak after mixing
+    info.level = 2 * std::sqrt(re1 * re1 + im1 * im1);
+    return true;
+}
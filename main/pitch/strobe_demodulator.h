@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_STROBE_DEMODULATOR)
+#define TUNER_STROBE_DEMODULATOR
+
+//
+// Phase of the input relative to a reference note, the signal behind a strobe
+// tuner. The input is mixed down with a complex oscillator at the reference
+// frequency and low-pass filtered, what is left is a slowly rotating phasor:
+//
+//   z(t) = lowpass(x(t) * exp(-j * 2pi * reference * t)) ~ a * exp(j * 2pi * (f - reference) * t)
+//
+// Its angle is the strobe pattern's position and rotates at the frequency
+// error in Hz, so a string 0.1 cent off E2 moves by one band every 3.5 minutes.
+// One StrobeInfo per block is enough, the UI extrapolates the phase with the
+// drift in between. Platform-free like the rest of main/pitch.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+#include "defines.h"
+
+// Cutoff of each of the two one-pole low-pass stages, keeps the 2 * f image
+// of the lowest string ~50 dB down
+#define STROBE_LOWPASS_HZ 10.0f
+// Blocks until the filters have settled after a reset or a new reference
+#define STROBE_SETTLE_BLOCKS 8
+// The drift is measured over this many blocks, long enough to average out
+// the ripple the filters let through
+#define STROBE_DRIFT_BLOCKS 16
+
+class StrobeDemodulator
+{
+public:
+    explicit StrobeDemodulator(float sample_rate);
+
+    /// @brief Note to compare the input against, 0 stops the demodulator.
+    void set_reference(float frequency);
+    float reference() const { return _reference; }
+
+    /// @brief Mix down a block of raw samples.
+    /// @return true once the filters have settled, info is then valid.
+    bool process(const int16_t* samples, size_t count, StrobeInfo& info);
+
+    /// @brief Restart after a gap in the input.
+    void reset();
+
+private:
+    float _sample_rate;
+    float _reference;
+    // Oscillator as a rotating unit phasor, renormalized after every block
+    float _osc_re, _osc_im;
+    float _step_re, _step_im;
+    float _alpha;
+    float _re[2], _im[2];
+    double _last_phase;                        // turns, 0..1
+    double _unwrapped[STROBE_DRIFT_BLOCKS];    // turns, ring of the last blocks
+    size_t _block_samples[STROBE_DRIFT_BLOCKS]; // Samples up to each of them
+    size_t _slot;    // Newest entry of the ring
+    uint32_t _blocks; // Since the reset, saturates once the drift is valid
+};
+
+#endif
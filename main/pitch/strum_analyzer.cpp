@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "strum_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+static inline float cents_between(float f, float reference)
+{
+    return 1200.0f * std::log2(f / reference);
+}
+
+StrumAnalyzer::StrumAnalyzer(float sample_rate, const float* targets, size_t count)
+    : _sample_rate(sample_rate), _strings(std::min(count, (size_t)STRUM_STRINGS)), _spectrum(sample_rate, STRUM_FFT_SIZE),
+      _peak_count(0)
+{
+    for (size_t s = 0; s < _strings; s++)
+        _targets[s] = targets[s];
+
+    // Upper harmonics of one string that land on a partial of another can't
+    // tell the two apart. A fundamental has nothing to fall back on, it is
+    // kept and a merged one is flagged by analyze() instead.
+    for (size_t s = 0; s < _strings; s++)
+    {
+        for (int h = 1; h <= STRUM_HARMONICS; h++)
+        {
+            _collides[s][h] = false;
+            for (size_t t = 0; t < _strings && h > 1; t++)
+            {
+                for (int g = 1; g <= STRUM_HARMONICS && t != s; g++)
+                {
+                    if (std::fabs(cents_between(h * _targets[s], g * _targets[t])) < STRUM_COLLISION_CENTS)
+                        _collides[s][h] = true;
+                }
+            }
+        }
+    }
+}
+
+void StrumAnalyzer::_find_peaks(const float* power)
+{
+    const size_t bins = STRUM_FFT_SIZE / 2;
+    float max_power = 0;
+    for (size_t k = 1; k < bins; k++)
+        max_power = std::max(max_power, power[k]);
+    _peak_count = 0;
+    if (max_power <= 0)
+        return;
+
+    const float floor = max_power * std::pow(10.0f, STRUM_FLOOR_DB / 10.0f);
+    const float log_max = std::log(max_power);
+    for (size_t k = 2; k + 2 < bins; k++)
+    {
+        float p = power[k];
+        if (p < floor || p <= power[k - 1] || p < power[k + 1])
+            continue;
+
+        // A Hann main lobe is close to a parabola in the log domain
+        float a = std::log(power[k - 1] + 1e-30f);
+        float b = std::log(p);
+        float c = std::log(power[k + 1] + 1e-30f);
+        float denom = a - 2 * b + c;
+        float shift = denom < 0 ? 0.5f * (a - c) / denom : 0;
+        float log_peak = b - 0.25f * (a - c) * shift;
+
+        StrumPeak peak;
+        peak.frequency = (k + shift) * _sample_rate / STRUM_FFT_SIZE;
+        peak.level = 10.0f * (log_peak - log_max) / std::log(10.0f);
+        peak.amplitude = std::exp(0.5f * log_peak);
+
+        if (_peak_count < STRUM_MAX_PEAKS)
+        {
+            _peaks[_peak_count++] = peak;
+            continue;
+        }
+        // Full, keep the strongest ones
+        size_t weakest = 0;
+        for (size_t i = 1; i < _peak_count; i++)
+        {
+            if (_peaks[i].amplitude < _peaks[weakest].amplitude)
+                weakest = i;
+        }
+        if (peak.amplitude > _peaks[weakest].amplitude)
+            _peaks[weakest] = peak;
+    }
+    std::sort(_peaks, _peaks + _peak_count, [](const StrumPeak& a, const StrumPeak& b) {
+        return a.frequency < b.frequency;
+    });
+}
+
+const StrumPeak* StrumAnalyzer::_strongest_near(float frequency, float cents, const float* claims, size_t claim_count) const
+{
+    const StrumPeak* best = nullptr;
+    const StrumPeak* best_claimed = nullptr;
+    for (size_t i = 0; i < _peak_count; i++)
+    {
+        const StrumPeak& p = _peaks[i];
+        if (std::fabs(cents_between(p.frequency, frequency)) > cents)
+            continue;
+        bool claimed = false;
+        for (size_t c = 0; c < claim_count && !claimed; c++)
+            claimed = std::fabs(cents_between(p.frequency, claims[c])) < STRUM_CLAIM_CENTS;
+        const StrumPeak*& slot = claimed ? best_claimed : best;
+        if (slot == nullptr || p.amplitude > slot->amplitude)
+            slot = &p;
+    }
+    // A peak already explained by a lower string only if there's nothing
+    // else of similar strength, noise shouldn't win over a shared partial
+    if (best && best_claimed && best->amplitude < best_claimed->amplitude * STRUM_CLAIM_RATIO)
+        return best_claimed;
+    return best ? best : best_claimed;
+}
+
+bool StrumAnalyzer::_merged(const StrumPeak& peak, const float* claims, size_t claim_count) const
+{
+    const float distance = STRUM_MERGE_BINS * _sample_rate / STRUM_FFT_SIZE;
+    for (size_t c = 0; c < claim_count; c++)
+    {
+        if (std::fabs(peak.frequency - claims[c]) < distance)
+            return true;
+    }
+    return false;
+}
+
+bool StrumAnalyzer::analyze(StrumInfo& info)
+{
+    for (size_t s = 0; s < STRUM_STRINGS; s++)
+    {
+        info.frequency[s] = -1;
+        info.cents[s] = 0;
+        info.level[s] = STRUM_FLOOR_DB;
+        info.shared[s] = false;
+    }
+    _peak_count = 0;
+    if (!ready())
+        return false;
+
+    // A quiet window isn't even transformed
+    if (_spectrum.range() < TUNER_READING_DIFF_MINIMUM)
+        return false;
+    _find_peaks(_spectrum.power());
+
+    // Strings are resolved from the lowest target up, the partials of the
+    // ones already found claim their peaks.
+    size_t order[STRUM_STRINGS];
+    for (size_t s = 0; s < _strings; s++)
+    {
+        size_t i = s;
+        for (; i > 0 && _targets[order[i - 1]] > _targets[s]; i--)
+            order[i] = order[i - 1];
+        order[i] = s;
+    }
+    float claims[STRUM_STRINGS * STRUM_HARMONICS];
+    size_t claim_count = 0;
+
+    const float nyquist = _sample_rate / 2;
+    for (size_t i = 0; i < _strings; i++)
+    {
+        size_t s = order[i];
+        float target = _targets[s];
+        float estimate;
+        const StrumPeak* found = _strongest_near(target, STRUM_SEARCH_CENTS, claims, claim_count);
+        if (found)
+            estimate = found->frequency;
+        else if ((found = _strongest_near(2 * target, STRUM_SEARCH_CENTS, claims, claim_count)) != nullptr)
+            estimate = found->frequency / 2; // Weak fundamental, common on the low strings
+        else
+            continue;
+        // Against the lower strings only, not this one's own harmonics
+        info.shared[s] = _merged(*found, claims, claim_count);
+
+        double sum = 0, weight = 0;
+        for (int h = 1; h <= STRUM_HARMONICS && h * estimate < nyquist; h++)
+        {
+            if (_collides[s][h])
+                continue;
+            const StrumPeak* p = _strongest_near(h * estimate, STRUM_HARMONIC_CENTS, claims, claim_count);
+            if (p == nullptr)
+                continue;
+            double w = h * p->amplitude;
+            sum += p->frequency / h * w;
+            weight += w;
+        }
+        if (weight > 0)
+            estimate = (float)(sum / weight);
+        for (int h = 2; h <= STRUM_HARMONICS; h++)
+            claims[claim_count++] = h * estimate;
+
+        info.frequency[s] = estimate;
+        info.cents[s] = cents_between(estimate, target);
+        info.level[s] = found->level;
+    }
+    return true;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_STRUM_ANALYZER)
+#define TUNER_STRUM_ANALYZER
+
+//
+// Multi-pitch estimator for MODE_STRUM. A Hann windowed real FFT of the last
+// STRUM_FFT_SIZE samples is reduced to a list of interpolated spectral peaks,
+// then each string collects the peaks at the harmonics of its own pitch:
+//
+//  1. the strongest peak within STRUM_SEARCH_CENTS of the string's target
+//     (or half of the one near twice the target if the fundamental is weak)
+//     gives a first estimate,
+//  2. peaks close to h * estimate, h = 1 .. STRUM_HARMONICS, are averaged
+//     as f / h weighted by h * amplitude since upper harmonics resolve the
+//     pitch h times finer,
+//  3. upper harmonics that coincide with another string's partials (E2's
+//     3rd is B3) are left out of the average, worked out once per target
+//     table. The fundamental always counts, see 5.
+//  4. strings are resolved from the lowest up and the harmonics of every
+//     string found claim their peaks, a higher string only takes a claimed
+//     peak if there is no comparable one near its target,
+//  5. a string whose first peak lies within STRUM_MERGE_BINS of a claimed
+//     partial is marked shared. In standard tuning the fundamentals of B3
+//     (E2's 3rd) and E4 (E2's 4th, A2's 3rd) merge with a lower string
+//     whenever the two are tuned within ~20 cents of each other. Their
+//     upper harmonics are no way out, the weak 10th to 20th partials of the
+//     low strings land on them too, so the UI shows such a reading as
+//     shared instead of a number.
+//
+// Platform-free like the rest of main/pitch.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+#include "defines.h"
+#include "spectrum_window.h"
+
+// 512 ms at 8 kHz, 1.95 Hz per bin before interpolation
+#define STRUM_FFT_SIZE 4096
+// Analyses per second, the window slides by sample_rate / STRUM_ANALYSIS_RATE
+#define STRUM_ANALYSIS_RATE 10
+#define STRUM_MAX_PEAKS 64
+#define STRUM_HARMONICS 6
+// How far from its target a string is looked for
+#define STRUM_SEARCH_CENTS 100.0f
+// A harmonic peak has to be this close to h * estimate
+#define STRUM_HARMONIC_CENTS 25.0f
+// Harmonics this close to another string's partials are ambiguous
+#define STRUM_COLLISION_CENTS 30.0f
+// A peak this close to a harmonic of a string found before belongs to that string
+#define STRUM_CLAIM_CENTS 15.0f
+// ... unless the strongest unclaimed peak is this much weaker
+#define STRUM_CLAIM_RATIO 0.25f
+// Partials closer than this many bins show as a single peak
+#define STRUM_MERGE_BINS 2.5f
+// Peaks further below the strongest one are noise
+#define STRUM_FLOOR_DB -45.0f
+
+typedef struct
+{
+    float frequency;
+    float level; // dB relative to the strongest peak
+    float amplitude;
+} StrumPeak;
+
+class StrumAnalyzer
+{
+public:
+    /// @param targets Frequencies of the strings, up to STRUM_STRINGS.
+    StrumAnalyzer(float sample_rate, const float* targets, size_t count);
+
+    StrumAnalyzer(const StrumAnalyzer&) = delete;
+    StrumAnalyzer& operator=(const StrumAnalyzer&) = delete;
+
+    /// @brief Append raw samples, only the last STRUM_FFT_SIZE are kept.
+    void push(const int16_t* samples, size_t count) { _spectrum.push(samples, count); }
+
+    /// @brief true once a whole FFT window has been collected.
+    bool ready() const { return _spectrum.ready(); }
+
+    /// @brief Estimate every string from the current window.
+    /// @return false if the window was too quiet, info then holds no strings.
+    bool analyze(StrumInfo& info);
+
+    void reset() { _spectrum.reset(); }
+
+    /// @brief The window analyze() looks at, the spectrum view shows it too.
+    SpectrumWindow& spectrum() { return _spectrum; }
+
+    /// @brief Peaks found by the last analyze(), sorted by frequency.
+    const StrumPeak* peaks() const { return _peaks; }
+    size_t peak_count() const { return _peak_count; }
+
+private:
+    void _find_peaks(const float* power);
+    const StrumPeak* _strongest_near(float frequency, float cents, const float* claims, size_t claim_count) const;
+    bool _merged(const StrumPeak& peak, const float* claims, size_t claim_count) const;
+
+    float _sample_rate;
+    float _targets[STRUM_STRINGS];
+    size_t _strings;
+    bool _collides[STRUM_STRINGS][STRUM_HARMONICS + 1];
+
+    SpectrumWindow _spectrum;
+
+    StrumPeak _peaks[STRUM_MAX_PEAKS];
+    size_t _peak_count;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "target_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+TargetDetector::TargetDetector(float sample_rate)
+    : _sample_rate(sample_rate), _target(0), _lag_min(0), _lag_max(0), _window(0), _count(0)
+{
+}
+
+bool TargetDetector::set_target(float frequency)
+{
+    _target = 0;
+    if (frequency <= 0)
+        return true;
+
+    // One lag of margin on both sides so the peak can be interpolated at the band edges
+    double period = _sample_rate / frequency;
+    double band = pow(2.0, TARGET_BAND_SEMITONES / 12.0);
+    double lag_min = std::floor(period / band) - 1;
+    double lag_max = std::ceil(period * band) + 1;
+    if (lag_min < 4 || lag_max >= TARGET_HISTORY_SIZE / 2 || lag_max - lag_min >= TARGET_MAX_LAGS)
+        return false;
+    size_t window = std::max((size_t)std::ceil(TARGET_WINDOW_PERIODS * period), (size_t)TARGET_MIN_WINDOW);
+    if (window + (size_t)lag_max + 1 > TARGET_HISTORY_SIZE)
+        window = TARGET_HISTORY_SIZE - (size_t)lag_max - 1;
+
+    _target = frequency;
+    _lag_min = (size_t)lag_min;
+    _lag_max = (size_t)lag_max;
+    _window = window;
+    return true;
+}
+
+void TargetDetector::push(const int16_t* samples, size_t count)
+{
+    if (count > TARGET_HISTORY_SIZE)
+    {
+        samples += count - TARGET_HISTORY_SIZE;
+        count = TARGET_HISTORY_SIZE;
+    }
+    if (_count + count > TARGET_HISTORY_SIZE)
+    {
+        size_t drop = _count + count - TARGET_HISTORY_SIZE;
+        memmove(_history, _history + drop, (_count - drop) * sizeof(float));
+        _count -= drop;
+    }
+    for (size_t i = 0; i < count; i++)
+        _history[_count + i] = samples[i];
+    _count += count;
+}
+
+void TargetDetector::_scan(const float* x, size_t lag_from, size_t lag_to, float* out) const
+{
+    // Energy of the fixed half once, the lagged half slides along with the lag
+    float energy = 0, lagged = 0;
+    for (size_t i = 0; i < _window; i++)
+    {
+        energy += x[i] * x[i];
+        lagged += x[i + lag_from] * x[i + lag_from];
+    }
+    for (size_t lag = lag_from; lag <= lag_to; lag++)
+    {
+        float acf = 0;
+        for (size_t i = 0; i < _window; i++)
+            acf += x[i] * x[i + lag];
+        float total = energy + lagged;
+        *out++ = total > 0 ? 2 * acf / total : 0;
+        lagged += x[lag + _window] * x[lag + _window] - x[lag] * x[lag];
+    }
+}
+
+bool TargetDetector::analyze(TargetReading& reading)
+{
+    if (!active() || _count < _window + _lag_max + 1)
+        return false;
+
+    // The most recent window, lags look forward into the newest samples
+    const float* x = _history + _count - _window - _lag_max - 1;
+
+    _scan(x, _lag_min, _lag_max, _scores);
+    size_t lags = _lag_max - _lag_min + 1;
+    size_t best = 0;
+    for (size_t i = 1; i < lags; i++)
+    {
+        if (_scores[i] > _scores[best])
+            best = i;
+    }
+
+    // The maximum has to be a real peak inside the band, not the slope of one outside
+    float peak = _scores[best];
+    if (peak < TARGET_MIN_CONFIDENCE || best == 0 || best == lags - 1)
+        return false;
+
+    // The target period repeats for anything an octave up, rule that out at half the lag
+    size_t half_from = _lag_min / 2;
+    size_t half_to = (_lag_max + 1) / 2;
+    _scan(x, half_from, half_to, _half_scores);
+    for (size_t i = 0; i <= half_to - half_from; i++)
+    {
+        if (_half_scores[i] > peak * TARGET_OCTAVE_RATIO)
+            return false;
+    }
+
+    // Parabolic interpolation between the neighbouring lags
+    float a = _scores[best - 1];
+    float c = _scores[best + 1];
+    float denom = a - 2 * peak + c;
+    float shift = denom < 0 ? 0.5f * (a - c) / denom : 0;
+
+    reading.frequency = _sample_rate / (_lag_min + best + shift);
+    reading.confidence = std::min(peak, 1.0f);
+    return true;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#if !defined(TUNER_TARGET_DETECTOR)
+#define TUNER_TARGET_DETECTOR
+
+//
+// Narrowband detector for the string modes. When the string being tuned is
+// known only the lags within a semitone of its period are searched, with a
+// normalized square difference function (NSDF) over a short history:
+//
+//   nsdf(lag) = 2 * sum(x[i] * x[i + lag]) / sum(x[i]^2 + x[i + lag]^2)
+//
+// A dozen lags instead of the full B0..C7 search, and a note an octave off
+// the target can't be reported as the target since its period is out of
+// band. Platform-free like the rest of main/pitch.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+// Samples kept for the analysis, analysis window plus the longest lag
+#define TARGET_HISTORY_SIZE 1024
+// The analysis window spans this many target periods, at least TARGET_MIN_WINDOW samples
+#define TARGET_WINDOW_PERIODS 2
+#define TARGET_MIN_WINDOW 256
+// Search band around the target, in semitones
+#define TARGET_BAND_SEMITONES 1.0
+// Lags in the band, the widest band (longest period) has to fit
+#define TARGET_MAX_LAGS 64
+// NSDF peak needed to report a frequency, also the floor of the published confidence
+#define TARGET_MIN_CONFIDENCE 0.8f
+// A peak at half the lag this close to the main one means the input is an octave above the target
+#define TARGET_OCTAVE_RATIO 0.9f
+
+typedef struct
+{
+    float frequency;
+    float confidence; // NSDF peak, 1.0 for a perfectly periodic input
+} TargetReading;
+
+class TargetDetector
+{
+public:
+    explicit TargetDetector(float sample_rate);
+
+    /// @brief Select the note to look for, 0 turns the detector off.
+    /// @return false if the target's period doesn't fit the history, the
+    /// detector is then off as well.
+    bool set_target(float frequency);
+    float target() const { return _target; }
+    bool active() const { return _target > 0; }
+
+    /// @brief Append raw samples to the history.
+    void push(const int16_t* samples, size_t count);
+
+    /// @brief Look for the target in the latest samples.
+    /// @return true if a peak within the band with at least
+    /// TARGET_MIN_CONFIDENCE was found.
+    bool analyze(TargetReading& reading);
+
+    /// @brief Forget the history, used when the signal is no longer continuous.
+    void reset() { _count = 0; }
+
+private:
+    /// @brief NSDF for lag_from..lag_to into out.
+    void _scan(const float* x, size_t lag_from, size_t lag_to, float* out) const;
+
+    float _sample_rate;
+    float _target;
+    size_t _lag_min;
+    size_t _lag_max;
+    size_t _window;
+
+    float _scores[TARGET_MAX_LAGS];
+    float _half_scores[TARGET_MAX_LAGS]; // The octave check at half the lags
+    float _history[TARGET_HISTORY_SIZE];
+    size_t _count;
+};
+
+#endif
@@ -20,281 +20,387 @@
 
 #include "defines.h"
 #include "pitch_detector_task.h"
+#include "pitch/dsp_profile.h"
+#include "pitch/pitch_pipeline.h"
+#include "pitch/pitch_profile.h"
+#include "pitch/spectrum_window.h"
+#include "pitch/strobe_demodulator.h"
+#include "pitch/strum_analyzer.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <memory>
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
-#include "esp_timer.h"
-
-//
-// Q DSP Library for Pitch Detection
-//
-#include <q/pitch/pitch_detector.hpp>
-#include <q/fx/dynamic.hpp>
-#include <q/fx/clip.hpp>
-#include <q/fx/signal_conditioner.hpp>
-#include <q/support/decibel.hpp>
-#include <q/support/duration.hpp>
-#include <q/support/literals.hpp>
-#include <q/support/pitch_names.hpp>
-#include <q/support/pitch.hpp>
-
-//
-// Smoothing Filters
-//
-#include "app/utils/exponential_smoother.hpp"
-#include "app/utils/OneEuroFilter.h"
-#include "app/utils/MovingAverage.hpp"
-#include "app/utils/MedianFilter.hpp"
+#include "freertos/task.h"
 
 static const char* TAG = "PitchDetector";
 
-namespace q = cycfi::q;
-using namespace q::literals;
-using std::fixed;
-
-using namespace cycfi::q::pitch_names;
-using frequency = cycfi::q::frequency;
-using pitch = cycfi::q::pitch;
-CONSTEXPR frequency low_fs = cycfi::q::pitch_names::B[0];  // Lowest string on a 5-string bass
-CONSTEXPR frequency high_fs = cycfi::q::pitch_names::C[7]; // Setting this higher helps to catch the high harmonics
-
-ExponentialSmoother smoother(EXP_SMOOTHING);
-OneEuroFilter oneEUFilter(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF, EU_FILTER_BETA, EU_FILTER_DERIVATIVE_CUTOFF);
-OneEuroFilter oneEUFilter2(EU_FILTER_ESTIMATED_FREQ, EU_FILTER_MIN_CUTOFF_2, EU_FILTER_BETA_2, EU_FILTER_DERIVATIVE_CUTOFF_2);
-MovingAverage movingAverage(5);
-MedianFilter medianMovingFilter(3, true);
-// MedianFilter medianFilter(5, false);
-
 extern QueueHandle_t frequencyQueue;
+extern QueueHandle_t targetQueue;
+extern QueueHandle_t strumQueue;
+extern QueueHandle_t strobeQueue;
+extern QueueHandle_t spectrumQueue;
+extern TaskHandle_t guiTaskHandle;
 static TaskHandle_t s_task_handle;
+// esp_timer time of the first sample of the running capture
+static int64_t s_capture_start_us;
+// Results on their way to the GUI queues, kept off the task's stack
+static SpectrumLine s_spectrum_line;
+static StrumInfo s_strum_info;
+
+/// @brief The GUI sleeps while nothing changes, new data wakes it up.
+static void wake_gui()
+{
+    // Created after this task
+    if (guiTaskHandle)
+        xTaskNotifyGive(guiTaskHandle);
+}
 
-static int16_t adc_buffer[TUNER_FRAME_SIZE];
-static std::vector<float> in(TUNER_FRAME_SIZE); // a vector of values to pass into qlib
-
-/// @brief Function to compute the closest note and cent deviation
-inline esp_err_t get_frequency_info(float input_freq, FrequencyInfo* freqInfo)
+/// @brief (Re)start the mic stream with the capture settings of a profile.
+static bool start_capture(HAL::Hal* hal, const PitchProfile& profile)
 {
-    if (input_freq <= 0.0f)
+    // The mic has to be stopped for the DMA settings below to be applied
+    hal->mic()->endStream();
+    hal->mic()->end();
+    auto cfg = hal->mic()->config();
+    cfg.dma_buf_count = 8;
+    cfg.dma_buf_len = profile.hop_size;
+    cfg.over_sampling = 2;
+    cfg.noise_filter_level = 0;
+    cfg.sample_rate = profile.sample_rate;
+    cfg.magnification = 4;
+    cfg.use_adc = false;
+    hal->mic()->config(cfg);
+
+    // The mic task fills a ring of hop sized blocks and wakes us up for each
+    // completed one. Blocks are processed in place, no copy and no semaphore.
+    if (!hal->mic()->beginStream(profile.hop_size, TUNER_HOP_BUFFERS, s_task_handle))
     {
-        // Set frequency info to indicate invalid/no frequency
-        freqInfo->frequency = input_freq;
-        freqInfo->cents = 0.0f;
-        freqInfo->targetFrequency = -1.0f;
-        freqInfo->targetNote = NOTE_NONE; // Assuming NOTE_NONE indicates no note
-        freqInfo->targetOctave = -1;
-        return ESP_FAIL;
+        ESP_LOGE(TAG, "Failed to start the mic stream");
+        return false;
     }
+    s_capture_start_us = esp_timer_get_time();
+#if defined(HAVE_DSP_PROFILE)
+    // A hop has to be done before the next one is recorded
+    dspProfile.set_budget_us((uint32_t)((uint64_t)profile.hop_size * 1000000 / profile.sample_rate));
+    dspProfile.clear();
+#endif
+    ESP_LOGI(TAG,
+             "Profile %s: %" PRIu32 " Hz, hop %u, window %u, %.1f - %.1f Hz",
+             profile.name,
+             profile.sample_rate,
+             (unsigned)profile.hop_size,
+             (unsigned)profile.window_size,
+             cycfi::q::as_double(profile.low_fs),
+             cycfi::q::as_double(profile.high_fs));
+    return true;
+}
 
-    // Calculate the MIDI note number (floating point) relative to A4 (MIDI note 69)
-    // Use double for intermediate calculations for better precision
-    double midi_note_float = 12.0 * log2(static_cast<double>(input_freq) / A4_FREQ) + 69.0;
-
-    // Round to the nearest integer MIDI note
-    int midi_note = static_cast<int>(round(midi_note_float));
-
-    // Optional: Add checks for valid MIDI note range (e.g., 0-127) if necessary
-    // if (midi_note < 0 || midi_note > 127) { /* Handle out of range */ return ESP_FAIL; }
-
-    // Calculate note index (0=C, 1=C#, ..., 11=B)
-    // Ensure the result is non-negative, standard C++ % can yield negative results for negative inputs
-    int note_index = (midi_note % 12 + 12) % 12;
-
-    // Calculate octave number. MIDI note 60 is C4. Octave = floor(midi_note / 12) - 1
-    // Integer division in C++ truncates towards zero, which works like floor for positive numbers.
-    // For negative midi_note values, adjustments might be needed if supporting very low frequencies,
-    // but typically midi_note will be >= 0 for audible frequencies.
-    int octave = midi_note / 12 - 1;
-
-    // Calculate the frequency of the determined MIDI note
-    double closest_note_freq = A4_FREQ * pow(2.0, (static_cast<double>(midi_note) - 69.0) / 12.0);
+/// @brief PitchDetectionSink feeding the GUI's pitch history, `user` is the PitchProfile.
+/// A full ring drops the detection, the GUI empties it every frame.
+static void push_history(const PitchReading& reading, int32_t range, const void* user)
+{
+    const PitchProfile* profile = static_cast<const PitchProfile*>(user);
+    PitchSample sample;
+    // From the sample clock, not from when the hop happened to be processed
+    sample.time_us = s_capture_start_us + (int64_t)(reading.sample_index * 1000000 / profile->sample_rate);
+    sample.frequency = reading.info.frequency;
+    sample.cents = reading.info.cents;
+    sample.confidence = reading.info.confidence;
+    sample.amplitude = std::min(1.0f, range / 65535.0f);
+    pitchHistory.push(sample);
+}
 
-    // Calculate the cent deviation
-    double cents_deviation = 1200.0 * log2(static_cast<double>(input_freq) / closest_note_freq);
+/// @brief The strum check replaces the pitch pipeline and the strobe in MODE_STRUM.
+static void make_detector(const TunerTarget& target,
+                          const PitchProfile& profile,
+                          std::unique_ptr<PitchPipeline>& pipeline,
+                          std::unique_ptr<StrobeDemodulator>& strobe,
+                          std::unique_ptr<StrumAnalyzer>& strum)
+{
+    pipeline.reset();
+    strobe.reset();
+    strum.reset();
+    if (target.mode == MODE_STRUM)
+    {
+        strum.reset(new StrumAnalyzer(profile.sample_rate, GuitarFrequencies, STRUM_STRINGS));
+        return;
+    }
+    PitchPipelineConfig config = pitch_pipeline_config(profile);
+    config.target_frequency = target.frequency;
+    pipeline.reset(new PitchPipeline(config));
+    pipeline->set_detection_sink(push_history, &profile);
+    strobe.reset(new StrobeDemodulator(profile.sample_rate));
+    strobe->set_reference(target.frequency);
+}
 
-    // Populate the output struct
-    freqInfo->frequency = input_freq;
-    freqInfo->targetFrequency = static_cast<float>(closest_note_freq);
-    // Ensure TunerNoteName enum matches the 0=C, 1=C#, ..., 11=B mapping
-    freqInfo->targetNote = static_cast<TunerNoteName>(note_index);
-    freqInfo->targetOctave = octave;
-    freqInfo->cents = static_cast<float>(cents_deviation);
+/// @brief The spectrum view reads the strum analyzer's window in MODE_STRUM,
+/// the pitch modes get one of their own while the view is on.
+static void make_spectrum(const TunerTarget& target,
+                          const PitchProfile& profile,
+                          StrumAnalyzer* strum,
+                          std::unique_ptr<SpectrumWindow>& window,
+                          std::unique_ptr<SpectrumBands>& bands)
+{
+    window.reset();
+    bands.reset();
+    if (!target.spectrum)
+        return;
+    if (strum == nullptr)
+        window.reset(new SpectrumWindow(profile.sample_rate, SPECTRUM_FFT_SIZE));
+    SpectrumWindow& source = strum ? strum->spectrum() : *window;
+    bands.reset(new SpectrumBands(profile.sample_rate, source.size()));
+}
 
-    return ESP_OK;
+/// @brief One row of the spectrum view, dropped rather than waited for if the GUI is behind.
+static void send_spectrum(SpectrumWindow& window, const SpectrumBands& bands, float pitch)
+{
+    if (!window.ready())
+        return;
+    bands.reduce(window.power(), s_spectrum_line.level);
+    s_spectrum_line.pitch = pitch;
+    if (xQueueSend(spectrumQueue, &s_spectrum_line, 0))
+        wake_gui();
 }
 
 void pitch_detector_task(void* pvParameter)
 {
     // Prep ADC
     HAL::Hal* hal = (HAL::Hal*)pvParameter;
-    memset(adc_buffer, 0xcc, sizeof(adc_buffer));
-
-    // Get the pitch detector ready
-    q::pitch_detector pd(low_fs, high_fs, TUNER_SAMPLE_RATE, -40_dB);
-
-    // auto const&                 bits = pd.bits();
-    // auto const&                 edges = pd.edges();
-    // q::bitstream_acf<>          bacf{ bits };
-    // auto                        min_period = as_float(high_fs.period()) * TUNER_SAMPLE_RATE;
-
-    // q::peak_envelope_follower   env{ 30_ms, TUNER_SAMPLE_RATE };
-    // q::one_pole_lowpass         lp{high_fs, TUNER_SAMPLE_RATE};
-    // q::one_pole_lowpass         lp2(low_fs, TUNER_SAMPLE_RATE);
-
-    // constexpr float             slope = 1.0f/2;
-    // constexpr float             makeup_gain = 2;
-    // q::compressor               comp{ -18_dB, slope };
-    // q::clip                     clip;
-
-    // float                       onset_threshold = lin_float(-28_dB);
-    // float                       release_threshold = lin_float(-60_dB);
-    // float                       threshold = onset_threshold;
-
-    auto sc_conf = q::signal_conditioner::config{};
-    auto sig_cond = q::signal_conditioner{sc_conf, low_fs, high_fs, TUNER_SAMPLE_RATE};
-    q::one_pole_lowpass lp{high_fs, TUNER_SAMPLE_RATE};
-    q::one_pole_lowpass lp2{low_fs, TUNER_SAMPLE_RATE};
-
     s_task_handle = xTaskGetCurrentTaskHandle();
-    // TODO start microphone
-    auto cfg = hal->mic()->config();
-    cfg.dma_buf_count = 8;
-    cfg.dma_buf_len = TUNER_FRAME_SIZE;
-    cfg.over_sampling = 2;
-    cfg.noise_filter_level = 0;
-    cfg.sample_rate = TUNER_SAMPLE_RATE;
-    cfg.magnification = 4;
-    cfg.use_adc = false;
-    hal->mic()->config(cfg);
-    hal->mic()->begin();
 
-    TunerNoteName lastSeenNote = NOTE_NONE;
-    int sameNoteSeenCount = 0;
-    FrequencyInfo freqInfo;
+    // Start with the mode the GUI asked for, the one it starts in if it hasn't yet
+    TunerTarget target = {TUNER_START_MODE, 0.0f, false};
+    xQueueReceive(targetQueue, &target, 0);
+    const PitchProfile* profile = &pitch_profile_for_mode(target.mode);
+
+    // Get the pitch detector ready
+    std::unique_ptr<PitchPipeline> pipeline;
+    std::unique_ptr<StrobeDemodulator> strobe;
+    std::unique_ptr<StrumAnalyzer> strum;
+    make_detector(target, *profile, pipeline, strobe, strum);
+    std::unique_ptr<SpectrumWindow> spectrum;
+    std::unique_ptr<SpectrumBands> bands;
+    make_spectrum(target, *profile, strum.get(), spectrum, bands);
+    if (!start_capture(hal, *profile))
+    {
+        vTaskDelete(NULL);
+        return;
+    }
+    HAL::boot_mark("detector");
+    bool first_block = true;
+
+    StrobeInfo noStrobe = {
+        .phase = 0,
+        .drift = 0,
+        .reference = 0,
+        .level = 0,
+    };
     FrequencyInfo noFreq = {
         .frequency = -1,
         .cents = -1,
         .targetFrequency = -1,
         .targetNote = NOTE_NONE,
         .targetOctave = -1,
+        .confidence = 0,
     };
 
-    TickType_t ticksBetweenFreqDetection = pdMS_TO_TICKS(1);
-
+    uint32_t dropped = 0;
+    uint32_t history_dropped = 0;
+    // Stack use is looked at about once a second
+    uint32_t stack_hops = 0;
+    UBaseType_t stack_free = PITCH_DETECTOR_STACK_SIZE;
+    uint64_t next_sample = 0;
+    // Strum analyses are spread over whole hops, ~STRUM_ANALYSIS_RATE per second
+    uint32_t strum_hops = 0;
+    // Spectrum rows likewise, ~SPECTRUM_LINE_RATE per second
+    uint32_t spectrum_hops = 0;
+    float spectrum_pitch = -1;
+    // Only the first silent hop wakes the GUI
+    bool silent = false;
     while (1)
     {
-        while (hal->mic()->isRecording() < 2)
+        if (xQueueReceive(targetQueue, &target, 0))
         {
-
-            // recodr the mic
-            hal->mic()->record((int16_t*)adc_buffer, TUNER_FRAME_SIZE);
-            // Get the data out of the ADC Conversion Result.
-            float maxVal = adc_buffer[0];
-            float minVal = adc_buffer[0];
-            // ESP_LOGI(TAG, "Bytes read: %ld", num_of_bytes_read);
-            for (int i = 0; i < TUNER_FRAME_SIZE; i++)
+            xQueueOverwrite(frequencyQueue, &noFreq);
+            xQueueOverwrite(strobeQueue, &noStrobe);
+            if (&pitch_profile_for_mode(target.mode) != profile)
             {
-                // Do a first pass by just storing the raw values into the float array
-                in[i] = adc_buffer[i];
-
-                // Track the min and max values we see so we can convert to values between -1.0f and +1.0f
-                if (in[i] > maxVal)
-                {
-                    maxVal = in[i];
-                }
-                if (in[i] < minVal)
+                // Mode changed: new capture settings and a fresh detector, no reboot
+                profile = &pitch_profile_for_mode(target.mode);
+                make_detector(target, *profile, pipeline, strobe, strum);
+                make_spectrum(target, *profile, strum.get(), spectrum, bands);
+                dropped = 0;
+                next_sample = 0;
+                strum_hops = 0;
+                spectrum_hops = 0;
+                if (!start_capture(hal, *profile))
                 {
-                    minVal = in[i];
+                    vTaskDelete(NULL);
+                    return;
                 }
             }
-
-            // Bail out if the input does not meet the minimum criteria
-            float range = maxVal - minVal;
-            // ESP_LOGI(TAG, "min: %.0f  max: %.0f  range: %.0f", minVal, maxVal, range);
-            if (range < TUNER_READING_DIFF_MINIMUM)
+            else if (pipeline)
             {
-                // ESP_LOGI(TAG, "No frequency detected");
-                xQueueOverwrite(frequencyQueue, &noFreq);
-                // set_current_frequency(-1); // Indicate to the UI that there's no frequency available
-                // oneEUFilter.reset(); // Reset the 1EU filter so the next frequency it detects will be as fast as possible
-                // oneEUFilter2.reset();
-                smoother.reset();
-                movingAverage.reset();
-                // medianMovingFilter.reset();
-                // medianFilter.reset();
-                pd.reset();
+                if (!pipeline->set_target(target.frequency))
+                    ESP_LOGW(TAG, "%.2f Hz is out of the target detector's range, searching the full range", target.frequency);
+                strobe->set_reference(target.frequency);
+            }
+            if (target.spectrum != (bands != nullptr))
+                make_spectrum(target, *profile, strum.get(), spectrum, bands);
+            spectrum_pitch = -1;
+        }
 
-                lastSeenNote = NOTE_NONE;
-                sameNoteSeenCount = 0;
+        uint32_t seq;
+        const int16_t* block = hal->mic()->getStreamBlock(&seq);
+        if (block == nullptr)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        DSP_PROFILE_BEGIN(hop_start);
+        if (first_block)
+        {
+            // Ready to tune from here on: the capture was opened in
+            // TUNER_START_MODE, the GUI's first target keeps it running
+            HAL::boot_mark("first hop");
+            first_block = false;
+        }
 
-                vTaskDelay(ticksBetweenFreqDetection);
-                continue;
+        // Blocks the mic task had to drop leave a gap in the sample clock
+        uint64_t first_sample = (uint64_t)seq * profile->hop_size;
+        if (first_sample > next_sample)
+        {
+            if (pipeline)
+            {
+                pipeline->skip(first_sample - next_sample);
+                strobe->reset();
             }
-            // Normalize the values between -1.0 and +1.0 before processing with qlib.
-            // float midVal = range / 2;
-            float midVal = std::max(abs(minVal), abs(maxVal));
-            // ESP_LOGI(TAG, "min: %.0f  max: %.0f  range: %.0f  mid: %.0f", minVal, maxVal, range, midVal);
-            for (auto i = 0; i < TUNER_FRAME_SIZE; i++)
+            else
+                strum->reset();
+            if (spectrum)
+                spectrum->reset();
+        }
+        next_sample = first_sample + profile->hop_size;
+        if (hal->mic()->getStreamDropped() != dropped)
+        {
+            dropped = hal->mic()->getStreamDropped();
+            ESP_LOGW(TAG, "mic blocks dropped: %" PRIu32, dropped);
+        }
+        if (pitchHistory.dropped() != history_dropped)
+        {
+            // Expected while the GUI waits for the display at boot
+            history_dropped = pitchHistory.dropped();
+            ESP_LOGD(TAG, "pitch history full, detections dropped: %" PRIu32, history_dropped);
+        }
+        if (++stack_hops * profile->hop_size >= profile->sample_rate)
+        {
+            // Every hop path has run by now, the strum analysis included
+            stack_hops = 0;
+            UBaseType_t low = uxTaskGetStackHighWaterMark(NULL);
+            if (low < stack_free)
             {
-                // float newPosition = in[i] - midVal - minVal;
-                float normalizedValue = in[i] / midVal;
-                float s = normalizedValue;
-                // s = medianMovingFilter.addValue(s);
+                stack_free = low;
+                if (low < PITCH_DETECTOR_STACK_MARGIN)
+                    ESP_LOGW(TAG, "stack nearly full, %u bytes never used", (unsigned)low);
+                else
+                    ESP_LOGD(TAG, "stack: %u bytes never used", (unsigned)low);
+            }
+        }
 
-                // Signal Conditioner
-                s = sig_cond(s);
+        // The pitch modes keep a window for the spectrum view only while it is on
+        if (spectrum)
+            spectrum->push(block, profile->hop_size);
+        if (strum)
+        {
+            DSP_PROFILE_BEGIN(strum_start);
+            strum->push(block, profile->hop_size);
+            DSP_PROFILE_END(DSP_STAGE_STRUM, strum_start);
+        }
+        bool spectrum_due = bands && ++spectrum_hops * profile->hop_size * SPECTRUM_LINE_RATE >= profile->sample_rate;
+        if (spectrum_due)
+            spectrum_hops = 0;
 
-                // Send in each value into the pitch detector
-                if (pd(s) == true)
-                { // calculated a frequency
-                    auto f = pd.get_frequency();
-                    // 1EU Filtering
-                    TimeStamp time_seconds = (double)esp_timer_get_time() / 1000000;
-                    oneEUFilter.setFrequency(f);
-                    f = (float)oneEUFilter.filter((double)f, (TimeStamp)time_seconds);
+        // Rows are sent after the block is released, the FFT never keeps the mic task waiting
+        if (strum)
+        {
+            hal->mic()->releaseStreamBlock();
+            if (spectrum_due)
+                send_spectrum(strum->spectrum(), *bands, -1);
+            if (++strum_hops * profile->hop_size * STRUM_ANALYSIS_RATE >= profile->sample_rate && strum->ready())
+            {
+                strum_hops = 0;
+                DSP_PROFILE_BEGIN(analysis_start);
+                strum->analyze(s_strum_info);
+                DSP_PROFILE_END(DSP_STAGE_STRUM, analysis_start);
+                xQueueOverwrite(strumQueue, &s_strum_info);
+                wake_gui();
+            }
+            DSP_PROFILE_END(DSP_STAGE_HOP, hop_start);
+            DSP_PROFILE_END_HOP();
+            continue;
+        }
 
-                    f = movingAverage.addValue(f);
-                    f = smoother.smooth(f);
+        DSP_PROFILE_BEGIN(pipeline_start);
+        PitchFrameResult result = pipeline->process(block, profile->hop_size);
+        DSP_PROFILE_END(DSP_STAGE_PIPELINE, pipeline_start);
+        DSP_PROFILE_BEGIN(strobe_start);
+        StrobeInfo strobeInfo;
+        bool strobeValid = strobe->process(block, profile->hop_size, strobeInfo);
+        DSP_PROFILE_END(DSP_STAGE_STROBE, strobe_start);
+        hal->mic()->releaseStreamBlock();
 
-                    oneEUFilter2.setFrequency(f);
-                    f = (float)oneEUFilter2.filter((double)f, time_seconds);
-                    // cutoff overtones
-                    // if (f > 440)
-                    //     continue;
-                    if (get_frequency_info(f, &freqInfo) == ESP_OK)
-                    {
-                        // Only show frequency info if we've seen the
-                        // same target note more than once in a row.
-                        // Doing this seems to help prevent sporadic
-                        // notes from appearing right as you pluck a
-                        // string.
-                        ESP_LOGI(TAG, "freq: %.2f, range: %.0f", freqInfo.frequency, range);
+        DSP_PROFILE_BEGIN(publish_start);
 
-                        if (lastSeenNote == freqInfo.targetNote)
-                        {
-                            sameNoteSeenCount++;
-                        }
-                        else
-                        {
-                            sameNoteSeenCount = 0;
-                        }
-                        lastSeenNote = freqInfo.targetNote;
+        if (result.onset)
+            ESP_LOGD(TAG, "Note on at sample %" PRIu64 ", range: %" PRId32, result.onset_index, result.range);
 
-                        if (sameNoteSeenCount > 1)
-                        {
-                            ESP_LOGI(TAG,
-                                     "Frequency: %.2f, Note: %d, Octave: %d, Cents: %.2f",
-                                     freqInfo.frequency,
-                                     freqInfo.targetNote,
-                                     freqInfo.targetOctave,
-                                     freqInfo.cents);
-                            xQueueOverwrite(frequencyQueue, &freqInfo);
-                        }
-                    }
-                }
-            }
+        if (result.status == PITCH_FRAME_SILENT)
+            xQueueOverwrite(strobeQueue, &noStrobe);
+        else if (strobeValid)
+            xQueueOverwrite(strobeQueue, &strobeInfo);
 
-            vTaskDelay(pdMS_TO_TICKS(ticksBetweenFreqDetection));
+        if (result.status == PITCH_FRAME_SILENT)
+        {
+            // ESP_LOGI(TAG, "No frequency detected");
+            xQueueOverwrite(frequencyQueue, &noFreq);
+            if (!silent)
+                wake_gui();
+            silent = true;
+            spectrum_pitch = -1;
         }
+        else if (result.publish)
+        {
+            const FrequencyInfo& freqInfo = result.reading.info;
+            // Debug only, formatting floats every published hop is too much for
+            // the detector core. The DSP profile dump is the diagnostic.
+            ESP_LOGD(TAG,
+                     "Frequency: %.2f, Note: %d, Octave: %d, Cents: %.2f, confidence: %.2f, sample: %" PRIu64
+                     ", range: %" PRId32,
+                     freqInfo.frequency,
+                     freqInfo.targetNote,
+                     freqInfo.targetOctave,
+                     freqInfo.cents,
+                     freqInfo.confidence,
+                     result.reading.sample_index,
+                     result.range);
+            xQueueOverwrite(frequencyQueue, &freqInfo);
+            wake_gui();
+            silent = false;
+            spectrum_pitch = freqInfo.frequency;
+            // Auto mode has no string, the strobe follows the nearest note
+            if (target.frequency <= 0 && freqInfo.targetFrequency != strobe->reference())
+                strobe->set_reference(freqInfo.targetFrequency);
+        }
+        if (spectrum_due)
+            send_spectrum(*spectrum, *bands, spectrum_pitch);
+        DSP_PROFILE_END(DSP_STAGE_PUBLISH, publish_start);
+        DSP_PROFILE_END(DSP_STAGE_HOP, hop_start);
+        DSP_PROFILE_END_HOP();
     }
-}
\ No newline at end of file
+}
@@ -19,4 +19,18 @@
 #if !defined(TUNER_PITCH_DETECTOR_TASK)
 #define TUNER_PITCH_DETECTOR_TASK
 
+#include "app/utils/spsc_ring.hpp"
+#include "defines.h"
+
+// Bytes, on ESP-IDF the stack depth of a task is given in bytes
+#define PITCH_DETECTOR_STACK_SIZE 4096
+// Less stack than this never touched since boot is logged as a warning
+#define PITCH_DETECTOR_STACK_MARGIN 512
+
+// Every detection of the pitch pipeline, frequencyQueue only ever holds the
+// latest one. pitch_detector_task is the only producer and tuner_gui_task
+// the only consumer.
+typedef SpscRing<PitchSample, PITCH_HISTORY_LENGTH> PitchHistory;
+extern PitchHistory pitchHistory;
+
 #endif
@@ -0,0 +1,332 @@
+/**
+ * @file tuner_gui_task.cpp
+ * @author d4rkmen
+ * @brief Keyboard, target selection and frame loop of the tuner screen
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "tuner_gui_task.h"
+#include "hal/hal.h"
+#include "app/utils/common_define.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include "defines.h"
+#include "pitch_detector_task.h"
+#include "tunings.h"
+#include "app/ui.h"
+#include "app/utils/ui/frame_scheduler.h"
+#include "pitch/dsp_profile.h"
+#include <string>
+
+static const char* TAG = "M5Tuna";
+
+static bool is_repeat = false;
+static bool is_start = false;
+// keyboard constants
+#define KEY_HOLD_MS 800
+#define KEY_REPEAT_MS 200
+// GUI frame pacing
+#define FRAME_PERIOD_MS 14       // ~70 fps while something animates, the strobe needs it
+#define FRAME_IDLE_MS 50         // Keyboard polling while nothing changes
+#define FRAME_STATS_LOG_MS 10000 // Frame time histograms in the log, 0 turns them off
+// Detector stage timings in the log with HAVE_DSP_PROFILE, 0 turns them off. P logs them right away.
+#define DSP_PROFILE_LOG_MS 10000
+
+// Created in app_main
+extern QueueHandle_t frequencyQueue;
+extern QueueHandle_t targetQueue;
+extern QueueHandle_t strumQueue;
+extern QueueHandle_t strobeQueue;
+extern QueueHandle_t spectrumQueue;
+
+using namespace HAL;
+
+#if defined(HAVE_DSP_PROFILE)
+static void log_dsp_line(const char* line, void* user) { ESP_LOGI("DspProfile", "%s", line); }
+
+/// @brief Stage timings of the pitch detector so far, then start over
+static void log_dsp_profile()
+{
+    dspProfile.dump(log_dsp_line, nullptr);
+    dspProfile.clear();
+}
+#endif
+
+void tuner_gui_task(void* pvParameter)
+{
+    ESP_LOGI(TAG, "tuner_gui_task started");
+    Hal* hal = (Hal*)pvParameter;
+    FrequencyInfo receivedFreqInfo;
+
+    // The display may still be coming up, the pitch detector is already running
+    hal->wait_display();
+    TunerUI* tunerUI = new TunerUI(hal);
+    if (!tunerUI)
+    {
+        ESP_LOGE(TAG, "Failed to create TunerUI");
+        return;
+    }
+    // Initialize mode tracking variables
+    TunerMode currentMode = TUNER_START_MODE;
+    int maxStrings = _get_max_strings(currentMode);
+    int currentString = maxStrings - 1;
+    tunerUI->update_mode(currentMode);
+    // Last mode and string sent to the pitch detector
+    TunerTarget sentTarget = {MODE_COUNT, -1.0f, false};
+    tunerUI->update_string(currentString);
+    // The pitch detector notifies this task when it publishes
+    UTILS::FrameScheduler scheduler(FRAME_PERIOD_MS, FRAME_IDLE_MS);
+    bool firstFrame = true;
+    bool bootLogged = false;
+#if defined(HAVE_DSP_PROFILE)
+    TickType_t dspLogTick = xTaskGetTickCount();
+#endif
+    while (1)
+    {
+        // Get current frequency info
+        if (!xQueuePeek(frequencyQueue, &receivedFreqInfo, 0))
+            receivedFreqInfo.frequency = -1;
+
+        // Handle keyboard input with debouncing
+        hal->keyboard()->updateKeyList();
+        if (hal->keyboard()->isPressed())
+        {
+            tunerUI->end_splash();
+            // Mode switching with UP/DOWN
+            if (hal->keyboard()->isKeyPressing(KEY_NUM_RIGHT))
+            {
+                if (!is_repeat || !hal->keyboard()->waitForRelease(KEY_NUM_RIGHT, is_start ? KEY_HOLD_MS : KEY_REPEAT_MS))
+                {
+                    is_start = !is_repeat;
+                    is_repeat = true;
+
+                    // Circular mode change (UP)
+                    currentMode = static_cast<TunerMode>((currentMode + 1) % MODE_COUNT);
+                    maxStrings = _get_max_strings(currentMode);
+                    currentString = maxStrings - 1;
+                    tunerUI->update_mode(currentMode);
+                }
+            }
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_LEFT))
+            {
+                if (!is_repeat || !hal->keyboard()->waitForRelease(KEY_NUM_LEFT, is_start ? KEY_HOLD_MS : KEY_REPEAT_MS))
+                {
+                    is_start = !is_repeat;
+                    is_repeat = true;
+                    // Circular mode change (DOWN)
+                    currentMode = static_cast<TunerMode>((currentMode + MODE_COUNT - 1) % MODE_COUNT);
+                    maxStrings = _get_max_strings(currentMode);
+                    currentString = maxStrings - 1;
+                    tunerUI->update_mode(currentMode);
+                }
+            }
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_UP))
+            {
+                // String switching with LEFT/RIGHT (only applicable in single string modes)
+                if (maxStrings > 0)
+                {
+                    if (!is_repeat || !hal->keyboard()->waitForRelease(KEY_NUM_UP, is_start ? KEY_HOLD_MS : KEY_REPEAT_MS))
+                    {
+                        is_start = !is_repeat;
+                        is_repeat = true;
+                        // Circular string change (LEFT - previous string)
+                        currentString = (currentString + maxStrings - 1) % maxStrings;
+                        ESP_LOGI(TAG, "String changed to %d", currentString);
+                        tunerUI->update_string(currentString);
+                    }
+                }
+            }
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_DOWN))
+            {
+                if (maxStrings > 0)
+                {
+                    if (!is_repeat || !hal->keyboard()->waitForRelease(KEY_NUM_DOWN, is_start ? KEY_HOLD_MS : KEY_REPEAT_MS))
+                    {
+                        is_start = !is_repeat;
+                        is_repeat = true;
+                        // Circular string change
+                        currentString = (currentString + 1) % maxStrings;
+                        ESP_LOGI(TAG, "String changed to %d", currentString);
+                        tunerUI->update_string(currentString);
+                    }
+                }
+            }
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_S))
+            {
+                // Strobe view on/off, no repeat
+                if (!is_repeat)
+                {
+                    is_repeat = true;
+                    tunerUI->toggle_strobe();
+                }
+            }
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_F))
+            {
+                // Spectrum view on/off, no repeat
+                if (!is_repeat)
+                {
+                    is_repeat = true;
+                    tunerUI->toggle_spectrum();
+                }
+            }
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_H))
+            {
+                // Pitch history graph on/off, no repeat
+                if (!is_repeat)
+                {
+                    is_repeat = true;
+                    tunerUI->toggle_history();
+                }
+            }
+#if defined(HAVE_DSP_PROFILE)
+            else if (hal->keyboard()->isKeyPressing(KEY_NUM_P))
+            {
+                if (!is_repeat)
+                {
+                    is_repeat = true;
+                    log_dsp_profile();
+                    dspLogTick = xTaskGetTickCount();
+                }
+            }
+#endif
+        }
+        else
+            is_repeat = false;
+
+        // For auto mode, use frequency detector's output
+        // For other modes, use predefined target notes
+
+        float targetFreq = 0.0f;
+        std::string targetNote;
+        int targetOctave = -1;
+        float currentFreq = receivedFreqInfo.frequency;
+
+        if (currentMode == MODE_AUTO)
+        {
+            // Use frequency detector's output directly
+            targetNote = getNoteString(receivedFreqInfo.targetNote);
+            targetOctave = receivedFreqInfo.targetOctave;
+            targetFreq = receivedFreqInfo.targetFrequency;
+        }
+        else
+        {
+            // Use predefined target note based on instrument and string
+            TunerNoteName noteEnum;
+
+            switch (currentMode)
+            {
+            case MODE_GUITAR:
+                noteEnum = GuitarStrings[currentString];
+                targetOctave = GuitarOctaves[currentString];
+                targetFreq = GuitarFrequencies[currentString];
+                break;
+            case MODE_UKULELE:
+                noteEnum = UkuleleStrings[currentString];
+                targetOctave = UkuleleOctaves[currentString];
+                targetFreq = UkuleleFrequencies[currentString];
+                break;
+            case MODE_VIOLIN:
+                noteEnum = ViolinStrings[currentString];
+                targetOctave = ViolinOctaves[currentString];
+                targetFreq = ViolinFrequencies[currentString];
+                break;
+            default:
+                noteEnum = NOTE_A; // Failsafe
+                targetOctave = 4;
+                targetFreq = getNoteFrequency(noteEnum, targetOctave);
+                break;
+            }
+
+            targetNote = getNoteString(noteEnum);
+        }
+
+        // The detector picks its capture profile for the mode, narrows the
+        // search down to the selected string and only works out the spectrum
+        // while it is shown
+        TunerTarget target = {currentMode, maxStrings > 0 ? targetFreq : 0.0f, tunerUI->spectrum_view()};
+        if (target.mode != sentTarget.mode || target.frequency != sentTarget.frequency ||
+            target.spectrum != sentTarget.spectrum)
+        {
+            xQueueOverwrite(targetQueue, &target);
+            sentTarget = target;
+        }
+
+        // Update UI
+        tunerUI->update_freq(currentFreq, targetNote, targetOctave, targetFreq);
+        StrumInfo strumInfo;
+        if (currentMode == MODE_STRUM && xQueueReceive(strumQueue, &strumInfo, 0))
+        {
+            tunerUI->update_strum(strumInfo);
+        }
+        StrobeInfo strobeInfo;
+        if (xQueueReceive(strobeQueue, &strobeInfo, 0))
+        {
+            tunerUI->update_strobe(strobeInfo);
+        }
+        // Every row is one more line of the waterfall, take all of them
+        SpectrumLine spectrumLine;
+        while (xQueueReceive(spectrumQueue, &spectrumLine, 0))
+        {
+            tunerUI->update_spectrum(spectrumLine);
+        }
+        // Detections in between the ones on frequencyQueue, taken even while
+        // the graph is hidden so the ring never fills up
+        PitchSample pitchSample;
+        while (pitchHistory.pop(pitchSample))
+        {
+            tunerUI->update_history(pitchSample);
+        }
+
+        // Render and update canvas if needed
+        scheduler.render_begin();
+        if (tunerUI->render())
+        {
+            scheduler.render_end(true);
+            // Sent in the background, the next frame is drawn meanwhile
+            const UTILS::DirtyRects& damage = tunerUI->damage();
+            for (size_t i = 0; i < damage.count(); i++)
+                hal->canvas_damage(damage[i].x, damage[i].y, damage[i].w, damage[i].h);
+            scheduler.flush_begin();
+            hal->canvas_flush();
+            scheduler.flush_end();
+            // Of the frame before, this one is still on the wire
+            scheduler.add_send_time(hal->canvas_send_time());
+            if (firstFrame)
+            {
+                HAL::boot_mark("first frame");
+                firstFrame = false;
+            }
+        }
+        else if (tunerUI->render_strobe())
+        {
+            scheduler.render_end(true);
+            // Only the strobe rows changed, a fraction of a full frame over SPI
+            scheduler.flush_begin();
+            hal->canvas_update(0, STROBE_BAND_Y, hal->canvas()->width(), STROBE_BAND_H);
+            scheduler.flush_end();
+            scheduler.add_send_time(hal->canvas_send_time());
+        }
+        if (!bootLogged && !tunerUI->in_splash())
+        {
+            HAL::boot_mark("splash done");
+            HAL::boot_log();
+            bootLogged = true;
+        }
+        scheduler.log(TAG, FRAME_STATS_LOG_MS);
+#if defined(HAVE_DSP_PROFILE)
+        if (DSP_PROFILE_LOG_MS && xTaskGetTickCount() - dspLogTick >= pdMS_TO_TICKS(DSP_PROFILE_LOG_MS))
+        {
+            log_dsp_profile();
+            dspLogTick = xTaskGetTickCount();
+        }
+#endif
+        scheduler.wait(tunerUI->animating());
+    }
+}
+
@@ -0,0 +1,19 @@
+/**
+ * @file tuner_gui_task.h
+ * @author d4rkmen
+ * @brief Keyboard, target selection and frame loop of the tuner screen
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+/**
+ * @brief Task body, pvParameter is the HAL::Hal to draw on
+ *
+ * Reads frequencyQueue, strumQueue and strobeQueue, writes targetQueue.
+ * The queues are created by the caller before the task is started.
+ */
+void tuner_gui_task(void* pvParameter);
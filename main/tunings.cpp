@@ -0,0 +1,100 @@
+/**
+ * @file tunings.cpp
+ * @author d4rkmen
+ * @brief String notes and frequencies of the tuning modes
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "tunings.h"
+#include "pitch/note_table.h"
+
+// Define string notes for each instrument (using note enum values)
+const TunerNoteName GuitarStrings[6] = {
+    NOTE_E, // E2 (lowest)
+    NOTE_A, // A2
+    NOTE_D, // D3
+    NOTE_G, // G3
+    NOTE_B, // B3
+    NOTE_E  // E4 (highest)
+};
+
+const TunerNoteName UkuleleStrings[4] = {
+    NOTE_G, // G4 (highest)
+    NOTE_C, // C4
+    NOTE_E, // E4
+    NOTE_A  // A4
+};
+
+const TunerNoteName ViolinStrings[4] = {
+    NOTE_G, // G3 (lowest)
+    NOTE_D, // D4
+    NOTE_A, // A4
+    NOTE_E  // E5 (highest)
+};
+
+// Define octaves for each string of each instrument
+const int GuitarOctaves[6] = {2, 2, 3, 3, 3, 4};
+const int UkuleleOctaves[4] = {3, 4, 4, 4};
+const int ViolinOctaves[4] = {3, 4, 4, 5};
+
+// Shared with the pitch detector task, the strum check looks for these.
+// All from the compile time note table, nothing is computed at run time.
+const float GuitarFrequencies[STRUM_STRINGS] = {
+    TunerNotes::frequency(NOTE_E, 2),
+    TunerNotes::frequency(NOTE_A, 2),
+    TunerNotes::frequency(NOTE_D, 3),
+    TunerNotes::frequency(NOTE_G, 3),
+    TunerNotes::frequency(NOTE_B, 3),
+    TunerNotes::frequency(NOTE_E, 4),
+};
+
+const float UkuleleFrequencies[4] = {
+    TunerNotes::frequency(NOTE_G, 3),
+    TunerNotes::frequency(NOTE_C, 4),
+    TunerNotes::frequency(NOTE_E, 4),
+    TunerNotes::frequency(NOTE_A, 4),
+};
+
+const float ViolinFrequencies[4] = {
+    TunerNotes::frequency(NOTE_G, 3),
+    TunerNotes::frequency(NOTE_D, 4),
+    TunerNotes::frequency(NOTE_A, 4),
+    TunerNotes::frequency(NOTE_E, 5),
+};
+
+float getNoteFrequency(TunerNoteName note, int octave)
+{
+    int midi = (octave + 1) * 12 + note;
+    if (note < NOTE_C || note > NOTE_B || midi < 0 || midi >= NOTE_TABLE_SIZE)
+        return -1;
+    return TunerNotes::frequency(midi);
+}
+
+const char* noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+std::string getNoteString(TunerNoteName noteName)
+{
+    if (noteName >= NOTE_C && noteName <= NOTE_B)
+    {
+        return noteNames[static_cast<int>(noteName)];
+    }
+    return "";
+}
+
+uint8_t _get_max_strings(TunerMode mode)
+{
+    // Set max strings based on current mode
+    switch (mode)
+    {
+    case MODE_GUITAR:
+        return 6;
+    case MODE_UKULELE:
+    case MODE_VIOLIN:
+        return 4;
+        break;
+    default:
+        return 0; // Not applicable in auto and strum modes
+    }
+}
@@ -0,0 +1,27 @@
+/**
+ * @file tunings.h
+ * @author d4rkmen
+ * @brief String notes and frequencies of the tuning modes
+ * @version 1.0
+ * @date 2025-03-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include "defines.h"
+
+// One entry per string as the UI numbers them, GuitarFrequencies and _get_max_strings() are in defines.h
+extern const TunerNoteName GuitarStrings[6];
+extern const TunerNoteName UkuleleStrings[4];
+extern const TunerNoteName ViolinStrings[4];
+extern const int GuitarOctaves[6];
+extern const int UkuleleOctaves[4];
+extern const int ViolinOctaves[4];
+extern const float UkuleleFrequencies[4];
+extern const float ViolinFrequencies[4];
+
+float getNoteFrequency(TunerNoteName note, int octave);
+std::string getNoteString(TunerNoteName noteName);